@@ -1,9 +1,11 @@
 #version 460 core
 
+// The position is only attached in the wide layout, the slim one reconstructs it from depth
 layout (location = 0) out vec4 gDiffuse;
 layout (location = 1) out vec4 gNormal;
-layout (location = 2) out vec4 gPosition;
-layout (location = 3) out vec4 gAORoughnessMetallic;
+layout (location = 2) out vec4 gAORoughnessMetallic;
+layout (location = 3) out vec2 gVelocity;
+layout (location = 4) out vec4 gPosition;
 
 in vec3 fragmentPosition;
 in vec3 fragmentNormal;
@@ -14,13 +16,98 @@ in mat3 tangentSpaceMatrix;
 in vec3 cameraPosition;
 in vec3 cameraDirection;
 
+in vec4 currentClipPosition;
+in vec4 previousClipPosition;
+
+// Detail level cross-fade, 0 when not fading
+// Positive keeps the pixels under the dither threshold, negative keeps the complementary ones
+#ifdef INSTANCED
+flat in float drawLodFade;
+flat in uint drawMaterialIndex;
+#define lodFade drawLodFade
+
+// Every texture is packed as (pool << 16 | layer)
+struct MaterialData {
+    uint textures[4];
+};
+
+layout(std430, binding = 3) readonly buffer Materials {
+    MaterialData materials[];
+};
+layout(binding = 8) uniform sampler2DArray materialPools[8];
+
+const uint NO_TEXTURE = 0xFFFFFFFFu;
+
+vec4 sampleMaterial(uint slot, vec2 uv, vec4 fallback)
+{
+    // Taken before branching, the pool may differ between the draws of a multi-draw
+    vec2 dx = dFdx(uv);
+    vec2 dy = dFdy(uv);
+
+    uint location = materials[drawMaterialIndex].textures[slot];
+    if (location == NO_TEXTURE)
+        return fallback;
+
+    vec3 coords = vec3(uv, float(location & 0xFFFFu));
+    switch (location >> 16)
+    {
+        case 0u: return textureGrad(materialPools[0], coords, dx, dy);
+        case 1u: return textureGrad(materialPools[1], coords, dx, dy);
+        case 2u: return textureGrad(materialPools[2], coords, dx, dy);
+        case 3u: return textureGrad(materialPools[3], coords, dx, dy);
+        case 4u: return textureGrad(materialPools[4], coords, dx, dy);
+        case 5u: return textureGrad(materialPools[5], coords, dx, dy);
+        case 6u: return textureGrad(materialPools[6], coords, dx, dy);
+        case 7u: return textureGrad(materialPools[7], coords, dx, dy);
+    }
+    return fallback;
+}
+
+#define sampleDiffuse(uv)             sampleMaterial(0u, uv, vec4(1.0))
+#define sampleNormal(uv)              sampleMaterial(1u, uv, vec4(0.5, 0.5, 1.0, 1.0))
+#define sampleAORoughnessMetallic(uv) sampleMaterial(2u, uv, vec4(1.0, 1.0, 0.0, 1.0))
+#else
+uniform float lodFade;
+
 uniform sampler2D textureDiffuse;
 uniform sampler2D textureNormal;
 uniform sampler2D textureAORoughnessMetallic;
 
+#define sampleDiffuse(uv)             texture(textureDiffuse, uv)
+#define sampleNormal(uv)              texture(textureNormal, uv)
+#define sampleAORoughnessMetallic(uv) texture(textureAORoughnessMetallic, uv)
+#endif
+
+const float bayerMatrix[16] = float[](
+     0.0 / 16.0,  8.0 / 16.0,  2.0 / 16.0, 10.0 / 16.0,
+    12.0 / 16.0,  4.0 / 16.0, 14.0 / 16.0,  6.0 / 16.0,
+     3.0 / 16.0, 11.0 / 16.0,  1.0 / 16.0,  9.0 / 16.0,
+    15.0 / 16.0,  7.0 / 16.0, 13.0 / 16.0,  5.0 / 16.0
+);
+
+void applyLodFade()
+{
+    if (lodFade == 0.0)
+        return;
+
+    ivec2 pixel = ivec2(gl_FragCoord.xy) % 4;
+    float dither = bayerMatrix[pixel.y * 4 + pixel.x];
+
+    if (lodFade > 0.0 ? dither >= lodFade : dither < -lodFade)
+        discard;
+}
+
+// Octahedral mapping of a unit vector to [-1, 1]^2
+vec2 encodeNormal(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 wrapped = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return n.z >= 0.0 ? n.xy : wrapped;
+}
+
 vec3 normalWithMap()
 {
-    vec3 tangentNormal = texture(textureNormal, fragmentUV).rgb;
+    vec3 tangentNormal = sampleNormal(fragmentUV).rgb;
     tangentNormal = tangentNormal * 2.0 - 1.0;
     
     vec3 worldNormal = tangentSpaceMatrix * tangentNormal;
@@ -30,12 +117,17 @@ vec3 normalWithMap()
 
 void main()
 {
-    vec4 combinedData = texture(textureAORoughnessMetallic, fragmentUV);
+    applyLodFade();
+
+    vec4 combinedData = sampleAORoughnessMetallic(fragmentUV);
     vec3 normal = normalWithMap();
-    vec3 diffuse = texture(textureDiffuse, fragmentUV).rgb;
+    vec3 diffuse = sampleDiffuse(fragmentUV).rgb;
 
     gDiffuse = vec4(diffuse, 1.0);
-    gNormal = vec4(normal * 0.5 + 0.5, 1.0);
+    gNormal = vec4(encodeNormal(normal), 0.0, 1.0);
     gPosition = vec4(fragmentPosition, 1.0);
     gAORoughnessMetallic = combinedData;
+
+    // In uv units, from the last frame to this one
+    gVelocity = (currentClipPosition.xy / currentClipPosition.w - previousClipPosition.xy / previousClipPosition.w) * 0.5;
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 {
     "name": "Basic Deferred Shader",
     "vert": "./assets/shaders/glsl/Deferred.vert",
-    "frag": "./assets/shaders/glsl/Deferred.frag"
+    "frag": "./assets/shaders/glsl/Deferred.frag",
+    "instancing": true
 }
\ No newline at end of file
@@ -14,13 +14,51 @@ out mat3 tangentSpaceMatrix;
 out vec3 cameraPosition;
 out vec3 cameraDirection;
 
+// Without the jitter, the difference of the two is the motion of the pixel
+out vec4 currentClipPosition;
+out vec4 previousClipPosition;
+
+// Matches DepthPrepass.vert, so the depth of the pre-pass is reproduced exactly
+invariant gl_Position;
+
+#ifdef INSTANCED
+flat out float drawLodFade;
+flat out uint drawMaterialIndex;
+#endif
+
 layout(std140, binding = 0) uniform Camera {
     mat4 camView;
     mat4 camProjection;
     vec3 camPosition;
     vec3 camDirection;
+    mat4 camViewProjection;
+    mat4 camPreviousViewProjection;
+};
+
+#ifdef INSTANCED
+struct ObjectData {
+    mat4 modelMatrix;
+    mat4 previousModelMatrix;
+    uint materialIndex;
+};
+struct DrawData {
+    uint objectIndex;
+    float lodFade;
 };
+
+layout(std430, binding = 1) readonly buffer Draws {
+    DrawData draws[];
+};
+layout(std430, binding = 2) readonly buffer Objects {
+    ObjectData objects[];
+};
+#define drawData draws[gl_BaseInstance + gl_InstanceID]
+#define modelMatrix objects[drawData.objectIndex].modelMatrix
+#define previousModelMatrix objects[drawData.objectIndex].previousModelMatrix
+#else
 uniform mat4 modelMatrix;
+uniform mat4 previousModelMatrix;
+#endif
 
 void main()
 {
@@ -42,4 +80,12 @@ void main()
 
     cameraPosition = camPosition;
     cameraDirection = camDirection;
+
+    currentClipPosition  = vec4(vertexPosition, 1.0) * modelMatrix * camViewProjection;
+    previousClipPosition = vec4(vertexPosition, 1.0) * previousModelMatrix * camPreviousViewProjection;
+
+#ifdef INSTANCED
+    drawLodFade = drawData.lodFade;
+    drawMaterialIndex = objects[drawData.objectIndex].materialIndex;
+#endif
 }
\ No newline at end of file
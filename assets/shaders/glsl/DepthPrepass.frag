@@ -0,0 +1,29 @@
+#version 460 core
+
+// Only writes depth, the dithered cross-fade has to discard the same pixels as Deferred.frag,
+// otherwise the fading levels would leave holes in the equal depth G-buffer pass
+#ifdef INSTANCED
+flat in float drawLodFade;
+#define lodFade drawLodFade
+#else
+uniform float lodFade;
+#endif
+
+const float bayerMatrix[16] = float[](
+     0.0 / 16.0,  8.0 / 16.0,  2.0 / 16.0, 10.0 / 16.0,
+    12.0 / 16.0,  4.0 / 16.0, 14.0 / 16.0,  6.0 / 16.0,
+     3.0 / 16.0, 11.0 / 16.0,  1.0 / 16.0,  9.0 / 16.0,
+    15.0 / 16.0,  7.0 / 16.0, 13.0 / 16.0,  5.0 / 16.0
+);
+
+void main()
+{
+    if (lodFade == 0.0)
+        return;
+
+    ivec2 pixel = ivec2(gl_FragCoord.xy) % 4;
+    float dither = bayerMatrix[pixel.y * 4 + pixel.x];
+
+    if (lodFade > 0.0 ? dither >= lodFade : dither < -lodFade)
+        discard;
+}
\ No newline at end of file
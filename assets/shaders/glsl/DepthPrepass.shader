@@ -0,0 +1,6 @@
+{
+    "name": "Depth Pre-pass Shader",
+    "vert": "./assets/shaders/glsl/DepthPrepass.vert",
+    "frag": "./assets/shaders/glsl/DepthPrepass.frag",
+    "instancing": true
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#version 460 core
+
+layout (location = 0) in vec3 vertexPosition;
+
+// Computed the same way as in Deferred.vert, so the G-buffer pass can test for equal depth
+invariant gl_Position;
+
+#ifdef INSTANCED
+flat out float drawLodFade;
+#endif
+
+layout(std140, binding = 0) uniform Camera {
+    mat4 camView;
+    mat4 camProjection;
+    vec3 camPosition;
+    vec3 camDirection;
+};
+
+#ifdef INSTANCED
+struct ObjectData {
+    mat4 modelMatrix;
+    mat4 previousModelMatrix;
+    uint materialIndex;
+};
+struct DrawData {
+    uint objectIndex;
+    float lodFade;
+};
+
+layout(std430, binding = 1) readonly buffer Draws {
+    DrawData draws[];
+};
+layout(std430, binding = 2) readonly buffer Objects {
+    ObjectData objects[];
+};
+#define drawData draws[gl_BaseInstance + gl_InstanceID]
+#define modelMatrix objects[drawData.objectIndex].modelMatrix
+#else
+uniform mat4 modelMatrix;
+#endif
+
+void main()
+{
+    // Reverse order for column-major matrix
+    gl_Position = vec4(vertexPosition, 1.0) * modelMatrix * camView * camProjection;
+
+#ifdef INSTANCED
+    drawLodFade = drawData.lodFade;
+#endif
+}
\ No newline at end of file
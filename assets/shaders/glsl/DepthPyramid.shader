@@ -0,0 +1,4 @@
+{
+    "name": "Depth pyramid compute shader",
+    "comp": "./assets/shaders/glsl/DepthPyramid.comp"
+}
\ No newline at end of file
@@ -0,0 +1,4 @@
+{
+    "name": "Occlusion culling compute shader",
+    "comp": "./assets/shaders/glsl/OcclusionCulling.comp"
+}
\ No newline at end of file
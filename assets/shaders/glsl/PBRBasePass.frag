@@ -7,16 +7,28 @@ out vec4 outputColor;
 
 uniform sampler2D gDiffuse;
 uniform sampler2D gNormal;
-uniform sampler2D gPosition;
 uniform sampler2D gAORoughnessMetallic;
+uniform sampler2D gDepth;
+
+// The wide layout stores the position, the slim one reconstructs it from depth
+uniform bool reconstructPosition;
+uniform sampler2D gPosition;
+uniform mat4 inverseViewProjection;
 
 in vec3 cameraPosition;
 in vec3 cameraDirection;
 in mat4 cameraMatrix;
 
-uniform sampler2D shadowMap;
-uniform mat4 lightViewMatrix;
-uniform mat4 lightProjectionMatrix;
+// Cascaded sky light shadows, the maps are bound from unit 16
+#define MAX_CASCADES 4
+
+layout (std140, binding = 8) uniform ShadowCascades {
+    mat4 cascadeMatrices[MAX_CASCADES];
+    vec4 cascadeDepthBias;
+    vec4 cascadeParams; // Count in x
+};
+layout (binding = 16) uniform sampler2DShadow shadowMaps[MAX_CASCADES];
+
 uniform vec4 lightDirection;
 
 uniform sampler2D skyboxTexture;
@@ -24,6 +36,32 @@ uniform sampler2D skyboxTexture;
 #define PI 3.14159265359
 #define HALF_PI 1.57079632679
 
+// Local lights, culled per screen tile by the tiled lighting compute pass
+#define TILE_SIZE 16
+
+#define LIGHT_POINT 0
+#define LIGHT_SPOT 1
+#define LIGHT_DIRECTIONAL 2
+
+struct Light {
+    vec4 positionRange;
+    vec4 directionType;
+    vec4 color;
+    vec4 spotAngles;
+};
+
+layout (std430, binding = 4) readonly buffer Lights {
+    Light lights[];
+};
+
+layout (std430, binding = 5) readonly buffer LightIndices {
+    uint indexCount;
+    uint lightIndices[];
+};
+
+uniform bool tiledLighting;
+uniform usampler2D lightGrid;
+
 struct brdfInformation {
     vec3 diffuseColor;
     float roughness;
@@ -75,6 +113,22 @@ vec3 oklabToRgb(vec3 lab) {
     return M2 * lms;
 }
 
+vec3 decodeNormal(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+vec3 positionFromDepth(vec2 uv, float depth)
+{
+    // Reverse order for column-major matrix
+    vec4 world = vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0) * inverseViewProjection;
+    return world.xyz / world.w;
+}
+
 vec2 sampleEquirectangularMap(vec3 dir)
 {
     float u = 0.5 + (atan(dir.z, dir.x) / (2.0 * 3.14159265359));
@@ -82,33 +136,48 @@ vec2 sampleEquirectangularMap(vec3 dir)
     return vec2(u, 1.0 - v);
 }
 
-float checkSkylightShadow(vec3 fragPos, vec3 normal)
+float filterShadow(sampler2DShadow shadowMap, vec3 projCoords, float bias)
 {
-    vec4 lightSpacePos = vec4(fragPos, 1.0) * lightViewMatrix * lightProjectionMatrix;
-    vec3 projCoords = lightSpacePos.xyz / lightSpacePos.w;
-    projCoords = projCoords * 0.5 + 0.5;
+    // Every tap is a bilinear filtered 2x2 comparison, four of them cover a 3x3 texel footprint
+    vec2 texelSize = 1.0 / vec2(textureSize(shadowMap, 0));
+    float depth = projCoords.z - bias;
+
+    float lit = 0.0;
+    lit += texture(shadowMap, vec3(projCoords.xy + vec2(-0.5, -0.5) * texelSize, depth));
+    lit += texture(shadowMap, vec3(projCoords.xy + vec2( 0.5, -0.5) * texelSize, depth));
+    lit += texture(shadowMap, vec3(projCoords.xy + vec2(-0.5,  0.5) * texelSize, depth));
+    lit += texture(shadowMap, vec3(projCoords.xy + vec2( 0.5,  0.5) * texelSize, depth));
+    return 1.0 - lit * 0.25;
+}
 
-    // If outside shadow map, return no shadow
-    if(projCoords.z > 1.0 || projCoords.x < 0.0 || projCoords.x > 1.0 || projCoords.y < 0.0 || projCoords.y > 1.0)
-        return 0.0;
+float checkSkylightShadow(vec3 fragPos, vec3 normal)
+{
+    // The first cascade containing the fragment, with room for the filter kernel
+    // Cascades may lag behind the view, so the slices aren't trusted, only the maps themselves
+    int count = int(cascadeParams.x);
+    for (int cascade = 0; cascade < count; cascade++)
+    {
+        vec4 lightSpacePos = vec4(fragPos, 1.0) * cascadeMatrices[cascade];
+        vec3 projCoords = lightSpacePos.xyz / lightSpacePos.w;
+        projCoords = projCoords * 0.5 + 0.5;
 
-    float bias = 0.0025;
-    float shadow = 0.0;
-    float samples = 0.0;
-    float texelSize = 1.0 / textureSize(shadowMap, 0).x;
+        const float margin = 0.002;
+        if (projCoords.z > 1.0 || any(lessThan(projCoords.xy, vec2(margin))) || any(greaterThan(projCoords.xy, vec2(1.0 - margin))))
+            continue;
 
-    // 3x3 PCF kernel
-    for(int x = -1; x <= 1; ++x)
-    {
-        for(int y = -1; y <= 1; ++y)
+        // Samplers can only be indexed by constants
+        float bias = cascadeDepthBias[cascade];
+        switch (cascade)
         {
-            float pcfDepth = texture(shadowMap, projCoords.xy + vec2(x, y) * texelSize).r;
-            shadow += (projCoords.z - bias > pcfDepth) ? 1.0 : 0.0;
-            samples += 1.0;
+            case 0: return filterShadow(shadowMaps[0], projCoords, bias);
+            case 1: return filterShadow(shadowMaps[1], projCoords, bias);
+            case 2: return filterShadow(shadowMaps[2], projCoords, bias);
+            case 3: return filterShadow(shadowMaps[3], projCoords, bias);
         }
     }
-    shadow /= samples;
-    return shadow;
+
+    // Outside every cascade, no shadow
+    return 0.0;
 }
 
 // GGX
@@ -207,6 +276,43 @@ vec3 brdf(vec3 incomingDir, vec3 outgoingDir, vec3 normal) {
     return diffuseBrdf(normal, outgoingDir, incomingDir) + specularBrdf(incomingDir, outgoingDir, normal);
 }
 
+vec3 shadeTileLights(ivec2 pixel, vec3 position, vec3 normal, vec3 viewDir) {
+    uvec2 tile = texelFetch(lightGrid, pixel / TILE_SIZE, 0).rg;
+
+    vec3 result = vec3(0.0);
+    for (uint i = 0u; i < tile.y; i++) {
+        Light light = lights[lightIndices[tile.x + i]];
+        uint type = uint(light.directionType.w);
+
+        vec3 lightDir;
+        float attenuation = 1.0;
+        if (type == LIGHT_DIRECTIONAL) {
+            lightDir = normalize(-light.directionType.xyz);
+        } else {
+            vec3 toLight = light.positionRange.xyz - position;
+            float distance = length(toLight);
+            lightDir = toLight / max(distance, 0.0001);
+
+            // Inverse square falloff, windowed to reach zero at the range
+            float ratio = distance / light.positionRange.w;
+            float window = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+            attenuation = window * window / (distance * distance + 1.0);
+
+            if (type == LIGHT_SPOT) {
+                float cosAngle = dot(-lightDir, normalize(light.directionType.xyz));
+                attenuation *= smoothstep(light.spotAngles.y, light.spotAngles.x, cosAngle);
+            }
+        }
+
+        float cosPhi = max(dot(normal, lightDir), 0.0);
+        if (cosPhi * attenuation <= 0.0)
+            continue;
+
+        result += light.color.rgb * brdf(lightDir, viewDir, normal) * cosPhi * attenuation;
+    }
+    return result;
+}
+
 vec3 applyToneMapping(vec3 color) {
     // Convert to Oklab
     vec3 lab = rgbToOklab(color);
@@ -235,17 +341,18 @@ void main()
 {
     float gamma = 2.2;
 
-    vec3 normal = normalize(texture(gNormal, fragmentUV).rgb * 2.0 - 1.0);
-    vec3 position = texture(gPosition, fragmentUV).rgb;
-    vec4 aoRoughnessMetallic = texture(gAORoughnessMetallic, fragmentUV);
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gDepth, pixel, 0).r;
+    vec3 normal = decodeNormal(texelFetch(gNormal, pixel, 0).rg);
+    vec4 aoRoughnessMetallic = texelFetch(gAORoughnessMetallic, pixel, 0);
 
-    brdfInfo.diffuseColor = pow(texture(gDiffuse, fragmentUV).rgb, vec3(gamma));
+    brdfInfo.diffuseColor = pow(texelFetch(gDiffuse, pixel, 0).rgb, vec3(gamma));
     brdfInfo.roughness    = 1.0 - aoRoughnessMetallic.g;
     brdfInfo.metallic     = aoRoughnessMetallic.b;
     float ao              = aoRoughnessMetallic.r;
 
-    // If the fragment has no geometry, show the skybox
-    if (length(position) <= 0.001)
+    // If the fragment has no geometry, show the skybox (it doesn't write depth)
+    if (depth >= 1.0)
     {
         outputColor = vec4(brdfInfo.diffuseColor, 1.0);
         outputColor.rgb = applyToneMapping(outputColor.rgb);
@@ -254,6 +361,10 @@ void main()
         return;
     }
 
+    vec3 position = reconstructPosition ?
+        positionFromDepth(fragmentUV, depth) :
+        texelFetch(gPosition, pixel, 0).rgb;
+
     // Base lighting calculations
     vec3 viewDir = normalize(cameraPosition - position);
     vec3 lightDir = normalize(lightDirection.xyz * vec3(-1.0, 1.0, -1.0));
@@ -280,6 +391,9 @@ void main()
         (1.0 - shadow * 0.95 + 0.05)
     , 1.0);
 
+    if (tiledLighting)
+        outputColor.rgb += shadeTileLights(pixel, position, normal, viewDir) * ao;
+
     // Gamma correction
     outputColor.rgb = applyToneMapping(outputColor.rgb);
 
@@ -1,8 +0,0 @@
-#version 460 core
-
-out float outputDepth;
-
-void main()
-{
-    outputDepth = gl_FragCoord.z;
-}
@@ -1,5 +1,5 @@
 { 
     "name": "Shadow Casting Shader",
     "vert": "./assets/shaders/glsl/Shadow.vert",
-    "frag": "./assets/shaders/glsl/Shadow.frag"
+    "instancing": true
 }
\ No newline at end of file
@@ -4,7 +4,29 @@ layout (location = 0) in vec3 vertexPosition;
 
 uniform mat4 viewMatrix;
 uniform mat4 projectionMatrix;
+
+#ifdef INSTANCED
+struct ObjectData {
+    mat4 modelMatrix;
+    mat4 previousModelMatrix;
+    uint materialIndex;
+};
+struct DrawData {
+    uint objectIndex;
+    float lodFade;
+};
+
+layout(std430, binding = 1) readonly buffer Draws {
+    DrawData draws[];
+};
+layout(std430, binding = 2) readonly buffer Objects {
+    ObjectData objects[];
+};
+#define drawData draws[gl_BaseInstance + gl_InstanceID]
+#define modelMatrix objects[drawData.objectIndex].modelMatrix
+#else
 uniform mat4 modelMatrix;
+#endif
 
 void main()
 {
@@ -0,0 +1,150 @@
+#version 460 core
+
+// Resolves the jittered frame against the reprojected output of the last frame, at the output resolution
+// The history is clamped to the colors around the pixel in the current frame, so stale colors don't ghost
+
+in vec2 fragmentUV;
+
+out vec4 outputColor;
+
+uniform sampler2D currentTexture;   // The lit scene, rendered into the bottom left corner
+uniform sampler2D velocityTexture;  // In uv units, rendered at the same size
+uniform sampler2D depthTexture;
+uniform sampler2D historyTexture;   // The output of the last frame
+
+uniform vec4 renderSize;   // The rendered size in pixels in xy
+uniform vec4 sourceSize;   // The size of the scene textures in xy
+uniform vec4 jitter;       // The offset of the projection in rendered pixels in xy
+uniform int historyValid;
+uniform float blendFactor;
+
+// Without the jitter, the sky has no motion vectors, its motion is derived from the camera
+uniform mat4 inverseViewProjection;
+uniform mat4 previousViewProjection;
+
+vec3 toYCoCg(vec3 color)
+{
+    return vec3(
+         0.25 * color.r + 0.5 * color.g + 0.25 * color.b,
+         0.5  * color.r                 - 0.5  * color.b,
+        -0.25 * color.r + 0.5 * color.g - 0.25 * color.b
+    );
+}
+
+vec3 fromYCoCg(vec3 color)
+{
+    return vec3(
+        color.x + color.y - color.z,
+        color.x           + color.z,
+        color.x - color.y - color.z
+    );
+}
+
+float luminance(vec3 color)
+{
+    return dot(color, vec3(0.2126, 0.7152, 0.0722));
+}
+
+// Catmull-Rom filtering in 9 bilinear taps, sharper than a single bilinear sample, so the history doesn't blur over time
+vec3 sampleHistory(vec2 uv)
+{
+    vec2 size = vec2(textureSize(historyTexture, 0));
+    vec2 position = uv * size;
+    vec2 center = floor(position - 0.5) + 0.5;
+    vec2 f = position - center;
+
+    vec2 w0 = f * (-0.5 + f * (1.0 - 0.5 * f));
+    vec2 w1 = 1.0 + f * f * (-2.5 + 1.5 * f);
+    vec2 w2 = f * (0.5 + f * (2.0 - 1.5 * f));
+    vec2 w3 = f * f * (-0.5 + 0.5 * f);
+
+    vec2 w12 = w1 + w2;
+    vec2 offset12 = w2 / w12;
+
+    vec2 uv0  = (center - 1.0) / size;
+    vec2 uv3  = (center + 2.0) / size;
+    vec2 uv12 = (center + offset12) / size;
+
+    vec3 result = vec3(0.0);
+    result += texture(historyTexture, vec2(uv0.x , uv0.y )).rgb * w0.x  * w0.y;
+    result += texture(historyTexture, vec2(uv12.x, uv0.y )).rgb * w12.x * w0.y;
+    result += texture(historyTexture, vec2(uv3.x , uv0.y )).rgb * w3.x  * w0.y;
+    result += texture(historyTexture, vec2(uv0.x , uv12.y)).rgb * w0.x  * w12.y;
+    result += texture(historyTexture, vec2(uv12.x, uv12.y)).rgb * w12.x * w12.y;
+    result += texture(historyTexture, vec2(uv3.x , uv12.y)).rgb * w3.x  * w12.y;
+    result += texture(historyTexture, vec2(uv0.x , uv3.y )).rgb * w0.x  * w3.y;
+    result += texture(historyTexture, vec2(uv12.x, uv3.y )).rgb * w12.x * w3.y;
+    result += texture(historyTexture, vec2(uv3.x , uv3.y )).rgb * w3.x  * w3.y;
+
+    // The negative lobes can overshoot
+    return max(result, vec3(0.0));
+}
+
+vec2 cameraVelocity(vec2 uv, float depth)
+{
+    vec4 world = vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0) * inverseViewProjection;
+    vec4 previous = vec4(world.xyz / world.w, 1.0) * previousViewProjection;
+    return (uv * 2.0 - 1.0 - previous.xy / previous.w) * 0.5;
+}
+
+void main()
+{
+    // The texel nearest to the pixel, its sample was taken at its center moved by the jitter
+    vec2 renderPixel = fragmentUV * renderSize.xy;
+    ivec2 maxTexel = ivec2(renderSize.xy) - 1;
+    ivec2 texel = clamp(ivec2(floor(renderPixel + jitter.xy)), ivec2(0), maxTexel);
+    vec2 sampleOffset = renderPixel - (vec2(texel) + 0.5 - jitter.xy);
+
+    if (historyValid == 0)
+    {
+        vec2 uv = clamp((renderPixel + jitter.xy) / sourceSize.xy, 0.5 / sourceSize.xy, (renderSize.xy - 0.5) / sourceSize.xy);
+        outputColor = vec4(texture(currentTexture, uv).rgb, 1.0);
+        return;
+    }
+
+    // The color bounds of the neighborhood, and the closest surface for the motion (so the edges move with the foreground)
+    vec3 current = texelFetch(currentTexture, texel, 0).rgb;
+    vec3 minColor = vec3( 1e9);
+    vec3 maxColor = vec3(-1e9);
+    ivec2 closestTexel = texel;
+    float closestDepth = 1.0;
+    for (int y = -1; y <= 1; y++)
+    {
+        for (int x = -1; x <= 1; x++)
+        {
+            ivec2 neighbor = clamp(texel + ivec2(x, y), ivec2(0), maxTexel);
+            vec3 color = toYCoCg(texelFetch(currentTexture, neighbor, 0).rgb);
+            minColor = min(minColor, color);
+            maxColor = max(maxColor, color);
+
+            float depth = texelFetch(depthTexture, neighbor, 0).r;
+            if (depth < closestDepth)
+            {
+                closestDepth = depth;
+                closestTexel = neighbor;
+            }
+        }
+    }
+
+    vec2 velocity = closestDepth < 1.0 ?
+        texelFetch(velocityTexture, closestTexel, 0).xy :
+        cameraVelocity(fragmentUV, 1.0);
+    vec2 historyUV = fragmentUV - velocity;
+
+    // Nothing to reproject from outside the last frame
+    if (any(lessThan(historyUV, vec2(0.0))) || any(greaterThan(historyUV, vec2(1.0))))
+    {
+        outputColor = vec4(current, 1.0);
+        return;
+    }
+
+    vec3 history = fromYCoCg(clamp(toYCoCg(sampleHistory(historyUV)), minColor, maxColor));
+
+    // Samples far from the pixel center count less, so upsampling converges to the detail of the output resolution
+    float weight = blendFactor * exp(-2.29 * dot(sampleOffset, sampleOffset));
+
+    // Weighted by inverse luminance, so single bright samples don't flicker
+    float currentWeight = weight / (1.0 + luminance(current));
+    float historyWeight = (1.0 - weight) / (1.0 + luminance(history));
+    outputColor = vec4((current * currentWeight + history * historyWeight) / (currentWeight + historyWeight), 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,5 @@
+{
+    "name": "Temporal anti-aliasing Shader",
+    "vert": "./assets/shaders/glsl/FullScreen.vert",
+    "frag": "./assets/shaders/glsl/TAA.frag"
+}
\ No newline at end of file
@@ -0,0 +1,4 @@
+{
+    "name": "Tiled light culling compute shader",
+    "comp": "./assets/shaders/glsl/TiledLighting.comp"
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#version 460 core
+
+// Stretches the rendered corner of a target over the whole output, with bilinear filtering
+
+in vec2 fragmentUV;
+
+out vec4 outputColor;
+
+uniform sampler2D sourceTexture;
+uniform vec4 sourceRegion;  // The rendered size in uv in xy, half a texel in zw
+
+void main()
+{
+    // Kept half a texel inside, so the filter never blends in the unrendered texels
+    vec2 uv = min(fragmentUV * sourceRegion.xy, sourceRegion.xy - sourceRegion.zw);
+    outputColor = texture(sourceTexture, uv);
+}
\ No newline at end of file
@@ -0,0 +1,5 @@
+{
+    "name": "Upscale Shader",
+    "vert": "./assets/shaders/glsl/FullScreen.vert",
+    "frag": "./assets/shaders/glsl/Upscale.frag"
+}
\ No newline at end of file
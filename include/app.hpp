@@ -1,9 +1,13 @@
 #pragma once
 
 #include "codex/library.hpp"
+#include "codex/streamBuffer.hpp"
+#include "codex/geometryArena.hpp"
+#include "codex/materialTable.hpp"
 #include "echo/ui.hpp"
 #include "echo/event.hpp"
 #include "echo/console.hpp"
+#include "timestep.hpp"
 
 #include <SDL3/SDL.h>
 
@@ -36,6 +40,10 @@ public:
     constexpr inline echo::UIManager*    getUIManager()    const { return m_uiManager.get(); }
     constexpr inline echo::EventManager* getEventManager() const { return m_eventManager.get(); }
     constexpr inline codex::Library*     getLibrary()      const { return m_library.get(); }
+    constexpr inline codex::StreamBuffer* getStreamBuffer() const { return m_streamBuffer.get(); }
+    constexpr inline codex::GeometryArena* getGeometryArena() const { return m_geometryArena.get(); }
+    constexpr inline codex::MaterialTable* getMaterialTable() const { return m_materialTable.get(); }
+    inline FixedTimestep*                getTimestep()           { return &m_timestep; }
 protected:
     SDL_AppResult initSDL();
     SDL_AppResult initWindow();
@@ -49,6 +57,11 @@ protected:
     std::unique_ptr<echo::EventManager> m_eventManager;
 
     std::unique_ptr<codex::Library>          m_library;
+    std::unique_ptr<codex::StreamBuffer>     m_streamBuffer;
+    std::unique_ptr<codex::GeometryArena>    m_geometryArena;
+    std::unique_ptr<codex::MaterialTable>    m_materialTable;
+
+    FixedTimestep m_timestep;
 };
 
 }; // namespace cinder
\ No newline at end of file
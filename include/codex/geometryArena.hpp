@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace codex {
+
+// Forward declarations
+struct Layout;
+struct MeshPart;
+
+/**
+ * @brief A first-fit free-list allocator over a range of elements, merging neighbouring free ranges.
+ * Only hands out offsets, the storage itself is managed by the owner.
+ */
+class RangeAllocator {
+public:
+    static constexpr uint32_t INVALID = UINT32_MAX;
+
+    /**
+     * @param size The number of elements
+     * @return uint32_t The offset of the first element, or INVALID if there is no free range large enough
+     */
+    uint32_t allocate(uint32_t size);
+    void free(uint32_t offset, uint32_t size);
+    /**
+     * @brief Adds the elements between the current and the new capacity as free space.
+     */
+    void grow(uint32_t capacity);
+
+    inline uint32_t getCapacity() const { return m_capacity; }
+    inline uint32_t getUsed() const { return m_used; }
+    inline uint32_t getFreeRangeCount() const { return static_cast<uint32_t>(m_freeRanges.size()); }
+protected:
+    struct Range {
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    std::vector<Range> m_freeRanges; // Sorted by offset, never touching each other
+    uint32_t m_capacity = 0;
+    uint32_t m_used = 0;
+};
+
+/**
+ * @brief The location of a mesh's geometry in the arena.
+ * Vertex and index offsets are in elements, usable as base vertex and first index.
+ */
+struct GeometryAllocation {
+    static constexpr uint32_t NO_FORMAT = UINT32_MAX;
+
+    uint32_t format      = NO_FORMAT;
+    uint32_t firstVertex = 0;
+    uint32_t vertexCount = 0;
+    uint32_t firstIndex  = 0;
+    uint32_t indexCount  = 0;
+
+    inline bool isValid() const { return format != NO_FORMAT; }
+};
+
+/**
+ * @brief Counters of a single vertex format.
+ */
+struct GeometryFormatStats {
+    uint32_t stride;           // In bytes
+    uint32_t usedVertices;
+    uint32_t vertexCapacity;
+    uint32_t usedIndices;
+    uint32_t indexCapacity;
+    uint32_t freeRanges;       // Vertex and index ranges together, a measure of fragmentation
+};
+
+/**
+ * @brief Holds the geometry of every mesh, in one vertex and one index buffer per vertex format.
+ * Each format has a single vertex array, so meshes of the same format draw without switching it,
+ * and can be merged into multi-draws using their base vertex and first index.
+ * Buffers are immutable, running out of space replaces them with larger copies.
+ */
+class GeometryArena {
+public:
+    static constexpr uint32_t INITIAL_VERTICES = 1 << 16;
+    static constexpr uint32_t INITIAL_INDICES  = 1 << 18;
+
+    GeometryArena() = default;
+    ~GeometryArena();
+
+    GeometryArena(const GeometryArena&) = delete;
+    GeometryArena& operator=(const GeometryArena&) = delete;
+
+    /**
+     * @brief Finds space for the geometry and uploads it.
+     * 
+     * @param layout The vertex layout of the geometry
+     * @param data The vertices and indices
+     * @return GeometryAllocation The allocation, invalid if the geometry was empty
+     */
+    GeometryAllocation allocate(const std::vector<Layout>& layout, const MeshPart* data);
+    void free(GeometryAllocation& allocation);
+
+    /**
+     * @brief Reads the geometry back from the GPU. Slow, only meant for load time processing.
+     * The indices are relative to the first vertex of the allocation.
+     */
+    bool read(const GeometryAllocation& allocation, MeshPart* out) const;
+
+    /**
+     * @return uint32_t The vertex array of the format, with the index buffer attached
+     */
+    inline uint32_t getVertexArray(uint32_t format) const { return m_formats[format].vertexArray; }
+
+    inline uint32_t getFormatCount() const { return static_cast<uint32_t>(m_formats.size()); }
+    GeometryFormatStats getFormatStats(uint32_t format) const;
+protected:
+    struct Format {
+        std::vector<uint8_t> attributeSizes; // In bytes, see Layout::Type
+        uint32_t stride = 0;
+
+        uint32_t vertexArray  = 0;
+        uint32_t vertexBuffer = 0;
+        uint32_t indexBuffer  = 0;
+
+        RangeAllocator vertices;
+        RangeAllocator indices;
+    };
+
+    std::vector<Format> m_formats;
+
+    uint32_t findFormat(const std::vector<Layout>& layout);
+    /**
+     * @brief Replaces the buffer with a larger one, keeping its contents.
+     */
+    static uint32_t growBuffer(uint32_t buffer, RangeAllocator& allocator, uint32_t elementSize, uint32_t minimumCapacity);
+};
+
+}; // namespace codex
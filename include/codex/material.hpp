@@ -3,8 +3,10 @@
 #include "codex/resource.hpp"
 #include "codex/texture.hpp"
 #include "codex/shader.hpp"
+#include "codex/materialTable.hpp"
 
 #include <map>
+#include <vector>
 
 namespace codex {
 
@@ -30,9 +32,35 @@ public:
     void removeTexture(const std::string& name);
     const Texture* getTexture(const std::string& name) const;
     const std::map<std::string, Texture*>& getTextures() const { return m_data->textures; }
+    /**
+     * @param uniformHash The hashed name of the sampler uniform
+     * @return const Texture* The texture bound to the sampler, or nullptr
+     */
+    const Texture* getTextureForUniform(uint32_t uniformHash) const;
+
+    /**
+     * @brief Adds the material to the material table once its textures are loaded.
+     * @return uint32_t The index of the material in the table, or MaterialTable::NOT_RESIDENT
+     */
+    uint32_t getTableIndex();
+    inline bool isResident() const { return m_tableIndex != MaterialTable::NOT_RESIDENT; }
 protected:
     std::string m_name;
     std::map<std::string, Texture*> m_textures;
+
+    /**
+     * @brief A texture with the pre-hashed name of its sampler uniform.
+     */
+    struct TextureBinding {
+        uint32_t uniformHash;
+        Texture* texture;
+    };
+    std::vector<TextureBinding> m_textureBindings;
+
+    uint32_t m_tableIndex = MaterialTable::NOT_RESIDENT;
+    bool m_tableRejected = false; // The textures didn't fit into the table, not retried until they change
+
+    void rebuildTextureBindings();
 };
 
 }; // namespace codex
\ No newline at end of file
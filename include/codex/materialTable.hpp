@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace codex {
+
+// Forward declarations
+class Material;
+class Texture;
+
+/**
+ * @brief The per-material data read by the shaders, matching the std430 layout of `MaterialData` in GLSL.
+ * Every texture is packed as (pool << 16 | layer), or NO_TEXTURE.
+ */
+struct MaterialEntry {
+    static constexpr uint32_t NO_TEXTURE = UINT32_MAX;
+
+    std::array<uint32_t, 4> textures = { NO_TEXTURE, NO_TEXTURE, NO_TEXTURE, NO_TEXTURE };
+};
+
+/**
+ * @brief Keeps the textures of the materials in texture array pools, one pool per size and format,
+ * and the layers of every material in a GPU table.
+ * Draws read their material through an index, so switching materials costs no binds or uniform calls.
+ * Materials whose textures don't fit (too many different sizes) stay off the table, and bind their textures as before.
+ */
+class MaterialTable {
+public:
+    static constexpr int BINDING = 3;                  // The binding of the material table in the shaders
+    static constexpr uint32_t FIRST_POOL_UNIT = 8;     // Pools are bound to consecutive units from here
+    static constexpr uint32_t MAX_POOLS = 8;           // Matches the size of `materialPools` in the shaders
+    static constexpr uint32_t INITIAL_LAYERS = 4;
+    static constexpr uint32_t NOT_RESIDENT = UINT32_MAX;
+
+    /**
+     * @brief The sampler names the table has a slot for, in the order of `MaterialEntry::textures`.
+     */
+    static constexpr std::array<const char*, 3> SLOT_NAMES = { "textureDiffuse", "textureNormal", "textureAORoughnessMetallic" };
+
+    MaterialTable();
+    ~MaterialTable();
+
+    MaterialTable(const MaterialTable&) = delete;
+    MaterialTable& operator=(const MaterialTable&) = delete;
+
+    /**
+     * @brief Packs the textures of the material into the pools, and writes its entry.
+     * 
+     * @param material The material, its textures have to be initialized
+     * @return uint32_t The index of the material in the table, or NOT_RESIDENT if it didn't fit
+     */
+    uint32_t add(const Material* material);
+    /**
+     * @brief Repacks a material already in the table, after its textures changed.
+     * @return bool If the material is still resident
+     */
+    bool update(uint32_t index, const Material* material);
+    void remove(uint32_t index);
+
+    /**
+     * @brief Uploads the table if it changed, and binds it with the pools.
+     */
+    void bind();
+
+    inline uint32_t getMaterialCount() const { return static_cast<uint32_t>(m_entries.size() - m_freeEntries.size()); }
+    inline uint32_t getPoolCount() const { return static_cast<uint32_t>(m_pools.size()); }
+protected:
+    /**
+     * @brief A texture array holding every texture of a size and format.
+     */
+    struct Pool {
+        int width;
+        int height;
+        uint32_t internalFormat;
+        int levels;
+
+        uint32_t handle = 0;
+        uint32_t layerCapacity = 0;
+        uint32_t usedLayers = 0;
+        std::vector<uint32_t> freeLayers;
+    };
+
+    /**
+     * @brief A texture packed into a pool, shared by the materials using it.
+     */
+    struct PackedTexture {
+        const Texture* texture;
+        uint32_t location;  // (pool << 16 | layer)
+        uint32_t users;
+    };
+
+    std::vector<Pool> m_pools;
+    std::vector<PackedTexture> m_packedTextures;
+
+    std::vector<MaterialEntry> m_entries;  // Entry 0 is the empty material, used by draws without one
+    std::vector<uint32_t> m_freeEntries;
+    bool m_dirty = true;
+
+    uint32_t m_bufferHandle = 0;
+    size_t m_bufferCapacity = 0; // In entries
+
+    /**
+     * @return bool If the textures of the material fit into the pools
+     */
+    bool pack(const Material* material, MaterialEntry& entry);
+    void release(const MaterialEntry& entry);
+    /**
+     * @return uint32_t The packed location of the texture, or MaterialEntry::NO_TEXTURE
+     */
+    uint32_t acquireTexture(const Texture* texture);
+    void releaseTexture(uint32_t location);
+    uint32_t findPool(const Texture* texture);
+    void growPool(Pool& pool);
+};
+
+}; // namespace codex
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "codex/resource.hpp"
+#include "codex/geometryArena.hpp"
 #include "floatmath.hpp"
 
 #include <assimp/scene.h>
@@ -33,7 +34,7 @@ public:
         return m_type;
     }
 
-    static inline constexpr const uint8_t calculateOffset(std::vector<Layout>& layout, int index) {
+    static inline constexpr const uint8_t calculateOffset(const std::vector<Layout>& layout, int index) {
         uint8_t offset = 0;
         for (int i = 0; i < index; i++) {
             offset += layout[i].m_type;
@@ -41,7 +42,7 @@ public:
         return offset;
     }
 
-    static inline constexpr const uint8_t calculateStride(std::vector<Layout>& layout) {
+    static inline constexpr const uint8_t calculateStride(const std::vector<Layout>& layout) {
         return calculateOffset(layout, layout.size());
     }
 
@@ -55,43 +56,112 @@ struct MeshPart {
     uint32_t vertexCount = -1;
     uint32_t indexCount  = -1;
     transformf partTransform;
+    boundsf bounds;
+    uint8_t lodLevel = 0; // 0 is the full detail mesh, parsed from the "_LOD<n>" node name suffix
 
     MeshPart() = default;
     ~MeshPart() = default;
 };
 
+/**
+ * @brief The indices of a single piece of geometry, everything an indirect draw command needs.
+ */
+struct DrawRange {
+    uint32_t vertexArray;
+    uint32_t indexCount;
+    uint32_t firstIndex;
+    int32_t  baseVertex;
+};
+
 struct MeshData {
     std::vector<Layout> layout;
     std::vector<std::unique_ptr<MeshPart>> meshParts;
 };
 
+/**
+ * @brief Settings for generating detail levels at import time,
+ * used only when the source file has no authored LODs.
+ */
+struct LODGenerationSettings {
+    static constexpr int   MAX_LEVELS         = 3;      // Number of generated levels (excluding the base mesh)
+    static constexpr int   MIN_TRIANGLE_COUNT = 512;    // Parts below this are reused as-is on every level
+    static constexpr float BASE_CELL_SIZE     = 0.01f;  // Clustering cell size relative to the bounds diagonal
+};
+
 class Mesh : public IResource<MeshData> {
 public:
     Mesh(MeshPart* data, std::vector<Layout>& layout);
+    /**
+     * @brief Creates a mesh without geometry of its own, drawing the given parts.
+     * Used for detail levels, the parts are not owned by the mesh.
+     */
+    Mesh(const std::vector<Mesh*>& parts, const boundsf& bounds);
     Mesh();
     ~Mesh();
 
+    /**
+     * @brief Creates a mesh from geometry generated at runtime, registered to (and owned by) the library.
+     * 
+     * @param data The geometry of the mesh
+     * @param layout The vertex layout of the geometry
+     * @param name The name of the runtime node of the mesh
+     * @param folderNode The runtime folder to place the mesh in (optional)
+     * @return Mesh* The new mesh, or nullptr if the node couldn't be created
+     */
+    static Mesh* createRuntimeMesh(MeshPart* data, std::vector<Layout>& layout, const std::string& name, FileNode* folderNode = nullptr);
+
     void loadData(const FileNode* node) override;
     void loadResource() override;
 
     inline transformf* getTransform() const { return m_transform; }
 
+    /**
+     * @return const boundsf& The local space bounds of all parts of the mesh
+     */
+    inline const boundsf& getBounds() const { return m_bounds; }
+
+    /**
+     * @brief The reduced detail versions of the mesh, authored (`_LOD<n>` nodes) or generated at import.
+     * @return const std::vector<Mesh*>& Level 1 to n, the mesh itself being level 0
+     */
+    inline const std::vector<Mesh*>& getLODs() const { return m_lods; }
+
+    /**
+     * @return const std::vector<Mesh*>& The full detail parts of the mesh
+     */
+    inline const std::vector<Mesh*>& getParts() const { return m_meshParts; }
+    inline const std::vector<Layout>& getLayout() const { return m_layout; }
+
+    /**
+     * @brief Reads the geometry of the mesh (not including its parts) back from the GPU.
+     * Slow, only meant for load time processing, like static batching.
+     * 
+     * @param out The part to fill with the vertices and indices
+     * @return true If the mesh had geometry to read
+     */
+    bool readVertexData(MeshPart* out);
+
     void draw() const;
+    /**
+     * @brief Appends the geometry of the mesh and all its parts, for building indirect draws.
+     * 
+     * @param out The ranges, one for every part with geometry
+     */
+    void collectDrawRanges(std::vector<DrawRange>& out) const;
 protected:
     void loadDataRecursive(MeshData* data, const aiNode* node, const aiScene* scene, transformf* parentTransform = nullptr);
+    void createLODs(FileNode* folderNode, std::vector<Mesh*>& baseParts);
 
     std::vector<Layout> m_layout;
 
-    uint32_t m_vertexArrayObjectHandle  = -1;
-    uint32_t m_vertexBufferObjectHandle = -1;
-    uint32_t m_indexBufferObjectHandle  = -1;
-
-    uint32_t m_vertexCount;
-    uint32_t m_indexCount;
+    // The geometry of the mesh itself in the arena, invalid for meshes only drawing their parts
+    GeometryAllocation m_geometry;
 
     void uploadData(MeshPart* data);
     std::vector<Mesh*> m_meshParts;
+    std::vector<Mesh*> m_lods;
     transformf* m_transform;
+    boundsf m_bounds;
 
     static bool m_suppressDestroyMessage;
 };
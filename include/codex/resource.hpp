@@ -30,8 +30,17 @@ protected:
  */
 template<typename DataType>
 class IResource : public IResourceBase {
+public:
+    /**
+     * @return uint32_t A small, unique, sequential id among the resources of the same type, starting from 1 (used for sorting draws)
+     */
+    inline uint32_t getResourceID() const { return m_resourceID; }
 protected:
     std::unique_ptr<DataType> m_data; // The resource data (Freed after loading)
+
+    // Counted per type, so the many mesh parts and textures don't use up the id range of the shaders and materials
+    static inline uint32_t s_nextResourceID = 1;
+    const uint32_t m_resourceID = s_nextResourceID++;
 };
 
 }; // namespace codex
\ No newline at end of file
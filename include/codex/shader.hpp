@@ -5,8 +5,10 @@
 
 #include <SDL3/SDL.h>
 
+#include <memory>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <vector>
 
 namespace codex {
 
@@ -22,23 +24,20 @@ struct alignas(16) UniformBufferData {};
  * Allow a direct interface to OpenGL uniform buffers.
  * Using this there's no need to manually name and set uniform locations.
  * The data update is done by the user, at once.
+ * Every update is written to a new part of the app's stream buffer, and bound by offset,
+ * so updating it multiple times a frame (for example once per view) never waits for the GPU.
  */
 class UniformBuffer {
 public:
     UniformBuffer(size_t size, int binding);
 
     /**
-     * @brief Binds the uniform buffer. Required before updating data.
-     */
-    void bind();
-    /**
-     * @brief Updates the data in the uniform buffer.
-     * Automatically binds the buffer.
+     * @brief Updates the data in the uniform buffer, and binds it.
      * @param data The data to update the buffer with.
      */
     void updateData(const UniformBufferData* data);
 protected:
-    unsigned int m_uniformBufferObjectHandle;
+    int m_binding;
     size_t m_size;
 };
 
@@ -48,13 +47,56 @@ protected:
 struct ShaderData {
 public:
     std::string vertexShaderSource;
-    std::string fragmentShaderSource;
+    std::string fragmentShaderSource; // Empty for depth-only programs
+    std::string computeShaderSource; // Compute shaders have no other stages
+    bool instancing = false; // If an instanced variant should be compiled too
+};
+
+/**
+ * @brief FNV-1a hash of a uniform name, usable at compile time.
+ */
+constexpr uint32_t hashUniformName(std::string_view name) {
+    uint32_t hash = 2166136261u;
+    for (const char character : name) {
+        hash = (hash ^ static_cast<uint8_t>(character)) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief A uniform name, hashed at compile time when created from a string literal.
+ * The name itself is only kept for the duration of the call, for warnings.
+ */
+struct UniformName {
+    uint32_t hash;
+    const char* name;
+
+    consteval UniformName(const char* name) : hash(hashUniformName(name)), name(name) {}
+    /**
+     * @brief Hashes a runtime name, meant for load time (for example material texture names).
+     */
+    explicit UniformName(const std::string& name) : hash(hashUniformName(name)), name(name.c_str()) {}
+
+    static constexpr UniformName fromHash(uint32_t hash) { return UniformName(hash); }
+private:
+    constexpr explicit UniformName(uint32_t hash) : hash(hash), name(nullptr) {}
+};
+
+/**
+ * @brief A resolved uniform location of a single shader, typed by the value it accepts.
+ * Setting an invalid handle is a no-op, so optional uniforms don't need checks.
+ */
+template<typename T>
+struct UniformHandle {
+    int location = -1;
+
+    inline bool isValid() const { return location >= 0; }
 };
 
 /**
  * @brief The OpenGL shader encapsulating class.
  * Allows for easy shader creation and management.
- * Manages and caches uniform locations.
+ * The active uniforms are reflected once the program is linked, so setting them does no string work.
  */
 class Shader : public IResource<ShaderData> {
 public:
@@ -62,18 +104,81 @@ public:
     virtual ~Shader();
 
     void bind();
+    /**
+     * @brief Binds and runs a compute shader, the caller issues the memory barriers its results need.
+     * 
+     * @param groupsX The number of work groups along X
+     * @param groupsY The number of work groups along Y
+     * @param groupsZ The number of work groups along Z
+     */
+    void dispatch(uint32_t groupsX, uint32_t groupsY = 1, uint32_t groupsZ = 1);
+    inline bool isCompute() const { return m_compute; }
+
+    /**
+     * @brief Gets the instanced variant of the shader, compiled with INSTANCED defined.
+     * The variant reads the model matrices from the instance buffer, instead of the modelMatrix uniform.
+     * 
+     * @return Shader* The variant, or nullptr if the shader doesn't support instancing
+     */
+    inline Shader* getInstancedVariant() const { return m_instancedVariant.get(); }
     
-    void setUniform(const std::string& name, const int& value);
-    void setUniform(const std::string& name, const vector4f& value);
-    void setUniform(const std::string& name, const matrix4x4f& value);
+    /**
+     * @brief Resolves a uniform of the shader, meant to be done once, outside of the per-draw path.
+     * 
+     * @param name The name of the uniform
+     * @return UniformHandle<T> The handle, invalid if the shader has no such uniform of a matching type
+     */
+    template<typename T>
+    UniformHandle<T> getUniformHandle(UniformName name) const;
+
+    void setUniform(UniformHandle<int> handle, const int& value);
+    void setUniform(UniformHandle<float> handle, const float& value);
+    void setUniform(UniformHandle<vector4f> handle, const vector4f& value);
+    void setUniform(UniformHandle<matrix4x4f> handle, const matrix4x4f& value);
+
+    /**
+     * @brief Sets a uniform by name, looked up by its hash. Missing uniforms are only reported once.
+     * The shader has to be bound.
+     */
+    void setUniform(UniformName name, const int& value);
+    void setUniform(UniformName name, const float& value);
+    void setUniform(UniformName name, const vector4f& value);
+    void setUniform(UniformName name, const matrix4x4f& value);
 
     void loadData(const FileNode* file) override;
     void loadResource() override;
 protected:
     unsigned int m_programHandle;
-    std::unordered_map<std::string, unsigned int> m_uniformLocations;
+    bool m_compute = false;
 
-    unsigned int getUniformLocation(const std::string& name);
+    /**
+     * @brief An active uniform of the linked program.
+     */
+    struct UniformInfo {
+        uint32_t hash;
+        int location;
+        unsigned int type;
+        std::string name;
+    };
+
+    std::vector<UniformInfo> m_uniforms; // Sorted by hash
+    mutable std::vector<uint32_t> m_missingUniforms; // Already reported
+
+    std::unique_ptr<Shader> m_instancedVariant = nullptr;
+
+    /**
+     * @brief Reads the active uniforms of the linked program.
+     */
+    void reflectUniforms();
+    const UniformInfo* findUniform(UniformName name) const;
+
+    /**
+     * @brief Compiles and links a program from the given sources.
+     * 
+     * @return unsigned int The handle of the program
+     */
+    static unsigned int compileProgram(const std::string& vertexShaderSource, const std::string& fragmentShaderSource);
+    static unsigned int compileComputeProgram(const std::string& computeShaderSource);
 };
 
 }; // namespace codex
\ No newline at end of file
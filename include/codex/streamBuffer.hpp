@@ -0,0 +1,90 @@
+#pragma once
+
+#include <glad.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace codex {
+
+/**
+ * @brief A part of the stream buffer, valid until the end of the frame.
+ */
+struct StreamAllocation {
+    void* pointer = nullptr; // Persistently mapped, written directly
+    uint32_t buffer = 0;
+    size_t offset = 0;
+    size_t size = 0;
+
+    inline bool isValid() const { return pointer != nullptr; }
+};
+
+/**
+ * @brief A persistently mapped buffer for per-frame data (uniform blocks, instance data).
+ * The buffer is split into a ring of frame regions, each guarded by a fence,
+ * so writing a region only waits if the GPU is still reading it from frames ago.
+ * Allocations are bound by offset, so any number of blocks share the single buffer without mapping or orphaning.
+ */
+class StreamBuffer {
+public:
+    static constexpr uint32_t FRAME_COUNT = 3;
+
+    /**
+     * @param frameSize The size of a single frame region in bytes
+     */
+    StreamBuffer(size_t frameSize);
+    ~StreamBuffer();
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    /**
+     * @brief Moves to the next frame region, waiting for the GPU to finish reading it if needed.
+     * Grows the buffer, if the last frames ran out of space.
+     */
+    void beginFrame();
+    /**
+     * @brief Fences the current region, call once every command using it was issued.
+     */
+    void endFrame();
+
+    /**
+     * @brief Allocates space in the current frame region.
+     * 
+     * @param size The size in bytes
+     * @param target The binding target, the allocation is aligned for it (`GL_UNIFORM_BUFFER` or `GL_SHADER_STORAGE_BUFFER`)
+     * @return StreamAllocation The allocation, invalid if the region is full
+     */
+    StreamAllocation allocate(size_t size, uint32_t target);
+
+    inline uint32_t getHandle() const { return m_bufferHandle; }
+    inline size_t getFrameSize() const { return m_frameSize; }
+    inline size_t getUsedSize() const { return m_offset; }
+    inline uint32_t getStallCount() const { return m_stallCount; }
+protected:
+    uint32_t m_bufferHandle = 0;
+    std::byte* m_mapped = nullptr;
+
+    size_t m_frameSize;
+    size_t m_requestedFrameSize; // Grown on overflow, applied at the start of the next frame
+
+    uint32_t m_frame = 0;
+    size_t m_offset = 0;
+    std::array<GLsync, FRAME_COUNT> m_fences = {};
+
+    size_t m_uniformAlignment = 256;
+    size_t m_storageAlignment = 256;
+
+    uint32_t m_stallCount = 0; // The number of times the CPU had to wait for the GPU
+
+    void create();
+    void destroy();
+    void waitForFence(uint32_t frame);
+    /**
+     * @return size_t The size rounded up to both binding alignments, so every frame region starts aligned
+     */
+    size_t alignFrameSize(size_t size) const;
+};
+
+}; // namespace codex
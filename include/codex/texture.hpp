@@ -68,9 +68,19 @@ public:
     int getWidth() const { return m_width; }
     int getHeight() const { return m_height; }
     int getChannels() const { return m_channels; }
+    /**
+     * @return unsigned int The OpenGL internal format of the texture
+     */
+    unsigned int getInternalFormat() const { return m_internalFormat; }
+    /**
+     * @return int The number of mip levels the texture has
+     */
+    int getLevels() const { return m_levels; }
 protected:
     unsigned int m_textureHandle;
     int m_width, m_height, m_channels;
+    unsigned int m_internalFormat = 0;
+    int m_levels = 1;
     bool m_highPrecision = false;
 };
 
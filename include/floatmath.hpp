@@ -3,6 +3,7 @@
 #include <SDL3/SDL.h>
 
 #include <array>
+#include <cfloat>
 #include <xmmintrin.h>
 
 /*
@@ -18,6 +19,7 @@ typedef float degrees;
 struct vector4f;
 struct matrix4x4f;
 struct transformf;
+struct boundsf;
 
 /**
  * @brief 4D vector of floats.
@@ -47,6 +49,16 @@ struct alignas(16) vector4f {
     static constexpr const vector4f back()  { return vector4f( 0.0f,  0.0f,  1.0f,  0.0f); }
     static constexpr const vector4f front() { return vector4f( 0.0f,  0.0f, -1.0f,  0.0f); }
 
+    /**
+     * @brief Linear interpolation between two vectors.
+     * 
+     * @param from The vector at t = 0
+     * @param to The vector at t = 1
+     * @param t The interpolation factor
+     * @return vector4f The interpolated vector
+     */
+    static vector4f lerp(const vector4f& from, const vector4f& to, float t);
+
     /**
      * @return float The length of the vector.
      */
@@ -266,6 +278,10 @@ struct alignas(16) matrix4x4f {
      * @return matrix4x4f The transpose of the matrix.
      */
     matrix4x4f transpose() const;
+    /**
+     * @return matrix4x4f The inverse of the matrix, or the identity if the matrix is singular.
+     */
+    matrix4x4f inverse() const;
 
     matrix4x4f operator+(const matrix4x4f& other) const;
     matrix4x4f operator-(const matrix4x4f& other) const;
@@ -316,7 +332,7 @@ public:
     /**
      * @param position The new position of the object.
      */
-    inline void setPosition(const vector4f& position) { this->m_position = position; m_dirty = true; }
+    inline void setPosition(const vector4f& position) { beginChange(); this->m_position = position; markDirty(); }
 
     /**
      * @return vector4f The rotation of the object.
@@ -325,7 +341,7 @@ public:
     /**
      * @param rotation The new rotation of the object.
      */
-    inline void setRotation(const vector4f& rotation) { this->m_rotation = rotation; m_dirty = true; }
+    inline void setRotation(const vector4f& rotation) { beginChange(); this->m_rotation = rotation; markDirty(); }
 
     /**
      * @return vector4f The scale of the object.
@@ -334,7 +350,7 @@ public:
     /**
      * @param scale The new scale of the object.
      */
-    inline void setScale(const vector4f& scale) { this->m_scale = scale; m_dirty = true; }
+    inline void setScale(const vector4f& scale) { beginChange(); this->m_scale = scale; markDirty(); }
 
     /**
      * @return const std::shared_ptr<transformf>& The parent transform of the object.
@@ -346,7 +362,7 @@ public:
      * 
      * @param parent The parent transform. If `nullptr`, the object will be parentless.
      */
-    inline void setParent(transformf* parent) { this->m_parent = parent; m_dirty = true; }
+    inline void setParent(transformf* parent) { this->m_parent = parent; markDirty(); }
 
     /**
      * @param movement The vector to move the object by. (in local space)
@@ -367,6 +383,20 @@ public:
      */
     matrix4x4f& getModelMatrix();
 
+    /**
+     * @brief Starts a new simulation tick for every transform.
+     * Transforms save their previous state lazily, the first time they change within a tick,
+     * so unchanged transforms cost nothing.
+     */
+    static inline void beginSimulationTick() { s_simulationTick++; }
+    /**
+     * @brief Gets the model matrix between the previous and the current simulation state, used for rendering.
+     * 
+     * @param alpha The interpolation factor, 0 being the previous and 1 the current state
+     * @return matrix4x4f The interpolated model matrix
+     */
+    matrix4x4f getInterpolatedModelMatrix(float alpha);
+
     /**
      * @brief Gets the position of the object, but in a direct way.
      * This is not recommended to use, as it does not update the model matrix.
@@ -426,7 +456,15 @@ public:
      * This will cause the model matrix to be recalculated on the next call to `getModelMatrix()`.
      * Mostly used for internal purposes.
      */
-    inline void markDirty() { m_dirty = true; }
+    inline void markDirty() { beginChange(); m_dirty = true; m_version++; }
+
+    /**
+     * @brief A counter changing every time the transform (or any of its parents) is modified.
+     * Used for cheaply detecting movement, for example by cached shadow maps.
+     *
+     * @return uint32_t The version of the transform.
+     */
+    inline uint32_t getVersion() const { return m_version + (m_parent != nullptr ? m_parent->getVersion() : 0); }
 protected:
     transformf* m_parent = nullptr;
 
@@ -437,4 +475,84 @@ protected:
     matrix4x4f m_modelMatrix;
 
     bool m_dirty = true;
+    uint32_t m_version = 0;
+
+    // The state at the start of the last simulation tick the transform changed in
+    vector4f m_previousPosition = vector4f::zero();
+    vector4f m_previousRotation = vector4f::zero();
+    vector4f m_previousScale    = vector4f::one();
+    uint32_t m_previousTick     = UINT32_MAX; // Never changed yet
+
+    static inline uint32_t s_simulationTick = 0;
+
+    /**
+     * @brief Saves the previous state, if this is the first change within the current tick.
+     * Changes through the unsafe accessors only call `markDirty` afterwards, those snap instead of interpolating.
+     */
+    inline void beginChange() {
+        if (m_previousTick == s_simulationTick)
+            return;
+        m_previousPosition = m_position;
+        m_previousRotation = m_rotation;
+        m_previousScale    = m_scale;
+        m_previousTick     = s_simulationTick;
+    }
+
+    /**
+     * @return true If the transform, or any of its parents changed during the last tick
+     */
+    bool isMovingThisTick() const;
+
+    static matrix4x4f composeModelMatrix(const vector4f& position, const vector4f& rotation, const vector4f& scale);
+};
+
+/**
+ * @brief Axis aligned bounding box.
+ * Used for LOD selection and culling, an empty box is marked by min > max.
+ */
+struct alignas(16) boundsf {
+    vector4f min = vector4f( FLT_MAX,  FLT_MAX,  FLT_MAX, 0.0f);
+    vector4f max = vector4f(-FLT_MAX, -FLT_MAX, -FLT_MAX, 0.0f);
+
+    boundsf() {}
+    boundsf(const vector4f& min, const vector4f& max) : min(min), max(max) {}
+
+    /**
+     * @return bool If the box contains at least a single point.
+     */
+    inline bool isValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+
+    /**
+     * @return vector4f The center of the box. (w = 1)
+     */
+    vector4f center() const;
+    /**
+     * @return vector4f The half size of the box on each axis. (w = 0)
+     */
+    vector4f extents() const;
+    /**
+     * @return float The radius of the bounding sphere around the box.
+     */
+    float radius() const;
+
+    /**
+     * @brief Grows the box to contain the point.
+     * 
+     * @param point The point to include.
+     */
+    void expand(const vector4f& point);
+    /**
+     * @brief Grows the box to contain the other box.
+     * 
+     * @param other The box to include.
+     */
+    void merge(const boundsf& other);
+
+    /**
+     * @brief Transforms the box, the result still being axis aligned.
+     * 
+     * @param matrix The model matrix to transform with.
+     * @return boundsf The box containing the transformed box.
+     */
+    boundsf transformed(const matrix4x4f& matrix) const;
 };
\ No newline at end of file
@@ -9,17 +9,26 @@
 
 namespace hex {
 
+// Forward declaration
+class Prefab;
+
 class Actor {
 public:
     Actor(Actor* parent = nullptr);
     ~Actor();
 
-    // TODO: Add explicit deep copy
+    // Use prefabs for copying actors (See `Prefab`)
     Actor(const Actor&) = delete;
     Actor& operator=(const Actor&) = delete;
 
-    void update();
-    void render(codex::Shader* overrideShader = nullptr);
+    /**
+     * @brief Actors are allocated from a pool of fixed size blocks,
+     * so spawning many of them (for example from a prefab) doesn't hit the heap for each one.
+     */
+    static void* operator new(size_t size);
+    static void operator delete(void* pointer, size_t size);
+
+    void render(const prism::View& view);
 
     template<typename ComponentType = Component, typename... Args>
     bool addComponent(Args&&... args) {
@@ -47,6 +56,8 @@ public:
         return false;
     }
     
+    inline const std::vector<std::unique_ptr<Component>>& getComponents() const { return m_components; }
+
     template<typename ComponentType = Component>
     ComponentType* getComponent(bool mayBeNull = false) const {
         for (const auto& component : m_components) {
@@ -71,14 +82,50 @@ public:
     inline void setEnabled(const bool enabled) { m_enabled = enabled; }
     inline bool isEnabled() const { return m_enabled; }
 
+    /**
+     * @brief Static actors never move, so their geometry can be merged by the scene. (See `Scene::requestStaticBatching`)
+     */
+    inline void setStatic(const bool isStatic) { m_static = isStatic; }
+    inline bool isStatic() const { return m_static; }
+
+    /**
+     * @brief Marks the actors created by static batching, so they aren't merged again.
+     */
+    inline void setStaticBatch(const bool isStaticBatch) { m_staticBatch = isStaticBatch; }
+    inline bool isStaticBatch() const { return m_staticBatch; }
+
     void editorUI();
-    inline void setEditorExpanded(const bool expanded) { m_editorExpanded = expanded; }
+    inline void setEditorExpanded(const bool expanded) { m_editorExpanded = expanded; s_hierarchyRevision++; }
     inline bool isEditorExpanded() const { return m_editorExpanded; }
 
-    inline void setName(const std::string& name) { m_name = name; }
+    inline void setName(const std::string& name) { m_name = name; s_hierarchyRevision++; }
     inline const std::string& getName() const { return m_name; }
+
+    /**
+     * @brief A counter changing every time any actor is created, destroyed, renamed, reparented or expanded in the editor.
+     * Used for caching the views of the hierarchy.
+     *
+     * @return uint64_t The revision of the hierarchy
+     */
+    static inline uint64_t getHierarchyRevision() { return s_hierarchyRevision; }
 protected:
+    friend class Prefab;
+
+    /**
+     * @brief Copies the prototype actor, without its children, silently.
+     * 
+     * @param parent The parent of the copy
+     * @param prototype The actor to copy
+     */
+    Actor(Actor* parent, const Actor& prototype);
+
+    static inline uint64_t s_hierarchyRevision = 0;
+    // Pooled prefab copies despawn in bulk, only the first destruction is logged
+    static inline bool s_suppressDestroyMessage = false;
+
     bool m_enabled = true;
+    bool m_static = false;
+    bool m_staticBatch = false;
     bool m_editorExpanded = true;
 
     std::string m_name;
@@ -32,6 +32,8 @@ struct CameraUniformBufferData : codex::UniformBufferData {
     matrix4x4f projection;
     vector4f m_position;
     vector4f m_forward;
+    matrix4x4f viewProjection;          // Without the jitter, for the motion vectors
+    matrix4x4f previousViewProjection;  // Of the last rendered frame, without the jitter
 };
 
 class alignas(16) Camera {
@@ -50,11 +52,25 @@ protected:
 
             vector4f m_position;
             vector4f m_forward;
+
+            matrix4x4f m_viewProjection;
+            matrix4x4f m_previousViewProjection;
         };
         CameraUniformBufferData m_shaderBufferData;
     };
     vector4f m_rotation;
 
+    // Sub-pixel offset of the projection in normalized device coordinates, for temporal anti-aliasing
+    vector4f m_jitter;
+    matrix4x4f m_unjitteredProjection;
+    bool m_frameStarted = false;
+
+    // The state at the start of the last simulation tick
+    vector4f m_previousPosition;
+    vector4f m_previousRotation;
+    float m_interpolation = 1.0f;
+    CameraUniformBufferData m_interpolatedBufferData;
+
     bool m_isOrthographic = false;
 public:
     Camera(CameraViewport viewport, float fieldOfView, vector4f position, vector4f rotation);
@@ -63,11 +79,44 @@ public:
 
     void update(CameraInput& input, float deltaTime, float mouseSensitivity = 0.314f);
 
+    /**
+     * @brief Saves the current state as the previous simulation state.
+     * Called at the start of every simulation tick.
+     */
+    void storePreviousState();
+    /**
+     * @brief Sets where the rendered state is between the previous and the current simulation state.
+     * 
+     * @param alpha The interpolation factor, 0 being the previous and 1 the current state
+     */
+    inline void setInterpolation(float alpha) { m_interpolation = alpha; }
+    vector4f getInterpolatedPosition() const;
+    vector4f getInterpolatedRotation() const;
+
     void updateViewMatrix();
     matrix4x4f getViewMatrix();
 
     void updateProjectionMatrix();
+    /**
+     * @return matrix4x4f The projection, offset by the jitter of the frame
+     */
     matrix4x4f getProjectionMatrix();
+    inline const matrix4x4f& getUnjitteredProjectionMatrix() const { return m_unjitteredProjection; }
+    inline const matrix4x4f& getPreviousViewProjectionMatrix() const { return m_previousViewProjection; }
+    inline const vector4f& getJitter() const { return m_jitter; }
+
+    /**
+     * @brief Starts a rendered frame, call once a frame after setting the interpolation.
+     * The view projection of the last frame is kept for the motion vectors,
+     * and the projection is offset by the jitter.
+     * 
+     * @param jitter The sub-pixel offset in normalized device coordinates (x and y)
+     */
+    void beginFrame(const vector4f& jitter);
+    /**
+     * @brief Makes the camera orthographic with new bounds, for cameras fitted every frame (like shadow cascades).
+     */
+    void setOrthographic(float left, float right, float bottom, float top, float nearPlane, float farPlane);
 
     void updateForwardVector();
     const vector4f& getForwardVector();
@@ -81,10 +130,10 @@ public:
     void setFieldOfView(float fieldOfView) { m_fieldOfView = fieldOfView; }
 
     const vector4f& getPosition() const { return m_position; }
-    void setPosition(vector4f position) { m_position = position; }
+    void setPosition(vector4f position) { m_position = m_previousPosition = position; }
 
     const vector4f& getRotation() const { return m_rotation; }
-    void setRotation(vector4f rotation) { m_rotation = rotation; }
+    void setRotation(vector4f rotation) { m_rotation = m_previousRotation = rotation; }
 
     void cameraWindow(bool separateWindow = true);
 
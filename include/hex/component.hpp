@@ -1,14 +1,28 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <string>
 
 #include "codex/shader.hpp"
+#include "prism/view.hpp"
 
 namespace hex {
 
 // Forward declaration
 class Actor;
+class TickScheduler;
+
+/**
+ * @brief The groups components are updated in, in order. (See `TickScheduler`)
+ */
+enum class TickGroup : uint8_t {
+    PRE_PHYSICS, // Before the simulation, for example input handling
+    UPDATE,      // The default group
+    POST_UPDATE, // After everything moved, for example actors following others
+    ON_DEMAND,   // Ticks once every time it's woken, then goes back to sleep
+    NONE         // Never ticks
+};
 
 #define ImplementComponentType(type) \
     public: \
@@ -22,8 +36,8 @@ class Actor;
 
 class Component {
 public:
-    Component(Actor* actor) : m_actor(actor) { m_dependenciesFound = resolveDependencies(); }
-    virtual ~Component() = default;
+    Component(Actor* actor) : m_actor(actor) { m_dependenciesFound = resolveDependencies(); s_tickRevision++; }
+    virtual ~Component() { s_tickRevision++; }
 
     using ComponentTypeID = std::uint32_t;
     
@@ -36,14 +50,59 @@ public:
     virtual ComponentTypeID getID() const = 0;
     virtual constexpr const std::string getPrettyName() const = 0;
 
-    virtual void update() = 0;
-    virtual void render(codex::Shader* overrideShader = nullptr) = 0;
+    /**
+     * @brief Runs a simulation tick of the component, called by the tick scheduler of the scene.
+     * 
+     * @param deltaTime The time since the last update of the component, in seconds
+     */
+    virtual void update(float deltaTime) = 0;
+    virtual void render(const prism::View& view) = 0;
+
+    /**
+     * @brief Creates a copy of the component for another actor, used when instantiating prefabs.
+     * Read-only data may be shared between the copies.
+     * The dependencies of the copy are resolved by the actor, once all of its components are copied.
+     * 
+     * @param actor The actor owning the copy
+     * @return std::unique_ptr<Component> The copy, or nullptr if the component can't be copied
+     */
+    virtual std::unique_ptr<Component> clone(Actor* actor) const { return nullptr; }
 
     Actor* const getActor() const;
 
     inline void setEnabled(const bool enabled) { m_enabled = enabled; }
     inline bool isEnabled() const { return m_dependenciesFound && m_enabled; }
 
+    inline void setTickGroup(const TickGroup group) { m_tickGroup = group; s_tickRevision++; }
+    inline TickGroup getTickGroup() const { return m_tickGroup; }
+    /**
+     * @param interval The component is only updated every Nth tick, with the delta time of N ticks
+     */
+    inline void setTickInterval(const uint32_t interval) { m_tickInterval = interval > 0 ? interval : 1; s_tickRevision++; }
+    inline uint32_t getTickInterval() const { return m_tickInterval; }
+
+    /**
+     * @brief Stops updating the component until it's woken.
+     */
+    inline void sleep() { m_sleeping = true; }
+    /**
+     * @brief Resumes updating the component, from the next tick.
+     */
+    void wake();
+    inline bool isSleeping() const { return m_sleeping; }
+    /**
+     * @brief Makes the component wake up by itself, when the transform of its actor changes while it sleeps.
+     */
+    inline void setWakeOnTransformChange(const bool wakeOnChange) { m_wakeOnTransformChange = wakeOnChange; }
+
+    /**
+     * @brief A counter changing every time a component is created, destroyed, or changes how it ticks.
+     * Used by the tick schedulers to know when to rebuild their lists.
+     *
+     * @return uint64_t The revision of the tick registrations
+     */
+    static inline uint64_t getTickRevision() { return s_tickRevision; }
+
     /**
      * @brief Resolve dependencies for the component.
      * For example, a renderer component may need to resolve its transform component.
@@ -55,10 +114,24 @@ public:
     virtual void onParentChanged() { m_dependenciesFound = resolveDependencies(); }
     virtual void editorUI();
 protected:
+    friend class TickScheduler;
+
     bool m_enabled = true;
     bool m_dependenciesFound = false;
     Actor* m_actor = nullptr;
 
+    static inline uint64_t s_tickRevision = 0;
+
+    TickGroup m_tickGroup = TickGroup::UPDATE;
+    uint32_t m_tickInterval = 1;
+    uint32_t m_tickPhase = 0;
+    bool m_sleeping = false;
+    bool m_wakeOnTransformChange = false;
+
+    // Set by the scheduler the component is registered in
+    TickScheduler* m_scheduler = nullptr;
+    bool m_inActiveList = false;
+
     static ComponentTypeID getNextTypeID() {
         static ComponentTypeID lastID = 0;
         return lastID++;
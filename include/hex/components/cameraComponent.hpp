@@ -14,14 +14,16 @@ public:
 
     constexpr const std::string getPrettyName() const override { return "Camera"; }
 
-    void update() override;
-    void render(codex::Shader* overrideShader = nullptr) override;
+    void update(float deltaTime) override;
+    void render(const prism::View& view) override;
 
+    /**
+     * @return CameraInput* The input of the camera, call `wake` after changing it
+     */
     inline CameraInput* getCameraInput() { return &m_cameraInput; }
     inline Camera* getCamera() const { return m_camera.get(); }
 
     void resizeCamera(float width, float height);
-    void sendDebugCameraInput(float deltaTime);
 
     virtual void editorUI() override;
 protected:
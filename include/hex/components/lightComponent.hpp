@@ -0,0 +1,67 @@
+#pragma once
+
+#include "hex/component.hpp"
+#include "hex/components/transformComponent.hpp"
+#include "prism/tiledLighting.hpp"
+
+namespace hex {
+
+/**
+ * @brief A dynamic light, shaded by the tiled lighting pass.
+ * Point and spot lights are placed by the transform of the actor, spot and directional lights face its forward axis.
+ */
+class LightComponent : public Component {
+    ImplementComponentType(LightComponent)
+public:
+    LightComponent(Actor* actor, prism::LightType type = prism::LightType::POINT, vector4f color = vector4f::one(), float intensity = 1.0f, float range = 10.0f);
+    virtual ~LightComponent() = default;
+
+    constexpr const std::string getPrettyName() const override { return "Light"; }
+
+    void update(float deltaTime) override;
+    /**
+     * @brief Adds the light to the light list of the view, if it collects lights and the light is inside its frustum.
+     */
+    void render(const prism::View& view) override;
+    std::unique_ptr<Component> clone(Actor* actor) const override;
+
+    virtual bool resolveDependencies() override;
+    virtual void onParentChanged() override;
+    virtual void editorUI() override;
+
+    inline void setType(prism::LightType type) { m_type = type; }
+    inline prism::LightType getType() const { return m_type; }
+
+    inline void setColor(const vector4f& color) { m_color = color; }
+    inline const vector4f& getColor() const { return m_color; }
+
+    inline void setIntensity(float intensity) { m_intensity = intensity; }
+    inline float getIntensity() const { return m_intensity; }
+
+    /**
+     * @param range The distance the light reaches zero at, ignored by directional lights
+     */
+    inline void setRange(float range) { m_range = range; }
+    inline float getRange() const { return m_range; }
+
+    /**
+     * @param innerAngle The half angle of the fully lit cone in radians
+     * @param outerAngle The half angle the light fades out at in radians
+     */
+    inline void setSpotAngles(float innerAngle, float outerAngle) { m_innerAngle = innerAngle; m_outerAngle = outerAngle; }
+    inline float getInnerAngle() const { return m_innerAngle; }
+    inline float getOuterAngle() const { return m_outerAngle; }
+protected:
+    LightComponent(Actor* actor, const LightComponent& other);
+
+    hex::TransformComponent* m_transformComponent = nullptr;
+
+    prism::LightType m_type;
+    vector4f m_color;
+    float m_intensity;
+    float m_range;
+    float m_innerAngle = 0.35f;
+    float m_outerAngle = 0.5f;
+};
+
+}; // namespace hex
\ No newline at end of file
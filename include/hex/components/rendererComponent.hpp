@@ -7,19 +7,36 @@
 #include "hex/component.hpp"
 #include "hex/components/transformComponent.hpp"
 
+#include <vector>
+
 namespace hex {
 
+/**
+ * @brief A single detail level of a renderer.
+ * The level is used under the threshold screen size, or over the threshold distance.
+ */
+struct LODLevel {
+    codex::Mesh* mesh = nullptr;
+    float threshold = 0.0f;
+};
+
+enum class LODMode : uint8_t {
+    SCREEN_SIZE, // Thresholds are projected heights relative to the screen height
+    DISTANCE     // Thresholds are distances from the viewer
+};
+
 class RendererComponent : public Component {
     ImplementComponentType(RendererComponent)
 public:
     RendererComponent(Actor* actor);
     RendererComponent(Actor* actor, codex::Shader* shader, codex::Material* material, codex::Mesh* mesh);
-    virtual ~RendererComponent() = default;
+    virtual ~RendererComponent();
 
     constexpr const std::string getPrettyName() const override { return "Renderer"; }
 
-    void update() override;
-    void render(codex::Shader* overrideShader = nullptr) override;
+    void update(float deltaTime) override;
+    void render(const prism::View& view) override;
+    std::unique_ptr<Component> clone(Actor* actor) const override;
 
     virtual bool resolveDependencies() override;
     virtual void onParentChanged() override;
@@ -27,17 +44,91 @@ public:
 
     inline void setShader  (codex::Shader*   shader  ) { m_shader   = shader;   }
     inline void setMaterial(codex::Material* material) { m_material = material; }
-    inline void setMesh    (codex::Mesh*     mesh    ) { m_mesh     = mesh;     }
+    void setMesh(codex::Mesh* mesh);
 
     inline codex::Shader*   getShader()   const { return m_shader;   }
     inline codex::Material* getMaterial() const { return m_material; }
     inline codex::Mesh*     getMesh()     const { return m_mesh;     }
+
+    inline void setCastShadows(bool castShadows) { m_castShadows = castShadows; }
+    inline bool isCastingShadows() const { return m_castShadows; }
+
+    /**
+     * @brief Overrides the detail levels coming from the mesh.
+     * The first level is the full detail mesh, its threshold is ignored.
+     * 
+     * @param levels The detail levels, ordered from the most to the least detailed
+     */
+    void setLODLevels(const std::vector<LODLevel>& levels);
+    inline const std::vector<LODLevel>& getLODLevels() const { return *m_lodLevels; }
+    /**
+     * @return const std::vector<LODLevel>& The detail levels, rebuilt first if the mesh changed since the last render
+     */
+    const std::vector<LODLevel>& resolveLODLevels();
+
+    inline void setLODMode(LODMode mode) { m_lodMode = mode; }
+    inline LODMode getLODMode() const { return m_lodMode; }
+
+    /**
+     * @brief Enables dithered cross-fading between neighbouring levels.
+     * While fading both levels are drawn, with complementary dither patterns.
+     * 
+     * @param enabled If cross-fading is enabled
+     * @param range The size of the fading band relative to the threshold
+     */
+    inline void setLODCrossFade(bool enabled, float range = 0.15f) { m_lodCrossFade = enabled; m_lodFadeRange = range; }
+    inline bool isLODCrossFadeEnabled() const { return m_lodCrossFade; }
+    inline float getLODFadeRange() const { return m_lodFadeRange; }
+
+    /**
+     * @brief Selects the detail level for a view.
+     * 
+     * @param view The view being rendered
+     * @param worldBounds The world space bounds of the mesh
+     * @param fade Output, the amount of the next level showing through [0, 1)
+     * @return int The index of the selected level
+     */
+    int selectLOD(const prism::View& view, const boundsf& worldBounds, float* fade) const;
 protected:
+    RendererComponent(Actor* actor, const RendererComponent& other);
+
     hex::TransformComponent* m_transformComponent = nullptr;
 
     codex::Shader*   m_shader   = nullptr;
     codex::Material* m_material = nullptr;
     codex::Mesh*     m_mesh     = nullptr;
+    bool m_castShadows = true;
+
+    // The slot of the renderer in the object buffer of the scene, allocated on the first render
+    prism::ObjectBuffer* m_objectBuffer = nullptr;
+    uint32_t m_objectSlot = prism::ObjectBuffer::INVALID_SLOT;
+
+    // The model matrices of the last two rendered frames, for the motion vectors
+    matrix4x4f m_frameModelMatrix;
+    matrix4x4f m_previousModelMatrix;
+    uint64_t m_motionFrame = 0;
+
+    // Shared between the copies of a prefab, copied on write
+    std::shared_ptr<std::vector<LODLevel>> m_lodLevels = std::make_shared<std::vector<LODLevel>>();
+    LODMode m_lodMode = LODMode::SCREEN_SIZE;
+    bool  m_lodCrossFade  = false;
+    float m_lodFadeRange  = 0.15f;
+    bool  m_customLODs    = false;
+    bool  m_lodChainDirty = true;
+    int   m_lastLODLevel  = 0;
+
+    void rebuildLODChain();
+    /**
+     * @return std::vector<LODLevel>& The detail levels, detached from the other copies first if shared
+     */
+    std::vector<LODLevel>& editLODLevels();
+    void pushLevel(const prism::View& view, int level, const matrix4x4f& modelMatrix, const matrix4x4f& previousModelMatrix, const boundsf& bounds, float depth, float fade);
+    void updateObjectSlot(const prism::View& view, const matrix4x4f& modelMatrix, const matrix4x4f& previousModelMatrix);
+    /**
+     * @brief Remembers the matrix of the frame, once per frame.
+     * @return const matrix4x4f& The matrix of the last rendered frame, or the current one if it wasn't rendered
+     */
+    const matrix4x4f& updateMotion(const prism::View& view, const matrix4x4f& modelMatrix);
 };
 
-}; // namespace hex
\ No newline at end of file
+}; // namespace hex
@@ -13,14 +13,17 @@ public:
 
     constexpr const std::string getPrettyName() const override { return "Transform"; }
 
-    void update() override;
-    void render(codex::Shader* overrideShader = nullptr) override;
+    void update(float deltaTime) override;
+    void render(const prism::View& view) override;
+    std::unique_ptr<Component> clone(Actor* actor) const override;
 
     inline transformf& getTransform() { return m_transform; }
 
     virtual void onParentChanged() override;
     virtual void editorUI() override;
 protected:
+    TransformComponent(Actor* actor, const TransformComponent& other);
+
     inline transformf* getTransformPtr() { return &m_transform; }
 
     transformf m_transform;
@@ -2,10 +2,17 @@
 
 #include "codex/texture.hpp"
 
+#include <memory>
+
 namespace hex {
 
 class Framebuffer {
 public:
+    /**
+     * @param width The width of the attachments
+     * @param height The height of the attachments
+     * @param depthOnly Only a 16 bit depth texture is attached, without color, for shadow maps
+     */
     Framebuffer(int width, int height, bool depthOnly = false);
     ~Framebuffer();
 
@@ -14,30 +21,26 @@ public:
 
     void resize(int width, int height);
 
-    inline const codex::Texture& getColorTarget() const { return m_colorTarget; }
+    /**
+     * @return const codex::Texture& The color target, only valid if the framebuffer isn't depth only
+     */
+    inline const codex::Texture& getColorTarget() const { return *m_colorTarget; }
+    /**
+     * @return unsigned int The depth texture, only valid if the framebuffer is depth only
+     */
+    inline unsigned int getDepthTarget() const { return m_depthTexture; }
+    inline bool isDepthOnly() const { return m_depthOnly; }
 
     inline const unsigned int getHandle() const { return m_framebufferHandle; }
 protected:
     unsigned int m_framebufferHandle;
+    bool m_depthOnly;
 
-    codex::Texture m_colorTarget;
-    unsigned int m_depthStencilTarget;
-};
-
-class GBuffer : public Framebuffer {
-public:
-    GBuffer(int width, int height);
-    ~GBuffer();
-
-    void resize(int width, int height);
+    std::unique_ptr<codex::Texture> m_colorTarget = nullptr;
+    unsigned int m_depthStencilTarget = 0; // Renderbuffer, when there is a color target
+    unsigned int m_depthTexture = 0;       // When depth only
 
-    inline const codex::Texture& getNormalTarget() const { return m_normalTarget; }
-    inline const codex::Texture& getPositionTarget() const { return m_positionTarget; }
-    inline const codex::Texture& getAORoughnessMetallicTarget() const { return m_aoRoughnessMetallicTarget; }
-private:
-    codex::Texture m_normalTarget;
-    codex::Texture m_positionTarget;
-    codex::Texture m_aoRoughnessMetallicTarget;
+    void createDepthTexture(int width, int height);
 };
 
 }; // namespace hex
\ No newline at end of file
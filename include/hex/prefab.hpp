@@ -0,0 +1,50 @@
+#pragma once
+
+#include "hex/actor.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace hex {
+
+// Forward declaration
+class Scene;
+
+/**
+ * @brief An immutable template of an actor, its components and its children.
+ * Instances are copied from the template in bulk, sharing the read-only data of the components.
+ */
+class Prefab {
+public:
+    /**
+     * @brief Captures the actor and all of its children into a new template.
+     * Later changes to the source actor don't affect the prefab.
+     * 
+     * @param source The actor to capture
+     */
+    Prefab(const Actor* source);
+    ~Prefab() = default;
+
+    Prefab(const Prefab&) = delete;
+    Prefab& operator=(const Prefab&) = delete;
+
+    /**
+     * @brief Creates copies of the template in the scene.
+     * 
+     * @param scene The scene to create the copies in
+     * @param count The number of copies
+     * @param parent The parent of the copies (optional)
+     * @return std::vector<Actor*> The root actors of the copies
+     */
+    std::vector<Actor*> instantiate(Scene* scene, size_t count, Actor* parent = nullptr) const;
+
+    inline const Actor* getRoot() const { return m_prototypes.front().get(); }
+    inline size_t getActorCount() const { return m_prototypes.size(); }
+protected:
+    std::vector<std::unique_ptr<Actor>> m_prototypes; // Depth first order, the root first
+    std::vector<int> m_parentIndices;                 // -1 for the root
+
+    void capture(const Actor* source, int parentIndex);
+};
+
+}; // namespace hex
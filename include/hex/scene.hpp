@@ -1,27 +1,111 @@
 #pragma once
 
 #include "hex/actor.hpp"
+#include "hex/tickScheduler.hpp"
+#include "prism/objectBuffer.hpp"
+#include "prism/depthPrepass.hpp"
+
+#include <string>
 
 namespace hex {
 
+/**
+ * @brief Settings for merging the geometry of static actors.
+ */
+struct StaticBatchSettings {
+    static constexpr float    CELL_SIZE    = 32.0f;   // The size of the spatial clusters, batches never span multiple cells
+    static constexpr uint32_t MAX_VERTICES = 1 << 20; // Batches are split above this vertex count
+    static constexpr uint32_t MAX_WAIT_UPDATES = 600; // Meshes still not loaded after this many updates are left out
+};
+
 class Scene {
 public:
     Scene();
     ~Scene();
 
-    void update();
-    void render(codex::Shader* overrideShader = nullptr);
+    /**
+     * @brief Runs a simulation tick, updating the awake components group by group.
+     * 
+     * @param deltaTime The length of the tick in seconds
+     */
+    void update(float deltaTime);
+    inline const TickScheduler& getTickScheduler() const { return m_tickScheduler; }
+    inline const prism::ObjectBuffer& getObjectBuffer() const { return m_objectBuffer; }
+    /**
+     * @brief Gathers the draws of the scene into the queue of the view, then sorts and submits them.
+     * If the view has no queue, the scene's own queue is used.
+     * The view always uses the object buffer of the scene, uploaded after gathering.
+     * If the view collects lights, its light list is refilled too.
+     * 
+     * @param view The view to render the scene from
+     */
+    void render(const prism::View& view);
 
     Actor* newActor();
     void removeActor(Actor* actor);
+    inline const std::vector<std::unique_ptr<Actor>>& getActors() const { return m_actors; }
+    /**
+     * @brief Takes ownership of already created actors, in bulk.
+     * 
+     * @param actors The actors to add, emptied by the call
+     */
+    void addActors(std::vector<std::unique_ptr<Actor>>& actors);
+
+    /**
+     * @brief Merges the geometry of static actors sharing shader and material, once all their meshes are loaded.
+     * Meshes failing to load within a bounded wait are left out, and keep rendering on their own.
+     * Actors are grouped by spatial clusters, so the batches can still be culled.
+     * The renderers of the merged actors are disabled, and a new actor is created for each batch.
+     */
+    inline void requestStaticBatching() { m_staticBatchingPending = true; m_staticBatchingWait = 0; }
+
+    /**
+     * @brief Sets if the G-buffer of the scene is rendered after a depth pre-pass, see `prism::DepthPrepass`.
+     */
+    inline void setDepthPrepassMode(prism::DepthPrepassMode mode) { m_depthPrepassMode = mode; }
+    inline prism::DepthPrepassMode getDepthPrepassMode() const { return m_depthPrepassMode; }
 
     void editorUI();
 protected:
+    // Declared first, so they outlive the components registered in them
+    TickScheduler m_tickScheduler;
+    prism::ObjectBuffer m_objectBuffer;
+
     std::vector<std::unique_ptr<Actor>> m_actors;
 
     Actor* m_selectedActor = nullptr;
 
-    void drawActorTree(Actor* actor, int depth = 0);
+    /**
+     * @brief A single visible line of the hierarchy panel.
+     */
+    struct HierarchyRow {
+        Actor* actor;
+        int depth;
+        bool hasChildren;
+        std::string label;
+    };
+
+    // Flattened visible rows, rebuilt only when the hierarchy or the filter changes
+    std::vector<HierarchyRow> m_hierarchyRows;
+    uint64_t m_hierarchyRowsRevision = UINT64_MAX;
+
+    char m_hierarchyFilter[64] = {};
+    std::string m_lastHierarchyFilter;
+    std::vector<Actor*> m_filterMatches;
+
+    prism::RenderQueue m_renderQueue;
+    bool m_staticBatchingPending = false;
+    uint32_t m_staticBatchingWait = 0;  // Updates spent waiting for the meshes to load
+    prism::DepthPrepassMode m_depthPrepassMode = prism::DepthPrepassMode::AUTO;
+
+    /**
+     * @param skipUnloaded Leaves out the meshes that aren't loaded yet, instead of waiting for them
+     * @return true If the batching was done, false if some meshes are still loading
+     */
+    bool buildStaticBatches(bool skipUnloaded);
+
+    void rebuildHierarchyRows();
+    void drawHierarchyRow(const HierarchyRow& row);
 };
 
 }; // namespace hex
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "hex/component.hpp"
+#include "floatmath.hpp"
+
+namespace hex {
+
+// Forward declaration
+class Actor;
+
+struct TickGroupStats {
+    uint32_t registered = 0; // Components in the group, sleeping ones included
+    uint32_t active     = 0; // Components visited this tick
+    uint32_t ticked     = 0; // Components actually updated this tick
+    double   time       = 0.0; // Milliseconds spent in the group
+};
+
+/**
+ * @brief Runs the updates of the components, group by group.
+ * Only awake components are visited, so the cost scales with what is active, not with the actor count.
+ * The component lists are rebuilt only when components are added, removed, or change their group.
+ * The order of components within a group is not guaranteed.
+ */
+class TickScheduler {
+public:
+    TickScheduler() = default;
+    ~TickScheduler() = default;
+
+    /**
+     * @brief Runs a single simulation tick.
+     * 
+     * @param actors Every actor of the scene
+     * @param deltaTime The length of the tick in seconds
+     */
+    void update(const std::vector<std::unique_ptr<Actor>>& actors, float deltaTime);
+
+    /**
+     * @brief Puts a woken component back into its group, called by `Component::wake`.
+     */
+    inline void enqueueWake(Component* component) { m_wokenComponents.push_back(component); }
+
+    inline const TickGroupStats& getStats(TickGroup group) const { return m_stats[static_cast<size_t>(group)]; }
+    inline uint32_t getSleepingCount() const { return m_sleepingCount; }
+    inline uint64_t getTickCount() const { return m_tickCount; }
+
+    static const char* getGroupName(TickGroup group);
+protected:
+    static constexpr size_t GROUP_COUNT = static_cast<size_t>(TickGroup::NONE);
+
+    /**
+     * @brief A sleeping component waiting for its transform to change.
+     */
+    struct TransformWatch {
+        Component* component;
+        const transformf* transform;
+        uint32_t version;
+    };
+
+    std::array<std::vector<Component*>, GROUP_COUNT> m_groups;
+    std::array<TickGroupStats, GROUP_COUNT> m_stats;
+
+    std::vector<Component*> m_wokenComponents;
+    std::vector<TransformWatch> m_transformWatches;
+
+    uint64_t m_revision = UINT64_MAX;
+    uint64_t m_tickCount = 0;
+    uint32_t m_sleepingCount = 0;
+
+    void rebuild(const std::vector<std::unique_ptr<Actor>>& actors);
+    void putToSleep(Component* component);
+    void wakeWatched();
+};
+
+}; // namespace hex
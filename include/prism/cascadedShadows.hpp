@@ -0,0 +1,138 @@
+#pragma once
+
+#include "prism/shadowRenderer.hpp"
+
+#include "codex/shader.hpp"
+#include "hex/camera.hpp"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace hex {
+    // Forward declaration
+    class Scene;
+}
+
+namespace prism {
+
+/**
+ * @brief The cascades as read by the lighting shader, matching the std140 `ShadowCascades` block in GLSL.
+ */
+struct CascadeUniformData : codex::UniformBufferData {
+    matrix4x4f viewProjections[4];
+    vector4f depthBias;  // Per cascade, in depth units
+    vector4f params;     // The number of cascades in x
+};
+
+/**
+ * @brief A single slice of the view frustum, with its own shadow map.
+ */
+struct ShadowCascade {
+    std::unique_ptr<ShadowRenderer> renderer;
+    std::unique_ptr<hex::Camera> camera;
+
+    matrix4x4f viewProjection;     // What the shadow map was last rendered with, the lighting has to use the same
+    float depthBias = 0.0f;
+    float splitDistance = 0.0f;    // The far end of the slice, as view distance
+    float radius = 0.0f;           // The radius of the bounding sphere of the slice
+
+    uint32_t updateInterval = 1;   // The cascade is updated every Nth frame
+    uint32_t updateCount = 0;
+    bool rendered = false;
+};
+
+/**
+ * @brief Shadows of a directional light split into cascades along the view frustum.
+ * Every cascade covers the bounding sphere of its slice, so its size doesn't change as the view rotates,
+ * and its center is snapped to whole texels of the light space, so the shadow edges don't shimmer while moving.
+ * Far cascades cover more and change less on screen, so they are updated less often,
+ * their matrices are kept from their last update, so the lighting always matches their contents.
+ * Each cascade keeps the static and dynamic layers of a `ShadowRenderer`, and is skipped if nothing changed.
+ */
+class CascadedShadows {
+public:
+    static constexpr uint32_t MAX_CASCADES = 4;
+    static constexpr int UNIFORM_BINDING = 8;        // The binding of the cascade block in the shaders
+    static constexpr int FIRST_TEXTURE_UNIT = 16;    // The shadow maps are bound to consecutive units from here
+    static constexpr float CASTER_DISTANCE = 50.0f;  // How far towards the light casters are searched, beyond the slice
+
+    /**
+     * @param cascadeCount The number of cascades, at most `MAX_CASCADES`
+     * @param size The width and height of the shadow map of each cascade
+     * @param distance The view distance the shadows end at
+     */
+    CascadedShadows(uint32_t cascadeCount, int size, float distance);
+    ~CascadedShadows();
+
+    CascadedShadows(const CascadedShadows&) = delete;
+    CascadedShadows& operator=(const CascadedShadows&) = delete;
+
+    /**
+     * @brief Fits the cascades due this frame to the view, and updates their shadow maps.
+     * 
+     * @param scene The scene casting the shadows
+     * @param viewCamera The camera the cascades are fitted to
+     * @param lightRotation The rotation of the light, as a camera rotation
+     * @param shader The shadow casting shader
+     * @param lodBias The detail level bias of the shadow views
+     * @param interpolation The interpolation factor of the dynamic casters between simulation states
+     */
+    void render(hex::Scene& scene, hex::Camera* viewCamera, const vector4f& lightRotation, codex::Shader* shader, int lodBias = 0, float interpolation = 1.0f);
+
+    /**
+     * @brief Uploads and binds the cascade block for the lighting pass.
+     */
+    void bindUniforms();
+    /**
+     * @return uint32_t A sampler comparing against the shadow maps, with hardware filtered PCF
+     */
+    inline uint32_t getCompareSampler() const { return m_compareSampler; }
+
+    /**
+     * @brief Forces every cascade to be fully re-rendered on the next update.
+     */
+    void invalidate();
+
+    /**
+     * @param split Blends between uniform (0) and logarithmic (1) split distances
+     */
+    inline void setSplitBlend(float split) { m_splitBlend = split; }
+    inline float getSplitBlend() const { return m_splitBlend; }
+
+    inline void setDistance(float distance) { m_distance = distance; }
+    inline float getDistance() const { return m_distance; }
+
+    inline void setUpdateInterval(uint32_t cascade, uint32_t interval) { m_cascades[cascade].updateInterval = interval > 0 ? interval : 1; }
+
+    inline uint32_t getCascadeCount() const { return static_cast<uint32_t>(m_cascades.size()); }
+    inline const ShadowCascade& getCascade(uint32_t cascade) const { return m_cascades[cascade]; }
+    inline uint32_t getShadowMap(uint32_t cascade) const { return m_cascades[cascade].renderer->getShadowMap(); }
+    inline int getSize() const { return m_size; }
+protected:
+    int m_size;
+    float m_distance;
+    float m_splitBlend = 0.75f;
+    uint64_t m_frame = 0;
+
+    std::vector<ShadowCascade> m_cascades;
+    codex::UniformBuffer m_uniformBuffer;
+    unsigned int m_compareSampler = 0;
+
+    /**
+     * @brief Computes the far end of every slice.
+     */
+    void computeSplits(float nearDistance, float farDistance);
+    /**
+     * @brief Places the camera of a cascade around its slice of the view frustum.
+     * 
+     * @param cascade The cascade to fit
+     * @param corners The near and far corners of the view frustum in world space
+     * @param nearDistance The view distance of the near plane
+     * @param farDistance The view distance of the far plane
+     * @param lightRotation The rotation of the light
+     */
+    void fitCascade(uint32_t cascade, const std::array<vector4f, 8>& corners, float nearDistance, float farDistance, const vector4f& lightRotation);
+};
+
+}; // namespace prism
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "prism/gpuQuery.hpp"
+#include "prism/renderQueue.hpp"
+#include "prism/view.hpp"
+
+#include "codex/shader.hpp"
+
+#include <cstdint>
+
+namespace hex {
+    // Forward declaration
+    class Scene;
+}
+
+namespace prism {
+
+enum class DepthPrepassMode : uint8_t {
+    OFF,
+    ON,
+    AUTO,  // Enabled while the measured overdraw is high
+};
+
+/**
+ * @brief Measurements of the G-buffer stage, for comparing the two modes on a scene.
+ */
+struct DepthPrepassStats {
+    bool enabled = false;      // If the last frame used the pre-pass
+    float overdraw = 0.0f;     // Fragments passing the depth test of the first pass, per pixel
+    double withoutPrepassMs = 0.0;  // Rolling average of the stage without the pre-pass, 0 if never measured
+    double withPrepassMs = 0.0;     // Rolling average of the stage with the pre-pass (both passes)
+};
+
+/**
+ * @brief Renders the opaque view into the G-buffer, optionally after a depth-only pre-pass.
+ * The pre-pass lays down the depth with a position-only shader, then the G-buffer pass
+ * tests for equal depth without writing it, so the material shader runs once per pixel,
+ * instead of once for every overlapping fragment that passed the depth test at the time.
+ * It pays off for scenes with a lot of overdraw, and costs a second geometry pass otherwise,
+ * so in the automatic mode it is toggled by the overdraw measured with an occlusion query.
+ * Both modes are timed separately, so the difference can be checked on every scene.
+ */
+class DepthPrepass {
+public:
+    static constexpr float ENABLE_OVERDRAW  = 1.5f;   // The automatic mode turns the pre-pass on above this
+    static constexpr float DISABLE_OVERDRAW = 1.25f;  // And off below this, the gap keeps it from flickering
+
+    DepthPrepass();
+
+    DepthPrepass(const DepthPrepass&) = delete;
+    DepthPrepass& operator=(const DepthPrepass&) = delete;
+
+    /**
+     * @brief Renders the scene into the bound G-buffer, with the mode of the scene.
+     * The depth buffer has to be cleared, and the depth test enabled.
+     * 
+     * @param scene The scene to render
+     * @param view The opaque view of the camera
+     * @param depthShader The position-only shader of the pre-pass, the pre-pass is skipped while it isn't ready
+     * @param width The width of the G-buffer
+     * @param height The height of the G-buffer
+     */
+    void render(hex::Scene& scene, const View& view, codex::Shader* depthShader, int width, int height);
+
+    inline const DepthPrepassStats& getStats() const { return m_stats; }
+    inline const RenderQueueStats& getQueueStats() const { return m_queue.getStats(); }
+protected:
+    RenderQueue m_queue;           // The draws of the pre-pass, kept apart from the G-buffer draws
+
+    GPUQuery m_stageTimers[2];     // Without and with the pre-pass, only the timer of the active mode runs
+    GPUQuery m_samples;            // Samples passing the depth test of the first pass
+    uint32_t m_samplesSeen = 0;    // The result count of the sample query at the last update
+
+    bool m_autoEnabled = false;
+    DepthPrepassStats m_stats;
+
+    bool isEnabled(DepthPrepassMode mode) const;
+    void updateStats(int width, int height);
+};
+
+}; // namespace prism
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "prism/gpuQuery.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace prism {
+
+/**
+ * @brief Picks the internal resolution of the scene every frame, to keep the GPU time of the scene within a budget.
+ * Only the passes rendering at the scaled resolution are measured (the shadows, for example, don't follow the scale).
+ * The GPU time is measured with timestamps read back a few frames later, so the controller reacts to
+ * a rolling average, and leaves the results measured at the previous scale out after every change.
+ * The scale moves towards the one expected to hit the budget (the cost follows the pixel count),
+ * but only once the time leaves a band around the budget, so it doesn't change every frame.
+ * The targets stay allocated at the full size, and are only rendered into partially,
+ * so a change is free, unlike resizing the targets.
+ */
+class DynamicResolution {
+public:
+    static constexpr float MIN_SCALE = 0.5f;
+    static constexpr float MAX_SCALE = 1.0f;
+    static constexpr float MAX_STEP  = 0.1f;          // The largest change of the scale at once
+    static constexpr float SCALE_GRANULARITY = 1.0f / 32.0f;
+    static constexpr double SCALE_DOWN_LOAD = 1.0;    // The budget use the scale is lowered above
+    static constexpr double SCALE_UP_LOAD   = 0.8;    // And raised below
+    static constexpr double TARGET_LOAD     = 0.9;    // The budget use a change aims for
+    static constexpr double AVERAGE_WEIGHT  = 0.2;    // The weight of a new measurement in the controller's average
+
+    DynamicResolution();
+
+    DynamicResolution(const DynamicResolution&) = delete;
+    DynamicResolution& operator=(const DynamicResolution&) = delete;
+
+    /**
+     * @brief Updates the scale from the finished measurements, before the frame picks its resolution.
+     */
+    void beginFrame();
+    /**
+     * @brief Measures the GPU time of a pass rendering at the scaled resolution, until `endPass`.
+     * The passes are told apart by their order in the frame.
+     */
+    void beginPass();
+    void endPass();
+
+    /**
+     * @param width The full width of the output
+     * @return int The width to render the scene at
+     */
+    int scaleWidth(int width) const;
+    int scaleHeight(int height) const;
+
+    inline bool isEnabled() const { return m_enabled; }
+    /**
+     * @brief Disabling renders at the fixed scale (the full resolution by default).
+     */
+    void setEnabled(bool enabled);
+
+    inline float getScale() const { return m_enabled ? m_scale : m_fixedScale; }
+    inline float getFixedScale() const { return m_fixedScale; }
+    /**
+     * @brief Sets the scale rendered at while disabled, for example a lower one with temporal upsampling.
+     */
+    void setFixedScale(float scale);
+    inline float getBudget() const { return m_budgetMs; }
+    inline void setBudget(float milliseconds) { m_budgetMs = milliseconds; }
+    /**
+     * @return double The averaged GPU time of the measured passes of a frame in milliseconds
+     */
+    inline double getFrameTime() const { return m_frameTimeMs; }
+    inline uint32_t getChangeCount() const { return m_changeCount; }
+protected:
+    std::vector<std::unique_ptr<GPUQuery>> m_passTimers;
+    uint32_t m_passIndex = 0;  // The next pass of the frame
+    uint32_t m_passCount = 0;  // The passes measured in the last frame
+    uint32_t m_resultsSeen = 0;
+    uint32_t m_resultsToSkip = 0;  // Measurements still in flight when the scale changed
+
+    bool m_enabled = true;
+    float m_scale = MAX_SCALE;
+    float m_fixedScale = MAX_SCALE;
+    float m_budgetMs = 1000.0f / 60.0f;
+    double m_frameTimeMs = 0.0;
+    uint32_t m_changeCount = 0;
+
+    void update();
+    /**
+     * @return uint32_t The measurements finished by every pass timer
+     */
+    uint32_t getResultCount() const;
+};
+
+}; // namespace prism
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace prism {
+
+/**
+ * @brief The timings of a profiled scope over the kept history, in milliseconds.
+ */
+struct ProfilerScopeStats {
+    std::string name;
+    uint32_t samples = 0;     // Frames of the history the scope ran in
+    float gpuLast    = 0.0f;  // Of the latest finished frame, 0 if it didn't run
+    float gpuAverage = 0.0f;
+    float gpuP95     = 0.0f;
+    float gpuP99     = 0.0f;
+    float cpuAverage = 0.0f;  // The time spent issuing the commands of the scope
+    float cpuP95     = 0.0f;
+    float cpuP99     = 0.0f;
+};
+
+/**
+ * @brief Measures the GPU time of named scopes (like the passes of the render graph) with timestamp queries.
+ * Every frame records into the next slot of a ring of frames, and a frame is read back once the
+ * driver reports its last timestamp as available, so reading never stalls. If the ring is full
+ * of unfinished frames, the frame is skipped instead of waiting.
+ * Finished frames are kept in a history, with the CPU time of the same scopes and of the whole frame,
+ * for the rolling statistics and for exporting.
+ * Scopes can nest, the first scope of every frame is the frame itself.
+ */
+class GPUProfiler {
+public:
+    static constexpr uint32_t RING_SIZE = 4;        // Frames in flight
+    static constexpr uint32_t HISTORY_SIZE = 300;   // Finished frames kept for the statistics
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    /**
+     * @brief Measures the commands issued during its lifetime, does nothing without a profiler.
+     */
+    class Scope {
+    public:
+        Scope(GPUProfiler* profiler, const std::string& name);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    protected:
+        GPUProfiler* m_profiler;
+        uint32_t m_marker;
+    };
+
+    GPUProfiler() = default;
+    ~GPUProfiler();
+
+    GPUProfiler(const GPUProfiler&) = delete;
+    GPUProfiler& operator=(const GPUProfiler&) = delete;
+
+    /**
+     * @brief Collects the finished frames, and starts recording the next one.
+     *
+     * @param cpuFrameTime The CPU time of the frame (the delta time) in milliseconds, exported with the GPU times
+     */
+    void beginFrame(double cpuFrameTime);
+    void endFrame();
+
+    /**
+     * @param name The name of the scope, the same name is merged into the same statistics
+     * @return uint32_t The marker to end the scope with, `NONE` if the frame isn't recorded
+     */
+    uint32_t begin(const std::string& name);
+    void end(uint32_t marker);
+
+    inline bool isEnabled() const { return m_enabled; }
+    void setEnabled(bool enabled);
+
+    /**
+     * @return const std::vector<ProfilerScopeStats>& Every scope seen so far, the frame first
+     */
+    inline const std::vector<ProfilerScopeStats>& getStats() const { return m_stats; }
+    /**
+     * @return std::vector<float> The GPU time of the kept frames in milliseconds, oldest first
+     */
+    std::vector<float> getFrameHistory() const;
+    inline uint64_t getFinishedFrameCount() const { return m_finishedFrames; }
+    inline uint32_t getSkipCount() const { return m_skipCount; }
+
+    /**
+     * @brief Writes the kept frames as CSV, a row per frame with the GPU and CPU time of every scope.
+     *
+     * @param path The file to write
+     * @return bool If the file was written
+     */
+    bool exportCSV(const std::string& path) const;
+protected:
+    using Clock = std::chrono::steady_clock;
+
+    struct Marker {
+        uint32_t scope;
+        Clock::time_point cpuBegin;
+        float cpuTime = -1.0f;  // In milliseconds, negative until the scope ends
+    };
+
+    struct PendingFrame {
+        uint64_t number = 0;
+        double cpuFrameTime = 0.0;
+        std::vector<uint32_t> queries;  // A begin and end timestamp per marker, grown as needed
+        std::vector<Marker> markers;
+        bool pending = false;
+    };
+
+    struct FrameRecord {
+        uint64_t number = 0;
+        double cpuFrameTime = 0.0;
+        std::vector<float> gpuTimes;  // By scope, negative if the scope didn't run
+        std::vector<float> cpuTimes;
+    };
+
+    bool m_enabled = true;
+    bool m_recording = false;
+    uint64_t m_frameNumber = 0;
+
+    std::vector<std::string> m_scopeNames;
+    std::unordered_map<std::string, uint32_t> m_scopeIndices;
+
+    std::array<PendingFrame, RING_SIZE> m_frames;
+    uint32_t m_current = 0;  // The slot recorded into, the oldest pending one
+
+    std::vector<FrameRecord> m_history;  // A ring once full
+    uint32_t m_historyNext = 0;
+    uint64_t m_finishedFrames = 0;
+    uint32_t m_skipCount = 0;
+
+    std::vector<ProfilerScopeStats> m_stats;
+
+    uint32_t findScope(const std::string& name);
+    /**
+     * @return bool If any frame finished
+     */
+    bool collect();
+    void resolve(PendingFrame& frame);
+    void updateStats();
+    void release();
+
+    /**
+     * @return const FrameRecord& The kept frame, 0 being the oldest
+     */
+    const FrameRecord& getRecord(uint32_t index) const;
+};
+
+}; // namespace prism
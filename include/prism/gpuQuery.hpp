@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace prism {
+
+/**
+ * @brief A GPU query read back a few frames later, so getting the result never stalls.
+ * Every measurement uses the next query object of a ring, and finished ones are collected
+ * once the driver reports them as available. If the ring is full of unfinished queries,
+ * the measurement is skipped instead of waiting.
+ * Only one query of a target can be active at a time, queries of different targets can overlap.
+ * Timestamp queries measure the time between two points instead, so they can also overlap each other.
+ */
+class GPUQuery {
+public:
+    static constexpr uint32_t RING_SIZE = 4;          // Measurements in flight
+    static constexpr double AVERAGE_WEIGHT = 0.05;    // The weight of a new result in the rolling average
+
+    /**
+     * @param target `GL_TIME_ELAPSED` or `GL_TIMESTAMP` (both in nanoseconds), or `GL_SAMPLES_PASSED`
+     */
+    explicit GPUQuery(uint32_t target);
+    ~GPUQuery();
+
+    GPUQuery(const GPUQuery&) = delete;
+    GPUQuery& operator=(const GPUQuery&) = delete;
+
+    /**
+     * @brief Starts measuring the commands issued until `end`. Collects the finished results first.
+     */
+    void begin();
+    void end();
+
+    inline bool hasResult() const { return m_resultCount > 0; }
+    /**
+     * @return uint64_t The latest finished result, a few frames old
+     */
+    inline uint64_t getResult() const { return m_result; }
+    inline double getAverage() const { return m_average; }
+    inline uint32_t getResultCount() const { return m_resultCount; }
+    inline uint32_t getSkipCount() const { return m_skipCount; }
+protected:
+    uint32_t m_target;
+
+    std::array<uint32_t, RING_SIZE * 2> m_queries = {}; // Timestamps use a pair per slot, the others only the first half
+    std::array<bool, RING_SIZE> m_pending = {};
+    uint32_t m_next = 0;     // The slot of the next measurement, the oldest pending one
+    bool m_active = false;
+
+    uint64_t m_result = 0;
+    double m_average = 0.0;
+    uint32_t m_resultCount = 0;
+    uint32_t m_skipCount = 0;
+
+    bool isTimestamp() const;
+    void collect();
+};
+
+}; // namespace prism
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "floatmath.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace prism {
+
+/**
+ * @brief The per-object data read by the shaders, matching the std430 layout of `ObjectData` in GLSL.
+ */
+struct alignas(16) ObjectData {
+    matrix4x4f modelMatrix;
+    matrix4x4f previousModelMatrix;  // Of the last rendered frame, for the motion vectors
+    uint32_t materialIndex = 0;
+    uint32_t padding[3] = {};
+};
+
+/**
+ * @brief A persistent GPU table of per-object data, indexed by slots owned by the renderers.
+ * Only the slots changed since the last upload are sent, merged into contiguous ranges.
+ */
+class ObjectBuffer {
+public:
+    static constexpr int BINDING = 2;                    // The binding of the object table in the shaders
+    static constexpr uint32_t INVALID_SLOT = UINT32_MAX;
+
+    ObjectBuffer() = default;
+    ~ObjectBuffer();
+
+    ObjectBuffer(const ObjectBuffer&) = delete;
+    ObjectBuffer& operator=(const ObjectBuffer&) = delete;
+
+    uint32_t allocate();
+    void release(uint32_t slot);
+
+    /**
+     * @brief Writes the data of a slot, marking it dirty only if it actually changed.
+     */
+    void update(uint32_t slot, const matrix4x4f& modelMatrix, const matrix4x4f& previousModelMatrix, uint32_t materialIndex);
+
+    /**
+     * @brief Sends the dirty ranges to the GPU, and binds the table.
+     */
+    void upload();
+
+    inline uint32_t getSlotCount() const { return static_cast<uint32_t>(m_objects.size()); }
+    inline uint32_t getLastUploadedCount() const { return m_lastUploadedCount; }
+    inline uint32_t getLastUploadRanges() const { return m_lastUploadRanges; }
+protected:
+    static constexpr uint32_t MERGE_GAP = 16; // Clean slots between dirty ones uploaded anyway, for fewer calls
+
+    std::vector<ObjectData> m_objects;
+    std::vector<uint32_t> m_freeSlots;
+
+    std::vector<uint32_t> m_dirtySlots;
+    std::vector<bool> m_dirtyFlags;
+
+    unsigned int m_bufferHandle = 0;
+    size_t m_bufferCapacity = 0; // In objects
+
+    uint32_t m_lastUploadedCount = 0;
+    uint32_t m_lastUploadRanges = 0;
+
+    void markDirty(uint32_t slot);
+};
+
+}; // namespace prism
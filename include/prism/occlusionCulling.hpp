@@ -0,0 +1,123 @@
+#pragma once
+
+#include "floatmath.hpp"
+#include "codex/shader.hpp"
+#include "codex/streamBuffer.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace prism {
+
+/**
+ * @brief The bounds of an instance as read by the culling shader, matching the std430 layout of `CullData` in GLSL.
+ */
+struct alignas(16) CullData {
+    float boundsMin[3];      // World space, an empty box (min over max) is never culled
+    uint32_t firstInstance;  // The base instance of the commands the instance belongs to
+    float boundsMax[3];
+    uint32_t padding = 0;
+};
+
+struct OcclusionCullingStats {
+    uint32_t pyramidWidth  = 0;    // The size of the first level built last, following the rendered area
+    uint32_t pyramidHeight = 0;
+    uint32_t pyramidLevels = 0;
+    uint32_t testedInstances = 0;  // Instances sent to the culling shader by the last view
+};
+
+/**
+ * @brief Culls the instanced indirect draws against the depth of the previous frame, on the GPU.
+ * Once a frame is rendered, its depth is reduced into a pyramid of minimum and maximum depths,
+ * where every texel covers a 2x2 block of the level below.
+ * The next frame projects the bounds of each instance with the matrix of the pyramid, and
+ * reads the level where the box covers at most 2x2 texels. If the box is behind the farthest
+ * depth of those texels, it is hidden. The visible instances are compacted to the front of
+ * their commands, and the instance counts of the commands are rewritten in place,
+ * so the hidden ones never reach the vertex shader, without reading anything back.
+ * Only the commands of indirect batches are culled, draws submitted one by one always pass.
+ * A newly revealed object may show up a frame late, as the pyramid lags behind the view.
+ */
+class OcclusionCulling {
+public:
+    static constexpr uint32_t GROUP_SIZE = 64;         // Matches the work group size of the culling shader
+    static constexpr uint32_t PYRAMID_GROUP_SIZE = 8;  // Matches the work group size of the pyramid shader
+    static constexpr int CULL_DATA_BINDING = 6;        // The bindings of the culling shader
+    static constexpr int VISIBLE_DRAW_BINDING = 7;
+    static constexpr int COUNTER_BINDING = 8;
+    static constexpr int COMMAND_BINDING = 9;
+
+    OcclusionCulling() = default;
+    ~OcclusionCulling();
+
+    OcclusionCulling(const OcclusionCulling&) = delete;
+    OcclusionCulling& operator=(const OcclusionCulling&) = delete;
+
+    /**
+     * @param pyramidShader The compute shader reducing the depth into the pyramid
+     * @param cullingShader The compute shader testing the instances
+     */
+    inline void setShaders(codex::Shader* pyramidShader, codex::Shader* cullingShader) { m_pyramidShader = pyramidShader; m_cullingShader = cullingShader; }
+
+    inline bool isEnabled() const { return m_enabled; }
+    /**
+     * @brief Disabling forgets the pyramid, so nothing is culled by a stale one once enabled again.
+     */
+    void setEnabled(bool enabled);
+    /**
+     * @return bool If the draws of this frame can be culled
+     */
+    bool isReady() const;
+
+    /**
+     * @brief Resizes the pyramid for the largest depth buffer rendered at, only reallocating if its size changed.
+     */
+    void resize(int width, int height);
+
+    /**
+     * @brief Builds the pyramid the next frame is culled with.
+     * 
+     * @param depthTexture The depth buffer of the rendered frame
+     * @param width The width of the rendered area of the depth buffer, at most the size given to `resize`
+     * @param height The height of the rendered area
+     * @param viewProjection The view projection matrix the depth was rendered with
+     */
+    void buildPyramid(uint32_t depthTexture, int width, int height, const matrix4x4f& viewProjection);
+    /**
+     * @brief Forgets the pyramid, for example when the view jumps, and the last frame says nothing about the next one.
+     */
+    inline void invalidate() { m_pyramidValid = false; }
+
+    /**
+     * @brief Culls the instances of already uploaded indirect commands.
+     * The instance counts of the commands are overwritten on the GPU.
+     * 
+     * @param draws The draw data of the instances, bound to the draw binding
+     * @param cullData The bounds of every instance, in the order of the draw data
+     * @param commands The indirect commands
+     * @param commandCount The number of commands
+     * @return codex::StreamAllocation The draw data of the visible instances, to bind instead,
+     *         invalid if the stream buffer is full, in which case the commands are left untouched
+     */
+    codex::StreamAllocation cull(const codex::StreamAllocation& draws, const std::vector<CullData>& cullData, const codex::StreamAllocation& commands, uint32_t commandCount);
+
+    inline uint32_t getPyramidTexture() const { return m_pyramidTexture; }
+    inline const OcclusionCullingStats& getStats() const { return m_stats; }
+protected:
+    codex::Shader* m_pyramidShader = nullptr;
+    codex::Shader* m_cullingShader = nullptr;
+    bool m_enabled = true;
+
+    unsigned int m_pyramidTexture = 0;  // RG32F, minimum and maximum depth, half the size of the depth at level 0
+    uint32_t m_pyramidWidth  = 0;       // The allocated size of the first level
+    uint32_t m_pyramidHeight = 0;
+    int m_depthWidth = 0;               // The rendered area of the depth the pyramid was built from
+    int m_depthHeight = 0;
+    uint32_t m_levels = 0;              // The levels of the rendered area
+    bool m_pyramidValid = false;
+    matrix4x4f m_viewProjection;
+
+    OcclusionCullingStats m_stats;
+};
+
+}; // namespace prism
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace prism {
+
+/**
+ * @brief The description of a 2D texture in the graph, transient textures with equal descriptions can share memory.
+ */
+struct TextureDesc {
+    int width  = 0;
+    int height = 0;
+    uint32_t format = 0; // The OpenGL internal format, depth formats become depth attachments
+
+    inline bool operator==(const TextureDesc& other) const = default;
+};
+
+class RenderGraph;
+class GPUProfiler;
+
+/**
+ * @brief Gives the passes access to the physical resources while they execute.
+ */
+class RenderGraphContext {
+public:
+    /**
+     * @param name The name of a resource the pass declared
+     * @return uint32_t The OpenGL texture handle of the resource
+     */
+    uint32_t getTexture(const std::string& name) const;
+    /**
+     * @return uint32_t The framebuffer of the attachments of the pass (already bound), or 0 if it has none
+     */
+    inline uint32_t getFramebuffer() const { return m_framebuffer; }
+protected:
+    friend class RenderGraph;
+
+    const RenderGraph* m_graph = nullptr;
+    uint32_t m_framebuffer = 0;
+
+    RenderGraphContext(const RenderGraph* graph, uint32_t framebuffer) : m_graph(graph), m_framebuffer(framebuffer) {}
+};
+
+/**
+ * @brief Counters of the last executed frame.
+ */
+struct RenderGraphStats {
+    uint32_t passes         = 0; // Declared passes
+    uint32_t culledPasses   = 0; // Passes skipped, because nothing used their results
+    uint32_t transients     = 0; // Transient textures used by the executed passes
+    uint32_t physicalTextures = 0;    // Textures the transients were placed in
+    uint64_t transientBytes = 0;     // The memory the transients would take without aliasing
+    uint64_t physicalBytes  = 0;     // The memory they actually take
+};
+
+/**
+ * @brief A frame described as passes reading and writing named resources, rebuilt every frame.
+ * Passes are ordered by their dependencies, and the ones not contributing to the output
+ * (or a pass marked as having side effects) are culled.
+ * Transient textures only live between their first and last use, and textures with the same
+ * description are reused once their previous occupant is done, so their memory is shared.
+ * Physical textures are kept between frames, and destroyed once a frame goes by without using them.
+ */
+class RenderGraph {
+public:
+    using ExecuteFunction = std::function<void(const RenderGraphContext&)>;
+
+    /**
+     * @brief Declares the resources a pass uses, returned by `addPass`.
+     */
+    class PassBuilder {
+    public:
+        /**
+         * @brief The pass samples the resource.
+         */
+        PassBuilder& read(const std::string& name);
+        /**
+         * @brief The pass writes the resource by its own means, without a graph framebuffer.
+         */
+        PassBuilder& write(const std::string& name);
+        /**
+         * @brief The pass renders into the resource, attached to the framebuffer bound before it executes.
+         * Color attachments are numbered in the order they are declared.
+         */
+        PassBuilder& attach(const std::string& name);
+        /**
+         * @brief The pass is never culled, for passes with effects outside the graph.
+         */
+        PassBuilder& sideEffect();
+        /**
+         * @brief Renders into the bottom left corner of the attachments, instead of the whole textures.
+         * For rendering at a lower resolution, without reallocating the targets.
+         */
+        PassBuilder& viewport(int width, int height);
+    protected:
+        friend class RenderGraph;
+
+        RenderGraph* m_graph;
+        uint32_t m_pass;
+
+        PassBuilder(RenderGraph* graph, uint32_t pass) : m_graph(graph), m_pass(pass) {}
+    };
+
+    RenderGraph() = default;
+    ~RenderGraph();
+
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+
+    /**
+     * @brief Forgets the passes and resources of the last frame, keeping the physical textures.
+     */
+    void reset();
+
+    /**
+     * @brief Declares a texture owned by the graph, placed into memory only while it is used.
+     */
+    void createTexture(const std::string& name, const TextureDesc& desc);
+    /**
+     * @brief Declares a texture owned outside the graph, like a shadow map cached between frames.
+     */
+    void importTexture(const std::string& name, uint32_t texture, const TextureDesc& desc);
+
+    /**
+     * @param name The name of the pass, for debugging
+     * @param execute Called with the resources of the pass, if the pass isn't culled
+     * @return PassBuilder The builder declaring the resources of the pass
+     */
+    PassBuilder addPass(const std::string& name, ExecuteFunction execute);
+
+    /**
+     * @brief Sets the resource the frame is for, it stays valid until the next `execute`.
+     */
+    void setOutput(const std::string& name);
+
+    /**
+     * @brief Culls, orders, allocates and runs the passes.
+     */
+    void execute();
+
+    /**
+     * @brief Measures every executed pass in a scope named after it, if set.
+     */
+    inline void setProfiler(GPUProfiler* profiler) { m_profiler = profiler; }
+
+    /**
+     * @return uint32_t The texture handle of a resource of the last executed frame, 0 if it wasn't allocated
+     */
+    uint32_t getTexture(const std::string& name) const;
+
+    inline const RenderGraphStats& getStats() const { return m_stats; }
+    /**
+     * @return const std::vector<std::string>& The names of the executed passes, in execution order
+     */
+    inline const std::vector<std::string>& getExecutedPasses() const { return m_executedPasses; }
+protected:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Resource {
+        std::string name;
+        TextureDesc desc;
+        bool imported = false;
+        uint32_t texture = 0;  // The physical texture, while allocated
+
+        std::vector<uint32_t> writers; // In declaration order
+        std::vector<uint32_t> readers;
+        uint32_t firstUse = NONE;      // Execution order index
+        uint32_t lastUse  = NONE;
+    };
+
+    struct Pass {
+        std::string name;
+        ExecuteFunction execute;
+
+        std::vector<uint32_t> reads;
+        std::vector<uint32_t> writes;
+        std::vector<uint32_t> attachments;
+        bool sideEffect = false;
+        bool culled = false;
+        int viewportWidth  = 0;  // The size of the attachments if 0
+        int viewportHeight = 0;
+    };
+
+    struct PhysicalTexture {
+        TextureDesc desc;
+        uint32_t handle;
+        bool inUse = false;
+        bool usedThisFrame = false;
+    };
+
+    std::vector<Resource> m_resources;
+    std::unordered_map<std::string, uint32_t> m_resourceIndices;
+    std::vector<Pass> m_passes;
+    uint32_t m_output = NONE;
+
+    std::vector<PhysicalTexture> m_textures;
+    std::map<std::vector<uint32_t>, uint32_t> m_framebuffers; // By attached textures
+
+    std::vector<std::string> m_executedPasses;
+    RenderGraphStats m_stats;
+    GPUProfiler* m_profiler = nullptr;
+
+    uint32_t findResource(const std::string& name) const;
+    uint32_t declareResource(const std::string& name, const TextureDesc& desc);
+
+    void cull();
+    /**
+     * @return std::vector<uint32_t> The live passes in dependency order
+     */
+    std::vector<uint32_t> sortPasses() const;
+
+    uint32_t acquireTexture(const TextureDesc& desc);
+    void releaseTexture(uint32_t handle);
+    void destroyUnusedTextures();
+    uint32_t getFramebuffer(const std::vector<uint32_t>& attachments);
+
+    static uint64_t textureSize(const TextureDesc& desc);
+    static bool isDepthFormat(uint32_t format);
+};
+
+}; // namespace prism
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "floatmath.hpp"
+
+#include "codex/shader.hpp"
+#include "codex/material.hpp"
+#include "codex/mesh.hpp"
+#include "prism/occlusionCulling.hpp"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace prism {
+
+// Forward declaration
+struct View;
+
+/**
+ * @brief The passes a draw can belong to, the most significant part of the sort key.
+ */
+enum RenderPass : uint8_t {
+    PASS_OPAQUE = 0,
+    PASS_SHADOW = 1,
+};
+
+/**
+ * @brief A single draw, emitted by the renderer components into the queue of a view.
+ * Holds everything needed for submitting it later, in any order.
+ */
+struct DrawPacket {
+    matrix4x4f modelMatrix;
+    matrix4x4f previousModelMatrix;    // Of the last rendered frame, for the motion vectors
+    codex::Shader*   shader   = nullptr;
+    codex::Material* material = nullptr;
+    codex::Mesh*     mesh     = nullptr;
+    float lodFade = 0.0f;
+    uint32_t objectIndex = UINT32_MAX; // The slot of the object in the object buffer of the view, if it has one
+    boundsf bounds;                    // World space, for occlusion culling, never culled if empty
+};
+
+/**
+ * @brief The per-draw data read by the shaders, matching the std430 layout of `DrawData` in GLSL.
+ */
+struct DrawData {
+    uint32_t objectIndex;
+    float lodFade;
+};
+
+/**
+ * @brief The layout `glMultiDrawElementsIndirect` reads the commands in.
+ */
+struct DrawElementsIndirectCommand {
+    uint32_t count;
+    uint32_t instanceCount;
+    uint32_t firstIndex;
+    int32_t  baseVertex;
+    uint32_t baseInstance;
+};
+
+/**
+ * @brief Counters of the last submission.
+ */
+struct RenderQueueStats {
+    uint32_t packets         = 0;
+    uint32_t shaderChanges   = 0;
+    uint32_t materialChanges = 0;
+    uint32_t meshChanges     = 0;
+    uint32_t drawCalls       = 0;
+    uint32_t multiDraws      = 0; // Draw calls submitting a list of indirect commands
+    uint32_t indirectCommands = 0;
+};
+
+/**
+ * @brief Per view queue of draws.
+ * Draws are sorted by a 64 bit key, so objects sharing state end up next to each other,
+ * then submitted with state changes only where the key changes.
+ * If the view has an object buffer, and the shader has an instanced variant, runs of draws sharing
+ * the shader are turned into indirect commands (one per part, instanced over consecutive
+ * draws of the same mesh), submitted with a single multi-draw per vertex array.
+ * The per-object data comes from the object buffer, the per-draw data from the stream buffer,
+ * and the textures from the material table. Materials not in the table are drawn one by one.
+ * If the view has occlusion culling, the instances of the indirect commands are culled on the GPU before drawing.
+ *
+ * Key layout (most to least significant):
+ * | pass (4) | shader (12) | material (12) | mesh (16) | depth (20) |
+ */
+class RenderQueue {
+public:
+    static constexpr int DRAW_BUFFER_BINDING = 1; // The binding of the per-draw data in the shaders
+
+    RenderQueue() = default;
+    ~RenderQueue() = default;
+
+    /**
+     * @brief Empties the queue, keeping the allocations.
+     */
+    void clear();
+
+    /**
+     * @brief Adds a draw to the queue.
+     * 
+     * @param packet The draw
+     * @param pass The pass of the draw
+     * @param depth The distance of the draw from the viewer
+     */
+    void push(const DrawPacket& packet, RenderPass pass, float depth);
+
+    /**
+     * @brief Sorts the draws by their keys. (LSD radix sort)
+     */
+    void sort();
+
+    /**
+     * @brief Issues the draws in sorted order.
+     * 
+     * @param view The view the queue belongs to
+     */
+    void submit(const View& view);
+
+    static uint64_t makeKey(RenderPass pass, const DrawPacket& packet, float depth);
+
+    inline size_t size() const { return m_packets.size(); }
+    inline const RenderQueueStats& getStats() const { return m_stats; }
+
+    inline bool isInstancingEnabled() const { return m_instancing; }
+    inline void setInstancingEnabled(bool enabled) { m_instancing = enabled; }
+protected:
+    /**
+     * @brief A run of sorted packets submitted together.
+     */
+    struct Batch {
+        uint32_t first;      // The index of the first packet in the sorted order
+        uint32_t count;      // The number of packets
+        bool indirect;       // If the packets are drawn by the command groups, instead of one by one
+        uint32_t firstGroup; // The first command group of the batch
+        uint32_t groupCount;
+    };
+
+    /**
+     * @brief Commands sharing a vertex array, submitted with a single multi-draw.
+     */
+    struct CommandGroup {
+        uint32_t vertexArray;
+        uint32_t firstCommand;
+        uint32_t commandCount;
+    };
+
+    std::vector<DrawPacket> m_packets;
+    std::vector<uint64_t> m_keys;
+
+    // Sorted order of the packets, and scratch space for the sort
+    std::vector<uint32_t> m_order;
+    std::vector<uint32_t> m_scratch;
+
+    std::vector<Batch> m_batches;
+    std::vector<CommandGroup> m_groups;
+    std::vector<DrawData> m_drawData;
+    std::vector<DrawElementsIndirectCommand> m_commands;
+    std::vector<CullData> m_cullData; // In the order of the draw data, only filled for occlusion culled views
+    intptr_t m_commandsOffset = 0; // The offset of the commands in the bound indirect buffer
+    bool m_instancing = true;
+
+    // Scratch space for building the commands of a batch
+    std::vector<codex::DrawRange> m_ranges;
+    std::vector<std::pair<uint32_t, DrawElementsIndirectCommand>> m_batchCommands;
+
+    RenderQueueStats m_stats;
+
+    static bool canBatch(const DrawPacket& first, const DrawPacket& other);
+    static bool isTableResident(const DrawPacket& packet);
+    void buildBatches(const View& view);
+    void buildCommands(Batch& batch, bool occlusionCulling);
+    /**
+     * @param view The view, culling the commands if it has occlusion culling
+     * @return true If the draw data and the commands are on the GPU, false if the stream buffer is full
+     */
+    bool uploadCommands(const View& view);
+};
+
+}; // namespace prism
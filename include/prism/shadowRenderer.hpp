@@ -0,0 +1,80 @@
+#pragma once
+
+#include "prism/renderQueue.hpp"
+#include "prism/view.hpp"
+
+#include "hex/framebuffer.hpp"
+#include "hex/camera.hpp"
+
+#include <memory>
+
+namespace hex {
+    // Forward declaration
+    class Scene;
+}
+
+namespace prism {
+
+/**
+ * @brief Renders the depth-only shadow map of a light in two layers.
+ * The static layer holds the static casters, and is only re-rendered when they (or the light) change.
+ * Every update it is copied into the shadow map, and the dynamic casters are drawn over it,
+ * so the cost of the shadows depends on what actually moves.
+ */
+class ShadowRenderer {
+public:
+    /**
+     * @param size The width and height of the shadow map
+     */
+    ShadowRenderer(int size);
+    ~ShadowRenderer() = default;
+
+    /**
+     * @brief Updates the shadow map, skipped entirely if nothing changed.
+     * 
+     * @param scene The scene casting the shadows
+     * @param lightCamera The camera of the light
+     * @param shader The shadow casting shader
+     * @param lodBias The detail level bias of the shadow views
+     * @param interpolation The interpolation factor of the dynamic casters between simulation states
+     */
+    void render(hex::Scene& scene, hex::Camera* lightCamera, codex::Shader* shader, int lodBias = 0, float interpolation = 1.0f);
+
+    /**
+     * @brief Forces the static layer to be re-rendered on the next update.
+     */
+    inline void invalidate() { m_staticDirty = true; }
+
+    /**
+     * @return uint32_t The 16 bit depth texture of the shadow map, to be sampled with a comparison sampler
+     */
+    inline uint32_t getShadowMap() const { return m_shadowMap->getDepthTarget(); }
+    inline int getSize() const { return m_size; }
+
+    inline uint32_t getStaticCasterCount()  const { return m_staticCasterCount;  }
+    inline uint32_t getDynamicCasterCount() const { return m_dynamicCasterCount; }
+    inline uint32_t getStaticRenderCount()  const { return m_staticRenderCount;  }
+    inline const RenderQueue& getDynamicQueue() const { return m_dynamicQueue; }
+protected:
+    int m_size;
+
+    std::unique_ptr<hex::Framebuffer> m_staticLayer;
+    std::unique_ptr<hex::Framebuffer> m_shadowMap;
+
+    RenderQueue m_staticQueue;
+    RenderQueue m_dynamicQueue;
+
+    uint64_t m_staticSignature = 0;
+    bool m_staticDirty = true;
+
+    uint32_t m_staticCasterCount  = 0;
+    uint32_t m_dynamicCasterCount = 0;
+    uint32_t m_staticRenderCount  = 0; // The number of times the static layer was rendered
+
+    /**
+     * @brief Hashes everything the static layer depends on, and counts the casters.
+     */
+    uint64_t computeStaticSignature(const hex::Scene& scene, const matrix4x4f& lightViewProjection);
+};
+
+}; // namespace prism
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "floatmath.hpp"
+#include "codex/shader.hpp"
+#include "codex/mesh.hpp"
+
+#include <cstdint>
+
+namespace hex {
+    // Forward declaration
+    class Camera;
+}
+
+namespace prism {
+
+/**
+ * @brief Anti-aliases the scene over time, and upsamples it to the output resolution.
+ * The projection is offset by a different sub-pixel jitter every frame, so consecutive frames
+ * sample different points of every pixel. The resolve reprojects the output of the last frame
+ * with the motion vectors of the G-buffer, clamps it to the colors around the pixel in the
+ * current frame (so disoccluded or changed surfaces don't ghost), and blends in the new samples.
+ * Since the history is kept at the output resolution, the accumulated samples reconstruct
+ * the detail lost by rendering at a lower resolution.
+ */
+class TemporalAA {
+public:
+    static constexpr uint32_t JITTER_SAMPLES = 16;      // The length of the jitter sequence
+    static constexpr float    BLEND_FACTOR   = 0.1f;    // The weight of the current frame in the output
+
+    TemporalAA() = default;
+    ~TemporalAA();
+
+    TemporalAA(const TemporalAA&) = delete;
+    TemporalAA& operator=(const TemporalAA&) = delete;
+
+    inline bool isEnabled() const { return m_enabled; }
+    /**
+     * @brief The history is dropped when enabling, it was not kept up to date.
+     */
+    void setEnabled(bool enabled);
+
+    /**
+     * @brief Resizes the history for the output resolution, dropping it if the size changed.
+     */
+    void resize(int width, int height);
+
+    /**
+     * @brief Advances the jitter sequence and swaps the histories.
+     *
+     * @param renderWidth The width the scene is rendered at this frame
+     * @param renderHeight The height the scene is rendered at this frame
+     * @return vector4f The jitter of the frame in normalized device coordinates, zero if disabled
+     */
+    vector4f beginFrame(int renderWidth, int renderHeight);
+
+    /**
+     * @brief Resolves the frame into the output texture, binding its own framebuffer.
+     *
+     * @param shader The resolve shader
+     * @param quad The full screen quad
+     * @param colorTexture The lit scene, rendered into the bottom left corner
+     * @param velocityTexture The motion vectors of the G-buffer
+     * @param depthTexture The depth of the G-buffer, for the motion of the sky
+     * @param camera The camera the frame was rendered with
+     * @param sourceWidth The width of the scene textures
+     * @param sourceHeight The height of the scene textures
+     */
+    void resolve(codex::Shader* shader, codex::Mesh* quad, uint32_t colorTexture, uint32_t velocityTexture, uint32_t depthTexture,
+                 hex::Camera* camera, int sourceWidth, int sourceHeight);
+
+    /**
+     * @return uint32_t The texture written by the resolve this frame, at the output resolution
+     */
+    inline uint32_t getOutputTexture() const { return m_histories[m_current]; }
+    inline const vector4f& getJitter() const { return m_jitterPixels; }
+protected:
+    bool m_enabled = false;
+    bool m_historyValid = false;
+
+    int m_width  = 0;
+    int m_height = 0;
+    int m_renderWidth  = 0;
+    int m_renderHeight = 0;
+
+    // Written and read alternately, the output of a frame is the history of the next
+    unsigned int m_histories[2] = { 0, 0 };
+    unsigned int m_framebuffers[2] = { 0, 0 };
+    uint32_t m_current = 0;
+
+    uint32_t m_sampleIndex = 0;
+    vector4f m_jitterPixels;  // In rendered pixels
+
+    void release();
+
+    /**
+     * @return float The element of the Halton sequence, in [0, 1)
+     */
+    static float halton(uint32_t index, uint32_t base);
+};
+
+}; // namespace prism
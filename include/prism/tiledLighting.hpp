@@ -0,0 +1,108 @@
+#pragma once
+
+#include "floatmath.hpp"
+#include "codex/shader.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace prism {
+
+enum class LightType : uint32_t {
+    POINT,
+    SPOT,
+    DIRECTIONAL
+};
+
+/**
+ * @brief A light as read by the shaders, matching the std430 layout of `Light` in GLSL.
+ */
+struct alignas(16) LightData {
+    vector4f positionRange;   // World space position in xyz, range in w
+    vector4f directionType;   // World space direction in xyz, the `LightType` in w
+    vector4f color;           // Color multiplied by the intensity in rgb
+    vector4f spotAngles;      // Cosine of the inner and outer cone angles in xy
+};
+
+using LightList = std::vector<LightData>;
+
+struct TiledLightingStats {
+    uint32_t lights = 0;  // Lights sent for culling
+    uint32_t tilesX = 0;  // Tiles of the rendered area
+    uint32_t tilesY = 0;
+};
+
+/**
+ * @brief Culls the lights of a view against screen tiles in a compute shader.
+ * Every tile is bounded by the minimum and maximum depth of its pixels,
+ * and collects the lights touching that volume into a compact index list.
+ * The lighting pass then only shades the lights of the tile a pixel falls in,
+ * so the cost follows the screen coverage of the lights, not their number.
+ * The light grid texture holds the offset and count of the list of each tile.
+ */
+class TiledLighting {
+public:
+    static constexpr uint32_t TILE_SIZE = 16;                 // Matches the work group size of the culling shader
+    static constexpr uint32_t MAX_LIGHTS_PER_TILE = 256;      // Lights over this are dropped from the tile
+    static constexpr uint32_t AVERAGE_LIGHTS_PER_TILE = 64;   // Sizes the index list, tiles over the budget get fewer lights
+    static constexpr int LIGHT_BINDING = 4;                   // The binding of the lights in the shaders
+    static constexpr int INDEX_BINDING = 5;                   // The binding of the light index list in the shaders
+
+    TiledLighting() = default;
+    ~TiledLighting();
+
+    TiledLighting(const TiledLighting&) = delete;
+    TiledLighting& operator=(const TiledLighting&) = delete;
+
+    /**
+     * @return LightList& The lights of the frame, filled by the light components through the view
+     */
+    inline LightList& getLights() { return m_lights; }
+
+    /**
+     * @brief Resizes the grid for the largest resolution rendered at, only reallocating if the tile count changed.
+     */
+    void resize(int width, int height);
+
+    /**
+     * @brief Uploads the lights and builds the light lists of the tiles.
+     *
+     * @param shader The culling compute shader
+     * @param depthTexture The depth buffer of the view
+     * @param viewMatrix The view matrix of the camera
+     * @param projectionMatrix The projection matrix of the camera
+     * @param width The width of the rendered area of the depth buffer, at most the size of the grid
+     * @param height The height of the rendered area
+     */
+    void cull(codex::Shader* shader, uint32_t depthTexture, const matrix4x4f& viewMatrix, const matrix4x4f& projectionMatrix, int width, int height);
+
+    /**
+     * @brief Binds the lights and the index list for shading, the grid is bound by the caller as a texture.
+     */
+    void bind() const;
+
+    inline uint32_t getGridTexture() const { return m_gridTexture; }
+    inline uint32_t getTileCountX() const { return m_tilesX; }
+    inline uint32_t getTileCountY() const { return m_tilesY; }
+    inline const TiledLightingStats& getStats() const { return m_stats; }
+protected:
+    LightList m_lights;
+
+    uint32_t m_tilesX = 0;
+    uint32_t m_tilesY = 0;
+
+    unsigned int m_gridTexture = 0;  // RG32UI, offset and count per tile
+    unsigned int m_indexBuffer = 0;  // A counter, then the light indices of every tile
+    size_t m_indexCapacity = 0;      // In indices
+
+    // The lights of the last cull, kept bound by offset in the stream buffer
+    unsigned int m_lightBuffer = 0;
+    intptr_t m_lightOffset = 0;
+    intptr_t m_lightSize = 0;
+
+    TiledLightingStats m_stats;
+
+    void release();
+};
+
+}; // namespace prism
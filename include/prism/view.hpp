@@ -0,0 +1,103 @@
+#pragma once
+
+#include "floatmath.hpp"
+#include "codex/shader.hpp"
+#include "prism/renderQueue.hpp"
+#include "prism/objectBuffer.hpp"
+#include "prism/tiledLighting.hpp"
+#include "prism/occlusionCulling.hpp"
+
+#include <array>
+
+namespace hex {
+    // Forward declaration
+    class Camera;
+}
+
+namespace prism {
+
+/**
+ * @brief The six clipping planes of a view, used for culling.
+ */
+struct Frustum {
+    std::array<vector4f, 6> planes; // Normal in xyz, distance in w, pointing inwards
+
+    /**
+     * @brief Extracts the planes from a combined view projection matrix.
+     * 
+     * @param viewProjection The view matrix multiplied by the projection matrix
+     * @return Frustum The frustum of the matrix
+     */
+    static Frustum fromMatrix(const matrix4x4f& viewProjection);
+
+    /**
+     * @param bounds The world space box to test
+     * @return bool If the box is at least partially inside the frustum
+     */
+    bool intersects(const boundsf& bounds) const;
+};
+
+/**
+ * @brief Selects which actors a view renders, by their static flag.
+ */
+enum class ActorFilter : uint8_t {
+    ALL,
+    STATIC_ONLY,
+    DYNAMIC_ONLY,
+};
+
+/**
+ * @brief Describes a single point of view the scene is rendered from.
+ * Passed down to the components, so they can make view dependent decisions,
+ * for example selecting the detail level of their meshes.
+ */
+struct View {
+    vector4f position;             // The world space position of the viewer
+    float projectionScale = 1.0f;  // The vertical scale of the projection (cot(fov / 2) for perspective)
+    bool orthographic = false;
+
+    int lodBias = 0;               // Added to the selected detail level, shadow passes use coarser meshes
+    bool lodCrossFade = true;      // If dithered cross-fading between levels is allowed
+
+    codex::Shader* overrideShader = nullptr; // Renders everything with this shader if set
+
+    RenderPass pass = PASS_OPAQUE;           // The pass the draws of the view belong to
+    RenderQueue* queue = nullptr;            // The queue the components emit their draws into
+    ObjectBuffer* objects = nullptr;         // The per-object data of the scene, enables indirect drawing
+    LightList* lights = nullptr;             // The light components of the scene add themselves here, if set
+    OcclusionCulling* occlusion = nullptr;   // Culls the indirect draws against the depth of the previous frame, if set
+
+    Frustum frustum;
+    bool frustumCulling = true;
+    ActorFilter actorFilter = ActorFilter::ALL;
+
+    float interpolation = 1.0f;              // Between the previous (0) and the current (1) simulation state
+    uint64_t frame = 0;                      // The number of the rendered frame, for the motion vectors (0 if not tracked)
+
+    /**
+     * @brief Creates a view looking through the camera.
+     * 
+     * @param camera The camera to look through
+     * @param lodBias The detail level bias of the view
+     * @param overrideShader The shader to render every object with (optional)
+     * @return View The view of the camera
+     */
+    static View fromCamera(hex::Camera* camera, int lodBias = 0, codex::Shader* overrideShader = nullptr);
+
+    /**
+     * @brief Estimates the size of a sphere on the screen.
+     * 
+     * @param center The world space center of the sphere
+     * @param radius The radius of the sphere
+     * @return float The projected height of the sphere relative to the screen height
+     */
+    float screenSize(const vector4f& center, float radius) const;
+
+    /**
+     * @param point The world space point
+     * @return float The distance between the viewer and the point
+     */
+    inline float distanceTo(const vector4f& point) const { return (point - position).length3d(); }
+};
+
+}; // namespace prism
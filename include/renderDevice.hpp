@@ -0,0 +1,152 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace cinder {
+
+struct RenderDeviceStats {
+    uint32_t issued  = 0; // State changes sent to the driver
+    uint32_t skipped = 0; // State changes dropped, because the state was already set
+};
+
+/**
+ * @brief A thin layer over the OpenGL state, shadowing it to drop redundant calls.
+ * Every state change of the renderer should go through it, otherwise the shadowed state goes stale.
+ * Textures are bound with `glBindTextureUnit`, so the active texture unit is always 0,
+ * code editing textures through the `GL_TEXTURE_2D` target should bind them to unit 0 first.
+ */
+class RenderDevice {
+public:
+    /**
+     * @brief Starts a new frame, resetting the counters.
+     * The shadowed state is forgotten too, as the UI renderer changes the state outside of the device.
+     */
+    static void beginFrame();
+    /**
+     * @brief Forgets the shadowed state, the next change of everything is sent to the driver.
+     */
+    static void invalidate();
+
+    static void useProgram(uint32_t program);
+    static void bindVertexArray(uint32_t vertexArray);
+    static void bindTexture(uint32_t unit, uint32_t texture);
+    static void bindSampler(uint32_t unit, uint32_t sampler);
+    /**
+     * @param target `GL_FRAMEBUFFER`, `GL_READ_FRAMEBUFFER` or `GL_DRAW_FRAMEBUFFER`
+     */
+    static void bindFramebuffer(uint32_t target, uint32_t framebuffer);
+    /**
+     * @param target `GL_DRAW_INDIRECT_BUFFER`, other non-indexed targets are not shadowed
+     */
+    static void bindBuffer(uint32_t target, uint32_t buffer);
+    /**
+     * @param target `GL_UNIFORM_BUFFER` or `GL_SHADER_STORAGE_BUFFER`
+     */
+    static void bindBufferBase(uint32_t target, uint32_t index, uint32_t buffer);
+    /**
+     * @brief Binds a part of a buffer to an indexed binding point, see `bindBufferBase`.
+     */
+    static void bindBufferRange(uint32_t target, uint32_t index, uint32_t buffer, intptr_t offset, intptr_t size);
+
+    /**
+     * @param capability `GL_DEPTH_TEST`, `GL_CULL_FACE`, `GL_BLEND`, `GL_SCISSOR_TEST` or `GL_STENCIL_TEST`, others are not shadowed
+     */
+    static void setEnabled(uint32_t capability, bool enabled);
+    static void setViewport(int x, int y, int width, int height);
+    static void setCullFace(uint32_t mode);
+    static void setFrontFace(uint32_t mode);
+    static void setDepthFunc(uint32_t func);
+    static void setDepthMask(bool write);
+    /**
+     * @brief Enables or disables the color writes of every draw buffer at once.
+     */
+    static void setColorMask(bool write);
+    static void setBlendFunc(uint32_t source, uint32_t destination);
+    static void setClearColor(float r, float g, float b, float a);
+
+    /**
+     * @brief Deletes the objects, and removes them from the shadowed state.
+     * The driver unbinds deleted objects, and a new object may get the same handle.
+     */
+    static void deleteTexture(uint32_t texture);
+    static void deleteVertexArray(uint32_t vertexArray);
+    static void deleteFramebuffer(uint32_t framebuffer);
+    static void deleteBuffer(uint32_t buffer);
+
+    /**
+     * @return const RenderDeviceStats& The counters of the last finished frame
+     */
+    static inline const RenderDeviceStats& getLastFrameStats() { return s_lastFrameStats; }
+    static inline const RenderDeviceStats& getStats() { return s_stats; }
+protected:
+    static constexpr uint32_t UNKNOWN = UINT32_MAX;
+
+    static constexpr uint32_t TEXTURE_UNITS   = 32;
+    static constexpr uint32_t BUFFER_BINDINGS = 16;
+    static constexpr uint32_t CAPABILITIES    = 5;
+
+    /**
+     * @brief An indexed buffer binding, a size of 0 means the whole buffer.
+     */
+    struct BufferBinding {
+        uint32_t buffer = UNKNOWN;
+        intptr_t offset = 0;
+        intptr_t size   = 0;
+
+        inline bool operator==(const BufferBinding& other) const = default;
+    };
+
+    struct State {
+        uint32_t program      = UNKNOWN;
+        uint32_t vertexArray  = UNKNOWN;
+        uint32_t readFramebuffer = UNKNOWN;
+        uint32_t drawFramebuffer = UNKNOWN;
+        uint32_t drawIndirectBuffer = UNKNOWN;
+
+        std::array<uint32_t, TEXTURE_UNITS> textures;
+        std::array<uint32_t, TEXTURE_UNITS> samplers;
+        std::array<BufferBinding, BUFFER_BINDINGS> uniformBuffers;
+        std::array<BufferBinding, BUFFER_BINDINGS> storageBuffers;
+
+        std::array<int8_t, CAPABILITIES> capabilities; // -1 if unknown
+        std::array<int, 4> viewport;
+        bool viewportKnown = false;
+
+        uint32_t cullFace   = UNKNOWN;
+        uint32_t frontFace  = UNKNOWN;
+        uint32_t depthFunc  = UNKNOWN;
+        int8_t   depthMask  = -1;
+        int8_t   colorMask  = -1;
+        uint32_t blendSource      = UNKNOWN;
+        uint32_t blendDestination = UNKNOWN;
+        std::array<float, 4> clearColor;
+        bool clearColorKnown = false;
+
+        State();
+    };
+
+    static inline State s_state;
+    static inline RenderDeviceStats s_stats;
+    static inline RenderDeviceStats s_lastFrameStats;
+
+    /**
+     * @brief Counts the change, and updates the shadowed value.
+     * @return true If the call has to be sent to the driver
+     */
+    template<typename T>
+    static inline bool change(T& shadowed, const T& value) {
+        if (shadowed == value) {
+            s_stats.skipped++;
+            return false;
+        }
+        shadowed = value;
+        s_stats.issued++;
+        return true;
+    }
+
+    static int capabilityIndex(uint32_t capability);
+    static std::array<BufferBinding, BUFFER_BINDINGS>* bufferBindings(uint32_t target);
+};
+
+}; // namespace cinder
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+
+namespace cinder {
+
+/**
+ * @brief Fixed timestep accumulator, decoupling the simulation from the frame rate.
+ * Every frame the elapsed time is added, and the simulation runs as many fixed ticks as fit in it.
+ * The remainder is used for interpolating between the last two simulation states when rendering.
+ */
+class FixedTimestep {
+public:
+    /**
+     * @param tickRate The number of simulation ticks per second
+     * @param maxCatchUpTicks The maximum number of ticks per frame, the rest of the time is dropped
+     */
+    FixedTimestep(double tickRate = 60.0, int maxCatchUpTicks = 5);
+
+    /**
+     * @brief Adds the elapsed time of a frame.
+     * 
+     * @param frameTime The elapsed time in seconds
+     * @return int The number of ticks to simulate this frame
+     */
+    int advance(double frameTime);
+
+    /**
+     * @return float How far the render time is between the previous and the current simulation state [0, 1]
+     */
+    inline float getAlpha() const { return static_cast<float>(m_accumulator / m_tickDelta); }
+
+    inline double getTickDelta() const { return m_tickDelta; }
+    inline double getTickRate() const { return 1.0 / m_tickDelta; }
+    void setTickRate(double tickRate);
+
+    inline int getMaxCatchUpTicks() const { return m_maxCatchUpTicks; }
+    inline void setMaxCatchUpTicks(int maxCatchUpTicks) { m_maxCatchUpTicks = maxCatchUpTicks > 1 ? maxCatchUpTicks : 1; }
+
+    inline uint64_t getTickCount() const { return m_tickCount; }
+    inline int getLastFrameTicks() const { return m_lastFrameTicks; }
+    inline double getDroppedTime() const { return m_droppedTime; }
+protected:
+    double m_tickDelta;
+    double m_accumulator = 0.0;
+    int m_maxCatchUpTicks;
+
+    uint64_t m_tickCount = 0;
+    int m_lastFrameTicks = 0;
+    double m_droppedTime = 0.0; // The total time skipped because of the catch-up limit
+};
+
+}; // namespace cinder
@@ -5,6 +5,8 @@
 
 namespace cinder {
 
+static constexpr size_t STREAM_BUFFER_FRAME_SIZE = 4 * 1024 * 1024;
+
 SDL_AppResult App::initSDL() {
     if (!SDL_Init(SDL_INIT_VIDEO)) {
         cinder::error("Couldn't initialize SDL.");
@@ -81,9 +83,15 @@ SDL_AppResult App::init(std::string appName, std::string appVersion, std::string
     m_eventManager = std::make_unique<echo::EventManager>();
     m_eventManager->init();
 
+    // Created before the library, the meshes and materials live in them
+    m_geometryArena = std::make_unique<codex::GeometryArena>();
+    m_materialTable = std::make_unique<codex::MaterialTable>();
+
     m_library = std::make_unique<codex::Library>();
     m_library->init();
 
+    m_streamBuffer = std::make_unique<codex::StreamBuffer>(STREAM_BUFFER_FRAME_SIZE);
+
     cinder::log("Application initialized successfully.");
 
     return SDL_APP_CONTINUE;
@@ -95,6 +103,9 @@ void App::cleanup() {
 
     this->m_library.reset();
     cinder::log("Library destroyed.");
+    this->m_streamBuffer.reset();
+    this->m_geometryArena.reset();
+    this->m_materialTable.reset();
     this->m_glContext.reset();
     cinder::log("GL context destroyed.");
     this->m_window.reset();
@@ -0,0 +1,215 @@
+#include "cinder.hpp"
+#include "codex/geometryArena.hpp"
+#include "codex/mesh.hpp"
+#include "renderDevice.hpp"
+
+#include <glad.h>
+
+#include <algorithm>
+#include <format>
+
+namespace codex {
+
+uint32_t RangeAllocator::allocate(uint32_t size) {
+    if (size == 0) {
+        return INVALID;
+    }
+
+    for (auto it = m_freeRanges.begin(); it != m_freeRanges.end(); it++) {
+        if (it->size < size) {
+            continue;
+        }
+
+        const uint32_t offset = it->offset;
+        it->offset += size;
+        it->size   -= size;
+        if (it->size == 0) {
+            m_freeRanges.erase(it);
+        }
+
+        m_used += size;
+        return offset;
+    }
+
+    return INVALID;
+}
+
+void RangeAllocator::free(uint32_t offset, uint32_t size) {
+    if (size == 0) {
+        return;
+    }
+    m_used -= size;
+
+    auto next = std::lower_bound(m_freeRanges.begin(), m_freeRanges.end(), offset, [](const Range& range, uint32_t value) {
+        return range.offset < value;
+    });
+
+    const bool mergePrevious = next != m_freeRanges.begin() && std::prev(next)->offset + std::prev(next)->size == offset;
+    const bool mergeNext     = next != m_freeRanges.end() && offset + size == next->offset;
+
+    if (mergePrevious && mergeNext) {
+        std::prev(next)->size += size + next->size;
+        m_freeRanges.erase(next);
+    } else if (mergePrevious) {
+        std::prev(next)->size += size;
+    } else if (mergeNext) {
+        next->offset = offset;
+        next->size  += size;
+    } else {
+        m_freeRanges.insert(next, { offset, size });
+    }
+}
+
+void RangeAllocator::grow(uint32_t capacity) {
+    if (capacity <= m_capacity) {
+        return;
+    }
+
+    const uint32_t added = capacity - m_capacity;
+    if (!m_freeRanges.empty() && m_freeRanges.back().offset + m_freeRanges.back().size == m_capacity) {
+        m_freeRanges.back().size += added;
+    } else {
+        m_freeRanges.push_back({ m_capacity, added });
+    }
+    m_capacity = capacity;
+}
+
+GeometryArena::~GeometryArena() {
+    for (const Format& format : m_formats) {
+        cinder::RenderDevice::deleteBuffer(format.vertexBuffer);
+        cinder::RenderDevice::deleteBuffer(format.indexBuffer);
+        cinder::RenderDevice::deleteVertexArray(format.vertexArray);
+    }
+}
+
+uint32_t GeometryArena::findFormat(const std::vector<Layout>& layout) {
+    for (uint32_t i = 0; i < m_formats.size(); i++) {
+        const auto& sizes = m_formats[i].attributeSizes;
+        if (sizes.size() != layout.size()) {
+            continue;
+        }
+
+        bool same = true;
+        for (size_t j = 0; j < layout.size() && same; j++) {
+            same = sizes[j] == layout[j].getSize();
+        }
+        if (same) {
+            return i;
+        }
+    }
+
+    Format format;
+    format.stride = Layout::calculateStride(layout);
+    for (const Layout& attribute : layout) {
+        format.attributeSizes.push_back(attribute.getSize());
+    }
+
+    glCreateVertexArrays(1, &format.vertexArray);
+    for (uint32_t i = 0; i < layout.size(); i++) {
+        glEnableVertexArrayAttrib(format.vertexArray, i);
+        glVertexArrayAttribFormat(format.vertexArray, i, layout[i].getSize() / sizeof(float), GL_FLOAT, GL_FALSE, Layout::calculateOffset(layout, i));
+        glVertexArrayAttribBinding(format.vertexArray, i, 0);
+    }
+
+    format.vertexBuffer = growBuffer(0, format.vertices, format.stride, INITIAL_VERTICES);
+    format.indexBuffer  = growBuffer(0, format.indices, sizeof(uint32_t), INITIAL_INDICES);
+    glVertexArrayVertexBuffer(format.vertexArray, 0, format.vertexBuffer, 0, format.stride);
+    glVertexArrayElementBuffer(format.vertexArray, format.indexBuffer);
+
+    cinder::log(std::format("Geometry arena format created, {} byte vertices.", format.stride));
+    m_formats.push_back(std::move(format));
+    return static_cast<uint32_t>(m_formats.size() - 1);
+}
+
+uint32_t GeometryArena::growBuffer(uint32_t buffer, RangeAllocator& allocator, uint32_t elementSize, uint32_t minimumCapacity) {
+    const uint32_t oldCapacity = allocator.getCapacity();
+    const uint32_t capacity = SDL_max(minimumCapacity, oldCapacity * 2);
+
+    uint32_t grown = 0;
+    glCreateBuffers(1, &grown);
+    glNamedBufferStorage(grown, static_cast<GLsizeiptr>(capacity) * elementSize, nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+    if (buffer != 0) {
+        glCopyNamedBufferSubData(buffer, grown, 0, 0, static_cast<GLsizeiptr>(oldCapacity) * elementSize);
+        cinder::RenderDevice::deleteBuffer(buffer);
+    }
+
+    allocator.grow(capacity);
+    return grown;
+}
+
+GeometryAllocation GeometryArena::allocate(const std::vector<Layout>& layout, const MeshPart* data) {
+    GeometryAllocation allocation;
+    if (data == nullptr || layout.empty() || data->vertices.empty() || data->indices.empty()) {
+        return allocation;
+    }
+
+    const uint32_t formatIndex = findFormat(layout);
+    Format& format = m_formats[formatIndex];
+
+    const uint32_t vertexCount = static_cast<uint32_t>(data->vertices.size() * sizeof(float) / format.stride);
+    const uint32_t indexCount  = static_cast<uint32_t>(data->indices.size());
+
+    uint32_t firstVertex = format.vertices.allocate(vertexCount);
+    if (firstVertex == RangeAllocator::INVALID) {
+        format.vertexBuffer = growBuffer(format.vertexBuffer, format.vertices, format.stride, format.vertices.getCapacity() + vertexCount);
+        glVertexArrayVertexBuffer(format.vertexArray, 0, format.vertexBuffer, 0, format.stride);
+        firstVertex = format.vertices.allocate(vertexCount);
+    }
+
+    uint32_t firstIndex = format.indices.allocate(indexCount);
+    if (firstIndex == RangeAllocator::INVALID) {
+        format.indexBuffer = growBuffer(format.indexBuffer, format.indices, sizeof(uint32_t), format.indices.getCapacity() + indexCount);
+        glVertexArrayElementBuffer(format.vertexArray, format.indexBuffer);
+        firstIndex = format.indices.allocate(indexCount);
+    }
+
+    glNamedBufferSubData(format.vertexBuffer, static_cast<GLintptr>(firstVertex) * format.stride, static_cast<GLsizeiptr>(vertexCount) * format.stride, data->vertices.data());
+    glNamedBufferSubData(format.indexBuffer, static_cast<GLintptr>(firstIndex) * sizeof(uint32_t), static_cast<GLsizeiptr>(indexCount) * sizeof(uint32_t), data->indices.data());
+
+    allocation.format      = formatIndex;
+    allocation.firstVertex = firstVertex;
+    allocation.vertexCount = vertexCount;
+    allocation.firstIndex  = firstIndex;
+    allocation.indexCount  = indexCount;
+    return allocation;
+}
+
+void GeometryArena::free(GeometryAllocation& allocation) {
+    if (!allocation.isValid()) {
+        return;
+    }
+
+    Format& format = m_formats[allocation.format];
+    format.vertices.free(allocation.firstVertex, allocation.vertexCount);
+    format.indices.free(allocation.firstIndex, allocation.indexCount);
+    allocation = GeometryAllocation();
+}
+
+bool GeometryArena::read(const GeometryAllocation& allocation, MeshPart* out) const {
+    if (!allocation.isValid() || out == nullptr) {
+        return false;
+    }
+
+    const Format& format = m_formats[allocation.format];
+    out->vertices.resize(static_cast<size_t>(allocation.vertexCount) * format.stride / sizeof(float));
+    out->indices.resize(allocation.indexCount);
+    out->vertexCount = allocation.vertexCount;
+    out->indexCount  = allocation.indexCount;
+
+    glGetNamedBufferSubData(format.vertexBuffer, static_cast<GLintptr>(allocation.firstVertex) * format.stride, out->vertices.size() * sizeof(float), out->vertices.data());
+    glGetNamedBufferSubData(format.indexBuffer, static_cast<GLintptr>(allocation.firstIndex) * sizeof(uint32_t), out->indices.size() * sizeof(uint32_t), out->indices.data());
+    return true;
+}
+
+GeometryFormatStats GeometryArena::getFormatStats(uint32_t format) const {
+    const Format& pool = m_formats[format];
+    return {
+        pool.stride,
+        pool.vertices.getUsed(), pool.vertices.getCapacity(),
+        pool.indices.getUsed(),  pool.indices.getCapacity(),
+        pool.vertices.getFreeRangeCount() + pool.indices.getFreeRangeCount()
+    };
+}
+
+}; // namespace codex
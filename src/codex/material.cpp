@@ -25,6 +25,11 @@ Material::Material() {
 }
 
 Material::~Material() {
+    auto table = cinder::app->getMaterialTable();
+    if (isResident() && table != nullptr) {
+        table->remove(m_tableIndex);
+    }
+
     cinder::log("Material destroyed.");
 }
 
@@ -89,9 +94,48 @@ void Material::loadResource() {
         return;
     }
 
+    rebuildTextureBindings();
     m_initialized = true;
 }
 
+void Material::rebuildTextureBindings() {
+    m_textureBindings.clear();
+    for (const auto& [name, texture] : m_data->textures) {
+        m_textureBindings.push_back({ hashUniformName(name), texture });
+    }
+
+    m_tableRejected = false;
+    if (isResident() && !cinder::app->getMaterialTable()->update(m_tableIndex, this)) {
+        m_tableIndex = MaterialTable::NOT_RESIDENT;
+    }
+}
+
+const Texture* Material::getTextureForUniform(uint32_t uniformHash) const {
+    for (const auto& binding : m_textureBindings) {
+        if (binding.uniformHash == uniformHash) {
+            return binding.texture;
+        }
+    }
+    return nullptr;
+}
+
+uint32_t Material::getTableIndex() {
+    if (isResident() || m_tableRejected || !m_initialized) {
+        return m_tableIndex;
+    }
+
+    // Textures load on their own, the material is added once all of them are on the GPU
+    for (const auto& binding : m_textureBindings) {
+        if (!binding.texture->isInitialized()) {
+            return m_tableIndex;
+        }
+    }
+
+    m_tableIndex = cinder::app->getMaterialTable()->add(this);
+    m_tableRejected = !isResident();
+    return m_tableIndex;
+}
+
 void Material::bindTextures(Shader* shader) const {
     if (!m_initialized) {
         cinder::warn("Material not initialized.");
@@ -99,9 +143,9 @@ void Material::bindTextures(Shader* shader) const {
     }
 
     int index = 0;
-    for (const auto& [name, texture] : m_data->textures) {
-        texture->bind(index);
-        shader->setUniform(name, index);
+    for (const auto& binding : m_textureBindings) {
+        binding.texture->bind(index);
+        shader->setUniform(UniformName::fromHash(binding.uniformHash), index);
         index++;
     }
 }
@@ -113,6 +157,7 @@ void Material::setTexture(const std::string& name, Texture* texture) {
     }
 
     m_data->textures[name] = texture;
+    rebuildTextureBindings();
 }
 
 void Material::removeTexture(const std::string& name) {
@@ -122,6 +167,7 @@ void Material::removeTexture(const std::string& name) {
     }
 
     m_data->textures.erase(name);
+    rebuildTextureBindings();
 }
 
 const Texture* Material::getTexture(const std::string& name) const {
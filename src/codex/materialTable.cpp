@@ -0,0 +1,228 @@
+#include "cinder.hpp"
+#include "codex/materialTable.hpp"
+#include "codex/material.hpp"
+#include "codex/texture.hpp"
+#include "renderDevice.hpp"
+
+#include <glad.h>
+
+#include <format>
+
+namespace codex {
+
+MaterialTable::MaterialTable() {
+    m_entries.emplace_back();
+}
+
+MaterialTable::~MaterialTable() {
+    for (const Pool& pool : m_pools) {
+        cinder::RenderDevice::deleteTexture(pool.handle);
+    }
+    cinder::RenderDevice::deleteBuffer(m_bufferHandle);
+}
+
+uint32_t MaterialTable::add(const Material* material) {
+    MaterialEntry entry;
+    if (!pack(material, entry)) {
+        return NOT_RESIDENT;
+    }
+
+    uint32_t index;
+    if (!m_freeEntries.empty()) {
+        index = m_freeEntries.back();
+        m_freeEntries.pop_back();
+        m_entries[index] = entry;
+    } else {
+        index = static_cast<uint32_t>(m_entries.size());
+        m_entries.push_back(entry);
+    }
+
+    m_dirty = true;
+    return index;
+}
+
+bool MaterialTable::update(uint32_t index, const Material* material) {
+    // Packed first, so the textures kept by the material aren't copied again
+    MaterialEntry entry;
+    const bool packed = pack(material, entry);
+    release(m_entries[index]);
+
+    if (!packed) {
+        m_entries[index] = MaterialEntry();
+        m_freeEntries.push_back(index);
+        m_dirty = true;
+        return false;
+    }
+
+    m_entries[index] = entry;
+    m_dirty = true;
+    return true;
+}
+
+void MaterialTable::remove(uint32_t index) {
+    if (index == 0 || index >= m_entries.size()) {
+        return;
+    }
+
+    release(m_entries[index]);
+    m_entries[index] = MaterialEntry();
+    m_freeEntries.push_back(index);
+    m_dirty = true;
+}
+
+bool MaterialTable::pack(const Material* material, MaterialEntry& entry) {
+    for (size_t slot = 0; slot < SLOT_NAMES.size(); slot++) {
+        const Texture* texture = material->getTextureForUniform(hashUniformName(SLOT_NAMES[slot]));
+        if (texture == nullptr) {
+            continue;
+        }
+
+        entry.textures[slot] = acquireTexture(texture);
+        if (entry.textures[slot] == MaterialEntry::NO_TEXTURE) {
+            release(entry);
+            entry = MaterialEntry();
+            return false;
+        }
+    }
+    return true;
+}
+
+void MaterialTable::release(const MaterialEntry& entry) {
+    for (const uint32_t location : entry.textures) {
+        if (location != MaterialEntry::NO_TEXTURE) {
+            releaseTexture(location);
+        }
+    }
+}
+
+uint32_t MaterialTable::acquireTexture(const Texture* texture) {
+    for (PackedTexture& packed : m_packedTextures) {
+        if (packed.texture == texture) {
+            packed.users++;
+            return packed.location;
+        }
+    }
+
+    if (!texture->isInitialized()) {
+        return MaterialEntry::NO_TEXTURE;
+    }
+
+    const uint32_t poolIndex = findPool(texture);
+    if (poolIndex == NOT_RESIDENT) {
+        return MaterialEntry::NO_TEXTURE;
+    }
+
+    Pool& pool = m_pools[poolIndex];
+    uint32_t layer;
+    if (!pool.freeLayers.empty()) {
+        layer = pool.freeLayers.back();
+        pool.freeLayers.pop_back();
+    } else {
+        if (pool.usedLayers == pool.layerCapacity) {
+            growPool(pool);
+        }
+        layer = pool.usedLayers++;
+    }
+
+    for (int level = 0; level < pool.levels; level++) {
+        glCopyImageSubData(
+            texture->getHandle(), GL_TEXTURE_2D, level, 0, 0, 0,
+            pool.handle, GL_TEXTURE_2D_ARRAY, level, 0, 0, layer,
+            SDL_max(pool.width >> level, 1), SDL_max(pool.height >> level, 1), 1
+        );
+    }
+
+    const uint32_t location = (poolIndex << 16) | layer;
+    m_packedTextures.push_back({ texture, location, 1 });
+    return location;
+}
+
+void MaterialTable::releaseTexture(uint32_t location) {
+    for (auto it = m_packedTextures.begin(); it != m_packedTextures.end(); it++) {
+        if (it->location != location) {
+            continue;
+        }
+
+        if (--it->users == 0) {
+            m_pools[location >> 16].freeLayers.push_back(location & 0xFFFF);
+            m_packedTextures.erase(it);
+        }
+        return;
+    }
+}
+
+uint32_t MaterialTable::findPool(const Texture* texture) {
+    for (uint32_t i = 0; i < m_pools.size(); i++) {
+        const Pool& pool = m_pools[i];
+        if (pool.width == texture->getWidth() && pool.height == texture->getHeight() &&
+            pool.internalFormat == texture->getInternalFormat() && pool.levels == texture->getLevels()) {
+            return i;
+        }
+    }
+
+    if (m_pools.size() >= MAX_POOLS) {
+        cinder::warn(std::format("Material table is out of pools, a {}x{} texture stays unpooled.", texture->getWidth(), texture->getHeight()));
+        return NOT_RESIDENT;
+    }
+
+    Pool pool;
+    pool.width          = texture->getWidth();
+    pool.height         = texture->getHeight();
+    pool.internalFormat = texture->getInternalFormat();
+    pool.levels         = texture->getLevels();
+    growPool(pool);
+
+    cinder::log(std::format("Material texture pool created for {}x{} textures.", pool.width, pool.height));
+    m_pools.push_back(std::move(pool));
+    return static_cast<uint32_t>(m_pools.size() - 1);
+}
+
+void MaterialTable::growPool(Pool& pool) {
+    const uint32_t capacity = SDL_max(pool.layerCapacity * 2, INITIAL_LAYERS);
+
+    uint32_t handle = 0;
+    glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &handle);
+    glTextureStorage3D(handle, pool.levels, pool.internalFormat, pool.width, pool.height, capacity);
+
+    // Sampled the same way as the textures it holds
+    glTextureParameteri(handle, GL_TEXTURE_SRGB_DECODE_EXT, GL_SKIP_DECODE_EXT);
+    glTextureParameteri(handle, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTextureParameteri(handle, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTextureParameteri(handle, GL_TEXTURE_MIN_FILTER, pool.levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTextureParameteri(handle, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    if (pool.handle != 0) {
+        for (int level = 0; level < pool.levels; level++) {
+            glCopyImageSubData(
+                pool.handle, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+                handle, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+                SDL_max(pool.width >> level, 1), SDL_max(pool.height >> level, 1), pool.usedLayers
+            );
+        }
+        cinder::RenderDevice::deleteTexture(pool.handle);
+    }
+
+    pool.handle = handle;
+    pool.layerCapacity = capacity;
+}
+
+void MaterialTable::bind() {
+    if (m_dirty) {
+        if (m_entries.size() > m_bufferCapacity) {
+            cinder::RenderDevice::deleteBuffer(m_bufferHandle);
+            m_bufferCapacity = SDL_max(m_entries.size(), m_bufferCapacity * 2);
+            glCreateBuffers(1, &m_bufferHandle);
+            glNamedBufferStorage(m_bufferHandle, m_bufferCapacity * sizeof(MaterialEntry), nullptr, GL_DYNAMIC_STORAGE_BIT);
+        }
+
+        glNamedBufferSubData(m_bufferHandle, 0, m_entries.size() * sizeof(MaterialEntry), m_entries.data());
+        m_dirty = false;
+    }
+
+    cinder::RenderDevice::bindBufferBase(GL_SHADER_STORAGE_BUFFER, BINDING, m_bufferHandle);
+    for (uint32_t i = 0; i < m_pools.size(); i++) {
+        cinder::RenderDevice::bindTexture(FIRST_POOL_UNIT + i, m_pools[i].handle);
+    }
+}
+
+}; // namespace codex
@@ -2,12 +2,16 @@
 
 #include "codex/mesh.hpp"
 #include "codex/library.hpp"
+#include "renderDevice.hpp"
 
 #include <glad.h>
 #include <assimp/postprocess.h>
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 
+#include <unordered_map>
+#include <cmath>
+
 namespace codex {
 
 Mesh::Mesh(MeshPart* data, std::vector<Layout>& layout) {
@@ -17,6 +21,7 @@ Mesh::Mesh(MeshPart* data, std::vector<Layout>& layout) {
     m_runtimeResource = true;
     m_layout = layout;
     m_transform = new transformf(data->partTransform);
+    m_bounds = data->bounds;
     uploadData(data);
     m_data.reset();
 
@@ -26,6 +31,16 @@ Mesh::Mesh(MeshPart* data, std::vector<Layout>& layout) {
     }
 }
 
+Mesh::Mesh(const std::vector<Mesh*>& parts, const boundsf& bounds) {
+    m_data = nullptr;
+    m_node = nullptr;
+    m_runtimeResource = true;
+    m_transform = new transformf();
+    m_meshParts = parts;
+    m_bounds = bounds;
+    m_initialized = true;
+}
+
 Mesh::Mesh() {
     m_data = nullptr;
     m_node = nullptr;
@@ -38,12 +53,10 @@ Mesh::Mesh() {
 bool Mesh::m_suppressDestroyMessage = false;
 
 Mesh::~Mesh() {
-    if (m_vertexBufferObjectHandle > 0)
-        glDeleteBuffers(1, &m_vertexBufferObjectHandle);
-    if (m_indexBufferObjectHandle > 0)
-        glDeleteBuffers(1, &m_indexBufferObjectHandle);
-    if (m_vertexArrayObjectHandle > 0)
-        glDeleteVertexArrays(1, &m_vertexArrayObjectHandle);
+    auto arena = cinder::app->getGeometryArena();
+    if (arena != nullptr) {
+        arena->free(m_geometry);
+    }
 
     if (!Mesh::m_suppressDestroyMessage) {
         cinder::log("Mesh destroyed... extra messages supressed.");
@@ -115,6 +128,26 @@ void Mesh::loadData(const FileNode* node) {
     cinder::log("Loaded mesh data from file: " + node->path.string());
 }
 
+// Authored detail levels follow the common "<name>_LOD<n>" node naming convention
+static uint8_t parseLODLevel(const std::string& name) {
+    auto position = name.rfind("_LOD");
+    if (position == std::string::npos) {
+        position = name.rfind("_lod");
+    }
+    if (position == std::string::npos || position + 4 >= name.size()) {
+        return 0;
+    }
+
+    int level = 0;
+    for (size_t i = position + 4; i < name.size(); i++) {
+        if (name[i] < '0' || name[i] > '9') {
+            return 0;
+        }
+        level = level * 10 + (name[i] - '0');
+    }
+    return static_cast<uint8_t>(SDL_clamp(level, 0, 255));
+}
+
 void Mesh::loadDataRecursive(MeshData* data, const aiNode* node, const aiScene* scene, transformf* parentTransform) {
     for (unsigned int i = 0; i < node->mNumMeshes; i++) {
         aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
@@ -124,12 +157,14 @@ void Mesh::loadDataRecursive(MeshData* data, const aiNode* node, const aiScene*
 
         aiMatrix4x4 aiTransform = node->mTransformation;
         convertAITransformToTransformf(aiTransform, &meshPart->partTransform, parentTransform);
+        meshPart->lodLevel = parseLODLevel(node->mName.C_Str());
 
         for (unsigned int k = 0; k < mesh->mNumVertices; k++) {
             aiVector3D vertex = mesh->mVertices[k];
             meshPart->vertices.push_back(vertex.x);
             meshPart->vertices.push_back(vertex.y);
             meshPart->vertices.push_back(vertex.z);
+            meshPart->bounds.expand(vector4f(vertex.x, vertex.y, vertex.z, 0.0f));
 
             aiVector3D normal = mesh->mNormals[k];
             meshPart->vertices.push_back(normal.x);
@@ -192,10 +227,14 @@ void Mesh::loadResource() {
     folderNode->isDirectory = true;
     folderNode->name = baseName;
 
+    std::vector<Mesh*> authoredLODParts;
+    bool hasFullDetailParts = false;
     for (int i = 0; i < m_data->meshParts.size(); i++) {
         MeshPart* meshPart = m_data->meshParts[i].get();
         
-        std::string partName = std::format("part_{:0>3}.mesh", i);
+        std::string partName = meshPart->lodLevel == 0 ?
+            std::format("part_{:0>3}.mesh", i) :
+            std::format("lod{}_part_{:0>3}.mesh", meshPart->lodLevel, i);
         auto meshNode = library->requestRuntimeNode((library->getAssetsRoot() / "runtime" / baseName / partName).string(), folderNode);
         if (meshNode == nullptr) {
             cinder::warn("Failed to create runtime mesh node.");
@@ -208,48 +247,210 @@ void Mesh::loadResource() {
 
         Mesh* mesh = new Mesh(meshPart, m_layout);
         mesh->m_node = meshNode;
+        library->registerRuntimeResource(mesh);
+
+        if (meshPart->lodLevel != 0) {
+            authoredLODParts.push_back(mesh);
+            continue;
+        }
+
+        hasFullDetailParts = true;
         m_meshParts.push_back(mesh);
+        m_bounds.merge(meshPart->bounds);
+    }
 
-        library->registerRuntimeResource(mesh);
+    if (!hasFullDetailParts) {
+        cinder::warn("Mesh has no full detail parts.");
+        return;
     }
 
-    MeshPart* meshPart = m_data->meshParts[0].get();
-    uploadData(meshPart);
-    //if (m_transform != nullptr) {
-    //    delete m_transform;
-    //}
-    //m_transform = new transformf(meshPart->partTransform);
+    // The geometry lives in the parts, the mesh itself only draws them
+    m_initialized = true;
+
+    if (authoredLODParts.empty()) {
+        std::vector<Mesh*> baseParts = m_meshParts;
+        createLODs(folderNode, baseParts);
+    } else {
+        // Group the authored parts by level
+        uint8_t maxLevel = 0;
+        for (const auto& part : m_data->meshParts) {
+            maxLevel = SDL_max(maxLevel, part->lodLevel);
+        }
+
+        for (uint8_t level = 1; level <= maxLevel; level++) {
+            std::vector<Mesh*> parts;
+            boundsf bounds;
+            int partIndex = 0;
+            for (const auto& part : m_data->meshParts) {
+                if (part->lodLevel == 0) {
+                    continue;
+                }
+                if (part->lodLevel == level) {
+                    parts.push_back(authoredLODParts[partIndex]);
+                    bounds.merge(part->bounds);
+                }
+                partIndex++;
+            }
+
+            if (parts.empty()) {
+                continue;
+            }
+
+            std::string lodName = std::format("lod_{}.mesh", level);
+            auto lodNode = library->requestRuntimeNode((library->getAssetsRoot() / "runtime" / baseName / lodName).string(), folderNode);
+            if (lodNode == nullptr) {
+                cinder::warn("Failed to create runtime LOD node.");
+                continue;
+            }
+            lodNode->type = FileType::MESH_PART;
+            lodNode->isDirectory = false;
+            lodNode->name = lodName;
+            lodNode->extension = "mesh";
+
+            Mesh* lod = new Mesh(parts, bounds);
+            lod->m_node = lodNode;
+            library->registerRuntimeResource(lod);
+            m_lods.push_back(lod);
+        }
+    }
 
-    cinder::log("Mesh created with " + std::to_string(m_data->meshParts.size()) + " parts.");
+    cinder::log("Mesh created with " + std::to_string(m_meshParts.size()) + " parts and " + std::to_string(m_lods.size()) + " detail levels.");
     m_data.reset();
 }
 
-void Mesh::uploadData(MeshPart* data) {
-    glGenVertexArrays(1, &m_vertexArrayObjectHandle);
-    glBindVertexArray(m_vertexArrayObjectHandle);
-
-    glGenBuffers(1, &m_vertexBufferObjectHandle);
-    glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferObjectHandle);
-    glBufferData(GL_ARRAY_BUFFER, data->vertices.size() * sizeof(float), data->vertices.data(), GL_STATIC_DRAW);
-
-    for (int i = 0; i < m_layout.size(); i++) {
-        glEnableVertexAttribArray(i);
-        uint8_t stride = Layout::calculateStride(m_layout);
-        uint64_t offset = Layout::calculateOffset(m_layout, i);
-        glVertexAttribPointer(i, m_layout[i].getSize() / sizeof(float), GL_FLOAT, GL_FALSE, stride, (void*) offset);
+/**
+ * Vertex clustering simplification: every vertex is snapped into a grid cell
+ * and the first vertex falling into a cell represents the whole cell.
+ * Triangles collapsing into less than three cells are dropped.
+ */
+static MeshPart* simplifyMeshPart(const MeshPart* source, uint32_t stride, float cellSize) {
+    auto part = new MeshPart();
+    part->partTransform = source->partTransform;
+    part->bounds        = source->bounds;
+
+    const float inverseCellSize = 1.0f / cellSize;
+    std::unordered_map<uint64_t, uint32_t> cellToVertex;
+    cellToVertex.reserve(source->vertexCount / 2);
+    std::vector<uint32_t> remap(source->vertexCount);
+
+    for (uint32_t i = 0; i < source->vertexCount; i++) {
+        const float* vertex = &source->vertices[i * stride];
+        const uint64_t x = static_cast<uint64_t>((vertex[0] - source->bounds.min.x) * inverseCellSize) & 0x1FFFFF;
+        const uint64_t y = static_cast<uint64_t>((vertex[1] - source->bounds.min.y) * inverseCellSize) & 0x1FFFFF;
+        const uint64_t z = static_cast<uint64_t>((vertex[2] - source->bounds.min.z) * inverseCellSize) & 0x1FFFFF;
+        const uint64_t key = (x << 42) | (y << 21) | z;
+
+        auto [it, inserted] = cellToVertex.try_emplace(key, static_cast<uint32_t>(part->vertices.size() / stride));
+        if (inserted) {
+            part->vertices.insert(part->vertices.end(), vertex, vertex + stride);
+        }
+        remap[i] = it->second;
+    }
+
+    part->indices.reserve(source->indices.size() / 2);
+    for (size_t i = 0; i + 2 < source->indices.size(); i += 3) {
+        const uint32_t a = remap[source->indices[i + 0]];
+        const uint32_t b = remap[source->indices[i + 1]];
+        const uint32_t c = remap[source->indices[i + 2]];
+        if (a == b || b == c || a == c) {
+            continue;
+        }
+        part->indices.push_back(a);
+        part->indices.push_back(b);
+        part->indices.push_back(c);
+    }
+
+    part->vertexCount = part->vertices.size() / stride;
+    part->indexCount  = part->indices.size();
+    return part;
+}
+
+void Mesh::createLODs(FileNode* folderNode, std::vector<Mesh*>& baseParts) {
+    auto library = cinder::app->getLibrary();
+    const auto baseName = m_node->name;
+    const uint32_t stride = Layout::calculateStride(m_layout) / sizeof(float);
+    const float diagonal = (m_bounds.max - m_bounds.min).length3d();
+
+    // Only level 0 parts are in the same order as baseParts
+    std::vector<MeshPart*> sourceParts;
+    for (const auto& part : m_data->meshParts) {
+        if (part->lodLevel == 0) {
+            sourceParts.push_back(part.get());
+        }
     }
 
-    glGenBuffers(1, &m_indexBufferObjectHandle);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBufferObjectHandle);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, data->indices.size() * sizeof(uint32_t), data->indices.data(), GL_STATIC_DRAW);
+    std::vector<uint32_t> previousIndexCounts(sourceParts.size());
+    for (int i = 0; i < sourceParts.size(); i++) {
+        previousIndexCounts[i] = sourceParts[i]->indexCount;
+    }
+
+    std::vector<Mesh*> previousParts = baseParts;
+    for (int level = 1; level <= LODGenerationSettings::MAX_LEVELS; level++) {
+        const float cellSize = diagonal * LODGenerationSettings::BASE_CELL_SIZE * static_cast<float>(1 << (level - 1));
+        bool reduced = false;
+
+        std::vector<Mesh*> parts;
+        for (int i = 0; i < sourceParts.size(); i++) {
+            MeshPart* source = sourceParts[i];
+            if (cellSize <= 0.0f || source->indexCount / 3 < LODGenerationSettings::MIN_TRIANGLE_COUNT) {
+                parts.push_back(previousParts[i]);
+                continue;
+            }
+
+            std::unique_ptr<MeshPart> simplified(simplifyMeshPart(source, stride, cellSize));
+            // Not worth a new set of buffers if it barely got simpler
+            if (simplified->indexCount == 0 || simplified->indexCount > previousIndexCounts[i] * 0.8f) {
+                parts.push_back(previousParts[i]);
+                continue;
+            }
+            simplified->lodLevel = level;
+
+            std::string partName = std::format("lod{}_part_{:0>3}.mesh", level, i);
+            auto meshNode = library->requestRuntimeNode((library->getAssetsRoot() / "runtime" / baseName / partName).string(), folderNode);
+            if (meshNode == nullptr) {
+                parts.push_back(previousParts[i]);
+                continue;
+            }
+            meshNode->type = FileType::MESH_PART;
+            meshNode->isDirectory = false;
+            meshNode->name = partName;
+            meshNode->extension = "mesh";
+
+            Mesh* mesh = new Mesh(simplified.get(), m_layout);
+            mesh->m_node = meshNode;
+            library->registerRuntimeResource(mesh);
+
+            parts.push_back(mesh);
+            previousIndexCounts[i] = simplified->indexCount;
+            reduced = true;
+        }
+
+        if (!reduced) {
+            break;
+        }
+
+        std::string lodName = std::format("lod_{}.mesh", level);
+        auto lodNode = library->requestRuntimeNode((library->getAssetsRoot() / "runtime" / baseName / lodName).string(), folderNode);
+        if (lodNode == nullptr) {
+            cinder::warn("Failed to create runtime LOD node.");
+            break;
+        }
+        lodNode->type = FileType::MESH_PART;
+        lodNode->isDirectory = false;
+        lodNode->name = lodName;
+        lodNode->extension = "mesh";
 
-    m_vertexCount = data->vertexCount;
-    m_indexCount = data->indexCount;
+        Mesh* lod = new Mesh(parts, m_bounds);
+        lod->m_node = lodNode;
+        library->registerRuntimeResource(lod);
+        m_lods.push_back(lod);
 
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        previousParts = parts;
+    }
+}
 
+void Mesh::uploadData(MeshPart* data) {
+    m_geometry = cinder::app->getGeometryArena()->allocate(m_layout, data);
     m_initialized = true;
 }
 
@@ -258,12 +459,58 @@ void Mesh::draw() const {
         return;
     }
 
-    glBindVertexArray(m_vertexArrayObjectHandle);
-    glDrawElements(GL_TRIANGLES, m_indexCount, GL_UNSIGNED_INT, nullptr);
+    if (m_geometry.isValid()) {
+        cinder::RenderDevice::bindVertexArray(cinder::app->getGeometryArena()->getVertexArray(m_geometry.format));
+        glDrawElementsBaseVertex(GL_TRIANGLES, m_geometry.indexCount, GL_UNSIGNED_INT,
+            reinterpret_cast<const void*>(static_cast<uintptr_t>(m_geometry.firstIndex) * sizeof(uint32_t)), m_geometry.firstVertex);
+    }
 
     for (const auto& parts : m_meshParts) {
         parts->draw();
     }
 }
 
+Mesh* Mesh::createRuntimeMesh(MeshPart* data, std::vector<Layout>& layout, const std::string& name, FileNode* folderNode) {
+    auto library = cinder::app->getLibrary();
+
+    auto meshNode = library->requestRuntimeNode((library->getAssetsRoot() / "runtime" / name).string(), folderNode);
+    if (meshNode == nullptr) {
+        cinder::warn("Failed to create runtime mesh node.");
+        return nullptr;
+    }
+    meshNode->type = FileType::MESH_PART;
+    meshNode->isDirectory = false;
+    meshNode->name = name;
+    meshNode->extension = "mesh";
+
+    Mesh* mesh = new Mesh(data, layout);
+    mesh->m_node = meshNode;
+    library->registerRuntimeResource(mesh);
+    return mesh;
+}
+
+bool Mesh::readVertexData(MeshPart* out) {
+    if (!m_initialized || !m_geometry.isValid() || out == nullptr) {
+        return false;
+    }
+
+    out->bounds = m_bounds;
+    return cinder::app->getGeometryArena()->read(m_geometry, out);
+}
+
+void Mesh::collectDrawRanges(std::vector<DrawRange>& out) const {
+    if (!m_initialized) {
+        return;
+    }
+
+    if (m_geometry.isValid()) {
+        const uint32_t vertexArray = cinder::app->getGeometryArena()->getVertexArray(m_geometry.format);
+        out.push_back({ vertexArray, m_geometry.indexCount, m_geometry.firstIndex, static_cast<int32_t>(m_geometry.firstVertex) });
+    }
+
+    for (const auto& parts : m_meshParts) {
+        parts->collectDrawRanges(out);
+    }
+}
+
 }; // namespace codex
\ No newline at end of file
@@ -1,42 +1,34 @@
 #include "cinder.hpp"
 #include "codex/shader.hpp"
 #include "codex/library.hpp"
+#include "renderDevice.hpp"
 
 #include <glad.h>
 #include <json.hpp>
 
+#include <algorithm>
 #include <filesystem>
+#include <format>
 #include <fstream>
+#include <type_traits>
 
 namespace codex {
 
 UniformBuffer::UniformBuffer(size_t size, int binding) {
-    glGenBuffers(1, &m_uniformBufferObjectHandle);
-    glBindBuffer(GL_UNIFORM_BUFFER, m_uniformBufferObjectHandle);
-    glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
-    glBindBufferBase(GL_UNIFORM_BUFFER, binding, m_uniformBufferObjectHandle);
-
-    cinder::log("Uniform buffer created.");
-
+    m_binding = binding;
     m_size = size;
-}
 
-void UniformBuffer::bind() {
-    glBindBuffer(GL_UNIFORM_BUFFER, m_uniformBufferObjectHandle);
+    cinder::log("Uniform buffer created.");
 }
 
 void UniformBuffer::updateData(const UniformBufferData* data) {
-    bind();
-    UniformBufferData* dataPointer = (UniformBufferData*)glMapBufferRange(
-        GL_UNIFORM_BUFFER,
-        0,
-        m_size,
-        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT
-    );
-    if (dataPointer) {
-        SDL_memcpy(dataPointer, data, m_size);
+    auto allocation = cinder::app->getStreamBuffer()->allocate(m_size, GL_UNIFORM_BUFFER);
+    if (!allocation.isValid()) {
+        return;
     }
-    glUnmapBuffer(GL_UNIFORM_BUFFER);
+
+    SDL_memcpy(allocation.pointer, data, m_size);
+    cinder::RenderDevice::bindBufferRange(GL_UNIFORM_BUFFER, m_binding, allocation.buffer, allocation.offset, allocation.size);
 }
 
 Shader::Shader() {
@@ -57,43 +49,163 @@ Shader::~Shader() {
 }
 
 void Shader::bind() {
-    glUseProgram(m_programHandle);
+    cinder::RenderDevice::useProgram(m_programHandle);
 }
 
-void Shader::setUniform(const std::string& name, const int& value) {
-    const GLint location = getUniformLocation(name);
-    if (location == -1) {
-        cinder::warn(std::string("Couldn't find uniform: ") + name);
+void Shader::dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) {
+    if (!m_compute) {
+        cinder::warn("Tried dispatching a shader without a compute stage.");
         return;
     }
-    if (location < -1) {
-        return;
+
+    bind();
+    glDispatchCompute(groupsX, groupsY, groupsZ);
+}
+
+/**
+ * @brief Checks if a reflected uniform type can be set with the given value type.
+ */
+template<typename T>
+static bool uniformTypeMatches(unsigned int type) {
+    if constexpr (std::is_same_v<T, int>) {
+        switch (type) {
+            case GL_INT: case GL_BOOL:
+            case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+            case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_2D_ARRAY_SHADOW:
+            case GL_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_2D:
+            case GL_IMAGE_2D: case GL_UNSIGNED_INT_IMAGE_2D:
+                return true;
+            default:
+                return false;
+        }
+    } else if constexpr (std::is_same_v<T, float>) {
+        return type == GL_FLOAT;
+    } else if constexpr (std::is_same_v<T, vector4f>) {
+        // Set with glUniform4fv, which fails on smaller vectors
+        return type == GL_FLOAT_VEC4;
+    } else if constexpr (std::is_same_v<T, matrix4x4f>) {
+        return type == GL_FLOAT_MAT4;
     }
-    glUniform1i(location, value);
+    return false;
 }
 
-void Shader::setUniform(const std::string& name, const vector4f& value) {
-    const GLint location = getUniformLocation(name);
-    if (location == -1) {
-        cinder::warn(std::string("Couldn't find uniform: ") + name);
-        return;
+void Shader::reflectUniforms() {
+    m_uniforms.clear();
+    m_missingUniforms.clear();
+
+    GLint count = 0, maxLength = 0;
+    glGetProgramiv(m_programHandle, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(m_programHandle, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+    std::vector<char> nameBuffer(SDL_max(maxLength, 1));
+    for (GLint index = 0; index < count; index++) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(m_programHandle, index, static_cast<GLsizei>(nameBuffer.size()), &length, &size, &type, nameBuffer.data());
+
+        std::string name(nameBuffer.data(), length);
+        // Arrays are reported as "name[0]", but set through their base name
+        if (name.ends_with("[0]")) {
+            name.resize(name.size() - 3);
+        }
+
+        // Members of uniform blocks have no location
+        const GLint location = glGetUniformLocation(m_programHandle, nameBuffer.data());
+        if (location < 0) {
+            continue;
+        }
+
+        m_uniforms.push_back({ hashUniformName(name), location, type, std::move(name) });
     }
-    if (location < -1) {
-        return;
+
+    std::sort(m_uniforms.begin(), m_uniforms.end(), [](const UniformInfo& a, const UniformInfo& b) {
+        return a.hash < b.hash;
+    });
+
+    for (size_t i = 1; i < m_uniforms.size(); i++) {
+        if (m_uniforms[i].hash == m_uniforms[i - 1].hash) {
+            cinder::warn("Uniform name hash collision: " + m_uniforms[i - 1].name + " and " + m_uniforms[i].name);
+        }
     }
-    glUniform4fv(location, 1, value.as_array.data());
 }
 
-void Shader::setUniform(const std::string& name, const matrix4x4f& value) {
-    const GLint location = getUniformLocation(name);
-    if (location == -1) {
-        cinder::warn(std::string("Couldn't find uniform: ") + name);
-        return;
+const Shader::UniformInfo* Shader::findUniform(UniformName name) const {
+    auto it = std::lower_bound(m_uniforms.begin(), m_uniforms.end(), name.hash, [](const UniformInfo& info, uint32_t hash) {
+        return info.hash < hash;
+    });
+    if (it != m_uniforms.end() && it->hash == name.hash) {
+        return &*it;
     }
-    if (location < -1) {
-        return;
+
+    if (std::find(m_missingUniforms.begin(), m_missingUniforms.end(), name.hash) == m_missingUniforms.end()) {
+        m_missingUniforms.push_back(name.hash);
+        cinder::warn(name.name != nullptr
+            ? std::string("Couldn't find uniform: ") + name.name
+            : std::format("Couldn't find uniform with hash: {:08x}", name.hash));
     }
-    glUniformMatrix4fv(location, 1, GL_FALSE, value.as_array.data());
+    return nullptr;
+}
+
+template<typename T>
+UniformHandle<T> Shader::getUniformHandle(UniformName name) const {
+    auto it = std::lower_bound(m_uniforms.begin(), m_uniforms.end(), name.hash, [](const UniformInfo& info, uint32_t hash) {
+        return info.hash < hash;
+    });
+    if (it == m_uniforms.end() || it->hash != name.hash) {
+        return {};
+    }
+
+    if (!uniformTypeMatches<T>(it->type)) {
+        cinder::warn("Uniform type mismatch: " + it->name);
+        return {};
+    }
+    return { it->location };
+}
+
+template UniformHandle<int>        Shader::getUniformHandle<int>(UniformName name) const;
+template UniformHandle<float>      Shader::getUniformHandle<float>(UniformName name) const;
+template UniformHandle<vector4f>   Shader::getUniformHandle<vector4f>(UniformName name) const;
+template UniformHandle<matrix4x4f> Shader::getUniformHandle<matrix4x4f>(UniformName name) const;
+
+void Shader::setUniform(UniformHandle<int> handle, const int& value) {
+    if (handle.isValid())
+        glUniform1i(handle.location, value);
+}
+
+void Shader::setUniform(UniformHandle<float> handle, const float& value) {
+    if (handle.isValid())
+        glUniform1f(handle.location, value);
+}
+
+void Shader::setUniform(UniformHandle<vector4f> handle, const vector4f& value) {
+    if (handle.isValid())
+        glUniform4fv(handle.location, 1, value.as_array.data());
+}
+
+void Shader::setUniform(UniformHandle<matrix4x4f> handle, const matrix4x4f& value) {
+    if (handle.isValid())
+        glUniformMatrix4fv(handle.location, 1, GL_FALSE, value.as_array.data());
+}
+
+void Shader::setUniform(UniformName name, const int& value) {
+    if (auto uniform = findUniform(name))
+        glUniform1i(uniform->location, value);
+}
+
+void Shader::setUniform(UniformName name, const float& value) {
+    if (auto uniform = findUniform(name))
+        glUniform1f(uniform->location, value);
+}
+
+void Shader::setUniform(UniformName name, const vector4f& value) {
+    if (auto uniform = findUniform(name))
+        glUniform4fv(uniform->location, 1, value.as_array.data());
+}
+
+void Shader::setUniform(UniformName name, const matrix4x4f& value) {
+    if (auto uniform = findUniform(name))
+        glUniformMatrix4fv(uniform->location, 1, GL_FALSE, value.as_array.data());
 }
 
 void Shader::loadData(const FileNode* file) {
@@ -115,60 +227,94 @@ void Shader::loadData(const FileNode* file) {
     std::ifstream metaFile(library->getAssetsRoot() / file->path);
     json meta = json::parse(metaFile);
 
-    std::filesystem::path vertexShaderFilename   = meta["vert"].template get<std::string>();
-    std::filesystem::path fragmentShaderFilename = meta["frag"].template get<std::string>();
+    // Compute shaders stand alone
+    if (meta.contains("comp")) {
+        std::filesystem::path computeShaderFilename = meta["comp"].template get<std::string>();
+        library->formatPath(&computeShaderFilename);
+
+        if (!std::filesystem::exists(library->getAssetsRoot() / computeShaderFilename)) {
+            cinder::error("Compute shader file not found: " + computeShaderFilename.string());
+            return;
+        }
+
+        std::ifstream computeShaderFile(library->getAssetsRoot() / computeShaderFilename);
 
-    if (vertexShaderFilename.empty() || fragmentShaderFilename.empty()) {
+        m_data = std::make_unique<ShaderData>();
+        m_data->computeShaderSource = std::string(
+            (std::istreambuf_iterator<char>(computeShaderFile)),
+            std::istreambuf_iterator<char>()
+        );
+
+        m_runtimeResource = false;
+        cinder::log("Loaded compute shader data from file: " + file->path.string());
+        return;
+    }
+
+    // The fragment stage is optional, depth-only programs (like shadow casters) leave it out
+    std::filesystem::path vertexShaderFilename   = meta.value("vert", std::string());
+    std::filesystem::path fragmentShaderFilename = meta.value("frag", std::string());
+
+    if (vertexShaderFilename.empty()) {
         cinder::error("Shader file not found in meta file.");
         return;
     }
 
     library->formatPath(&vertexShaderFilename);
-    library->formatPath(&fragmentShaderFilename);
-
     if (!std::filesystem::exists(library->getAssetsRoot() / vertexShaderFilename)) {
         cinder::error("Vertex shader file not found: " + vertexShaderFilename.string());
         return;
     }
-    if (!std::filesystem::exists(library->getAssetsRoot() / fragmentShaderFilename)) {
-        cinder::error("Fragment shader file not found: " + fragmentShaderFilename.string());
-        return;
-    }
 
-    std::ifstream vertexShaderFile  (library->getAssetsRoot() / vertexShaderFilename);
-    std::ifstream fragmentShaderFile(library->getAssetsRoot() / fragmentShaderFilename);
+    std::ifstream vertexShaderFile(library->getAssetsRoot() / vertexShaderFilename);
 
     m_data = std::make_unique<ShaderData>();
     m_data->vertexShaderSource = std::string(
         (std::istreambuf_iterator<char>(vertexShaderFile)),
         std::istreambuf_iterator<char>()
     );
-    m_data->fragmentShaderSource = std::string(
-        (std::istreambuf_iterator<char>(fragmentShaderFile)),
-        std::istreambuf_iterator<char>()
-    );
+
+    if (!fragmentShaderFilename.empty()) {
+        library->formatPath(&fragmentShaderFilename);
+        if (!std::filesystem::exists(library->getAssetsRoot() / fragmentShaderFilename)) {
+            cinder::error("Fragment shader file not found: " + fragmentShaderFilename.string());
+            m_data.reset();
+            return;
+        }
+
+        std::ifstream fragmentShaderFile(library->getAssetsRoot() / fragmentShaderFilename);
+        m_data->fragmentShaderSource = std::string(
+            (std::istreambuf_iterator<char>(fragmentShaderFile)),
+            std::istreambuf_iterator<char>()
+        );
+    }
+
+    m_data->instancing = meta.value("instancing", false);
 
     m_runtimeResource = false;
     cinder::log("Loaded shader data from file: " + file->path.string());
 }
 
-void Shader::loadResource() {
-    int success;
-    char infoLog[512];
-
-    if (m_initialized) {
-        cinder::warn("Shader program already initialized.");
-        return;
+/**
+ * @brief Inserts a define right after the version directive of a shader source.
+ */
+static std::string injectDefine(const std::string& source, const std::string& define) {
+    // Missing stages stay missing
+    if (source.empty()) {
+        return source;
     }
 
-    if (m_data == nullptr) {
-        cinder::error("Shader data is null.");
-        return;
+    const std::string directive = "#define " + define + "\n";
+    const size_t versionEnd = source.starts_with("#version") ? source.find('\n') : std::string::npos;
+    if (versionEnd == std::string::npos) {
+        return directive + source;
     }
+    return source.substr(0, versionEnd + 1) + directive + source.substr(versionEnd + 1);
+}
+
+unsigned int Shader::compileProgram(const std::string& vertexShaderSource, const std::string& fragmentShaderSource) {
+    int success;
+    char infoLog[512];
 
-    auto vertexShaderSource = m_data->vertexShaderSource;
-    auto fragmentShaderSource = m_data->fragmentShaderSource;
-    
     auto vertexShaderHandle = glCreateShader(GL_VERTEX_SHADER);
     const char* vertexSource = vertexShaderSource.c_str();
     glShaderSource(vertexShaderHandle, 1, &vertexSource, NULL);
@@ -181,52 +327,109 @@ void Shader::loadResource() {
         cinder::warn(infoLog);
     }
     
-    auto fragmentShaderHandle = glCreateShader(GL_FRAGMENT_SHADER);
-    const char* fragmentSource = fragmentShaderSource.c_str();
-    glShaderSource(fragmentShaderHandle, 1, &fragmentSource, NULL);
-    glCompileShader(fragmentShaderHandle);
+    // Without a fragment stage only depth is written
+    unsigned int fragmentShaderHandle = 0;
+    if (!fragmentShaderSource.empty()) {
+        fragmentShaderHandle = glCreateShader(GL_FRAGMENT_SHADER);
+        const char* fragmentSource = fragmentShaderSource.c_str();
+        glShaderSource(fragmentShaderHandle, 1, &fragmentSource, NULL);
+        glCompileShader(fragmentShaderHandle);
+
+        glGetShaderiv(fragmentShaderHandle, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            glGetShaderInfoLog(fragmentShaderHandle, 512, NULL, infoLog);
+            cinder::warn("Fragment shader compilation failed...");
+            cinder::warn(infoLog);
+        }
+    }
+
+    auto programHandle = glCreateProgram();
+    glAttachShader(programHandle, vertexShaderHandle);
+    if (fragmentShaderHandle != 0) {
+        glAttachShader(programHandle, fragmentShaderHandle);
+    }
+    glLinkProgram(programHandle);
+
+    glGetProgramiv(programHandle, GL_LINK_STATUS, &success);
+
+    if (!success) {
+        glGetProgramInfoLog(programHandle, 512, NULL, infoLog);
+        cinder::warn("Shader program linking failed...");
+        cinder::warn(infoLog);
+    }
+
+    glDeleteShader(vertexShaderHandle);
+    if (fragmentShaderHandle != 0) {
+        glDeleteShader(fragmentShaderHandle);
+    }
 
-    glGetShaderiv(fragmentShaderHandle, GL_COMPILE_STATUS, &success);
+    return programHandle;
+}
+
+unsigned int Shader::compileComputeProgram(const std::string& computeShaderSource) {
+    int success;
+    char infoLog[512];
+
+    auto computeShaderHandle = glCreateShader(GL_COMPUTE_SHADER);
+    const char* computeSource = computeShaderSource.c_str();
+    glShaderSource(computeShaderHandle, 1, &computeSource, NULL);
+    glCompileShader(computeShaderHandle);
+
+    glGetShaderiv(computeShaderHandle, GL_COMPILE_STATUS, &success);
     if (!success) {
-        glGetShaderInfoLog(fragmentShaderHandle, 512, NULL, infoLog);
-        cinder::warn("Fragment shader compilation failed...");
+        glGetShaderInfoLog(computeShaderHandle, 512, NULL, infoLog);
+        cinder::warn("Compute shader compilation failed...");
         cinder::warn(infoLog);
     }
 
-    m_programHandle = glCreateProgram();
-    glAttachShader(m_programHandle, vertexShaderHandle);
-    glAttachShader(m_programHandle, fragmentShaderHandle);
-    glLinkProgram(m_programHandle);
+    auto programHandle = glCreateProgram();
+    glAttachShader(programHandle, computeShaderHandle);
+    glLinkProgram(programHandle);
 
-    glGetProgramiv(m_programHandle, GL_LINK_STATUS, &success);
+    glGetProgramiv(programHandle, GL_LINK_STATUS, &success);
 
     if (!success) {
-        glGetProgramInfoLog(m_programHandle, 512, NULL, infoLog);
-        cinder::warn("Shader program linking failed...");
+        glGetProgramInfoLog(programHandle, 512, NULL, infoLog);
+        cinder::warn("Compute program linking failed...");
         cinder::warn(infoLog);
     }
 
-    glDeleteShader(vertexShaderHandle);
-    glDeleteShader(fragmentShaderHandle);
+    glDeleteShader(computeShaderHandle);
 
-    cinder::log("Shader program created.");
-    m_initialized = true;
-    m_data.reset();
+    return programHandle;
 }
 
-unsigned int Shader::getUniformLocation(const std::string& name) {
-    auto it = m_uniformLocations.find(name);
-    if (it != m_uniformLocations.end()) {
-        if (it->second == -1) {
-            it->second = -2;
-            return -1;
-        }
-        return it->second;
+void Shader::loadResource() {
+    if (m_initialized) {
+        cinder::warn("Shader program already initialized.");
+        return;
     }
 
-    const unsigned int location = glGetUniformLocation(m_programHandle, name.c_str());
-    m_uniformLocations[name] = location;
-    return location;
+    if (m_data == nullptr) {
+        cinder::error("Shader data is null.");
+        return;
+    }
+
+    m_compute = !m_data->computeShaderSource.empty();
+    m_programHandle = m_compute ?
+        compileComputeProgram(m_data->computeShaderSource) :
+        compileProgram(m_data->vertexShaderSource, m_data->fragmentShaderSource);
+    reflectUniforms();
+
+    if (m_data->instancing) {
+        m_instancedVariant = std::make_unique<Shader>();
+        m_instancedVariant->m_programHandle = compileProgram(
+            injectDefine(m_data->vertexShaderSource, "INSTANCED"),
+            injectDefine(m_data->fragmentShaderSource, "INSTANCED")
+        );
+        m_instancedVariant->reflectUniforms();
+        m_instancedVariant->m_initialized = true;
+        cinder::log("Instanced shader variant created.");
+    }
+
+    cinder::log("Shader program created.");
+    m_initialized = true;
+    m_data.reset();
 }
 
 } // namespace codex
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include "cinder.hpp"
+#include "codex/streamBuffer.hpp"
+#include "renderDevice.hpp"
+
+#include <glad.h>
+
+#include <format>
+
+namespace codex {
+
+StreamBuffer::StreamBuffer(size_t frameSize) : m_frameSize(frameSize), m_requestedFrameSize(frameSize) {
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    m_uniformAlignment = SDL_max(alignment, 1);
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    m_storageAlignment = SDL_max(alignment, 1);
+
+    m_frameSize = m_requestedFrameSize = alignFrameSize(frameSize);
+    create();
+}
+
+StreamBuffer::~StreamBuffer() {
+    destroy();
+}
+
+size_t StreamBuffer::alignFrameSize(size_t size) const {
+    const size_t alignment = SDL_max(m_uniformAlignment, m_storageAlignment);
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+void StreamBuffer::create() {
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    const size_t size = m_frameSize * FRAME_COUNT;
+
+    glCreateBuffers(1, &m_bufferHandle);
+    glNamedBufferStorage(m_bufferHandle, size, nullptr, flags);
+    m_mapped = static_cast<std::byte*>(glMapNamedBufferRange(m_bufferHandle, 0, size, flags));
+
+    if (m_mapped == nullptr) {
+        cinder::error("Couldn't map the stream buffer.");
+    }
+    cinder::log(std::format("Stream buffer created, {} KB per frame.", m_frameSize / 1024));
+}
+
+void StreamBuffer::destroy() {
+    for (uint32_t frame = 0; frame < FRAME_COUNT; frame++) {
+        waitForFence(frame);
+    }
+
+    if (m_bufferHandle != 0) {
+        glUnmapNamedBuffer(m_bufferHandle);
+        cinder::RenderDevice::deleteBuffer(m_bufferHandle);
+    }
+    m_bufferHandle = 0;
+    m_mapped = nullptr;
+}
+
+void StreamBuffer::waitForFence(uint32_t frame) {
+    GLsync& fence = m_fences[frame];
+    if (fence == nullptr) {
+        return;
+    }
+
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED) {
+        m_stallCount++;
+        do {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000);
+        } while (result == GL_TIMEOUT_EXPIRED);
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void StreamBuffer::beginFrame() {
+    if (m_requestedFrameSize > m_frameSize) {
+        destroy();
+        m_frameSize = m_requestedFrameSize;
+        create();
+    }
+
+    m_frame = (m_frame + 1) % FRAME_COUNT;
+    m_offset = 0;
+    waitForFence(m_frame);
+}
+
+void StreamBuffer::endFrame() {
+    if (m_fences[m_frame] != nullptr) {
+        glDeleteSync(m_fences[m_frame]);
+    }
+    m_fences[m_frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+StreamAllocation StreamBuffer::allocate(size_t size, uint32_t target) {
+    const size_t alignment = target == GL_UNIFORM_BUFFER ? m_uniformAlignment : m_storageAlignment;
+    const size_t offset = (m_offset + alignment - 1) / alignment * alignment;
+
+    if (m_mapped == nullptr || offset + size > m_frameSize) {
+        if (m_requestedFrameSize < (offset + size) * 2) {
+            m_requestedFrameSize = alignFrameSize((offset + size) * 2);
+            cinder::warn("Stream buffer frame region is full, growing it from the next frame.");
+        }
+        return {};
+    }
+
+    m_offset = offset + size;
+
+    const size_t bufferOffset = m_frame * m_frameSize + offset;
+    return { m_mapped + bufferOffset, m_bufferHandle, bufferOffset, size };
+}
+
+}; // namespace codex
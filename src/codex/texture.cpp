@@ -1,11 +1,14 @@
 #include "cinder.hpp"
 #include "codex/texture.hpp"
 #include "codex/library.hpp"
+#include "renderDevice.hpp"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 #include <glad.h>
 
+#include <cmath>
+
 namespace codex {
 
 TextureData::~TextureData() { 
@@ -33,7 +36,7 @@ Texture::Texture(const vector4f& color) : Texture(nullptr, 1, 1, 4) {
         static_cast<unsigned char>(SDL_clamp(color.z, 0.0f, 1.0f) * 255.0f),
         static_cast<unsigned char>(SDL_clamp(color.w, 0.0f, 1.0f) * 255.0f)
     };
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    glTextureSubImage2D(m_textureHandle, 0, 0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
 }
 
 Texture::Texture() {
@@ -41,7 +44,7 @@ Texture::Texture() {
 }
 
 Texture::~Texture() {
-    glDeleteTextures(1, &m_textureHandle);
+    cinder::RenderDevice::deleteTexture(m_textureHandle);
 
     cinder::log("Texture destroyed.");
 }
@@ -83,8 +86,9 @@ void Texture::loadResource() {
         return;
     }
 
-    glGenTextures(1, &m_textureHandle);
-    glBindTexture(GL_TEXTURE_2D, m_textureHandle);
+    // Created instead of generated, so it can be bound by unit right away
+    glCreateTextures(GL_TEXTURE_2D, 1, &m_textureHandle);
+    cinder::RenderDevice::bindTexture(0, m_textureHandle);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SRGB_DECODE_EXT, GL_SKIP_DECODE_EXT);
 
     this->m_width    = m_data->width;
@@ -97,6 +101,8 @@ void Texture::loadResource() {
     unsigned int type = m_highPrecision ? GL_FLOAT : GL_UNSIGNED_BYTE;
     glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, m_data->width, m_data->height,
                  0, GL_RGBA, type, empty ? NULL : m_data->pixels);
+    m_internalFormat = internalFormat;
+    m_levels = empty ? 1 : static_cast<int>(std::floor(std::log2(SDL_max(m_width, m_height)))) + 1;
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -111,28 +117,29 @@ void Texture::loadResource() {
     glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &success);
     if (success == 0) {
         cinder::error("Failed to create texture on GPU.");
-        glDeleteTextures(1, &m_textureHandle);
+        cinder::RenderDevice::deleteTexture(m_textureHandle);
         m_textureHandle = 0;
         return;
     }
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+    cinder::RenderDevice::bindTexture(0, 0);
 
     this->m_initialized = true;
     this->m_data.reset(); // We don't need the data anymore
 }
 
 void Texture::bind(int slot) const {
-    glActiveTexture(GL_TEXTURE0 + slot);
-    glBindTexture(GL_TEXTURE_2D, m_textureHandle);
+    cinder::RenderDevice::bindTexture(slot, m_textureHandle);
 }
 
 void Texture::resize(int width, int height) {
-    glBindTexture(GL_TEXTURE_2D, m_textureHandle);
+    cinder::RenderDevice::bindTexture(0, m_textureHandle);
     unsigned int internalFormat = m_highPrecision ? (m_channels == 1 ? GL_R16F : GL_RGBA16F) : (m_channels == 1 ? GL_R8 : GL_RGBA8);
     unsigned int type = m_highPrecision ? GL_FLOAT : GL_UNSIGNED_BYTE;
     glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, GL_RGBA, type, NULL);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    cinder::RenderDevice::bindTexture(0, 0);
+    m_internalFormat = internalFormat;
+    m_levels = 1;
 }
 
 void Texture::attachToFramebuffer(int attachment) {
@@ -115,6 +115,10 @@ vector4f vector4f::operator-() const {
     return vector4f(_mm_sub_ps(_mm_setzero_ps(), simd));
 }
 
+vector4f vector4f::lerp(const vector4f& from, const vector4f& to, float t) {
+    return vector4f(_mm_add_ps(from.simd, _mm_mul_ps(_mm_sub_ps(to.simd, from.simd), _mm_set1_ps(t))));
+}
+
 vector4f vector4f::operator*(const matrix4x4f& matrix) const {
     vector4f result;
 
@@ -215,6 +219,36 @@ matrix4x4f matrix4x4f::transpose() const {
     return result;
 }
 
+matrix4x4f matrix4x4f::inverse() const {
+    const auto& m = as_array;
+    std::array<float, 16> inv;
+
+    // Cofactor expansion
+    inv[0]  =  m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+    inv[4]  = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+    inv[8]  =  m[4] * m[9]  * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+    inv[12] = -m[4] * m[9]  * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+    inv[1]  = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+    inv[5]  =  m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+    inv[9]  = -m[0] * m[9]  * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+    inv[13] =  m[0] * m[9]  * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+    inv[2]  =  m[1] * m[6]  * m[15] - m[1] * m[7]  * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7]  - m[13] * m[3] * m[6];
+    inv[6]  = -m[0] * m[6]  * m[15] + m[0] * m[7]  * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7]  + m[12] * m[3] * m[6];
+    inv[10] =  m[0] * m[5]  * m[15] - m[0] * m[7]  * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7]  - m[12] * m[3] * m[5];
+    inv[14] = -m[0] * m[5]  * m[14] + m[0] * m[6]  * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6]  + m[12] * m[2] * m[5];
+    inv[3]  = -m[1] * m[6]  * m[11] + m[1] * m[7]  * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9]  * m[2] * m[7]  + m[9]  * m[3] * m[6];
+    inv[7]  =  m[0] * m[6]  * m[11] - m[0] * m[7]  * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8]  * m[2] * m[7]  - m[8]  * m[3] * m[6];
+    inv[11] = -m[0] * m[5]  * m[11] + m[0] * m[7]  * m[9]  + m[4] * m[1] * m[11] - m[4] * m[3] * m[9]  - m[8]  * m[1] * m[7]  + m[8]  * m[3] * m[5];
+    inv[15] =  m[0] * m[5]  * m[10] - m[0] * m[6]  * m[9]  - m[4] * m[1] * m[10] + m[4] * m[2] * m[9]  + m[8]  * m[1] * m[6]  - m[8]  * m[2] * m[5];
+
+    const float determinant = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+    if (SDL_fabsf(determinant) < FLT_EPSILON) {
+        return identity();
+    }
+
+    return matrix4x4f(inv) * (1.0f / determinant);
+}
+
 matrix4x4f matrix4x4f::operator+(const matrix4x4f& other) const {
     matrix4x4f result;
 
@@ -287,20 +321,57 @@ transformf::transformf(const vector4f& position, const vector4f& rotation, const
 }
 
 void transformf::moveBy(const vector4f& movement) {
+    beginChange();
     m_position += movement;
-    m_dirty = true;
+    markDirty();
 }
 
 void transformf::rotateBy(const vector4f& rotationAxis, radians angle) {
+    beginChange();
     m_rotation += rotationAxis * angle;
-    m_dirty = true;
+    markDirty();
 }
 
 void transformf::scaleBy(const vector4f& scale) {
+    beginChange();
     m_scale.x *= scale.x;
     m_scale.y *= scale.y;
     m_scale.z *= scale.z;
-    m_dirty = true;
+    markDirty();
+}
+
+matrix4x4f transformf::composeModelMatrix(const vector4f& position, const vector4f& rotation, const vector4f& scale) {
+    matrix4x4f translationMatrix = matrix4x4f::translation(position);
+    matrix4x4f rotationMatrixX   = matrix4x4f::rotation(rotation.x, vector4f::right());
+    matrix4x4f rotationMatrixY   = matrix4x4f::rotation(rotation.y, vector4f::up());
+    matrix4x4f rotationMatrixZ   = matrix4x4f::rotation(rotation.z, vector4f::front());
+    matrix4x4f scaleMatrix       = matrix4x4f::scale(scale);
+
+    return (scaleMatrix * rotationMatrixZ * rotationMatrixY * rotationMatrixX * translationMatrix);
+}
+
+bool transformf::isMovingThisTick() const {
+    return m_previousTick == s_simulationTick || (m_parent != nullptr && m_parent->isMovingThisTick());
+}
+
+matrix4x4f transformf::getInterpolatedModelMatrix(float alpha) {
+    // Not moved during the last tick, nothing to interpolate
+    if (alpha >= 1.0f || !isMovingThisTick()) {
+        return getModelMatrix();
+    }
+
+    const bool moved = m_previousTick == s_simulationTick;
+    matrix4x4f result = moved ? composeModelMatrix(
+        vector4f::lerp(m_previousPosition, m_position, alpha),
+        vector4f::lerp(m_previousRotation, m_rotation, alpha),
+        vector4f::lerp(m_previousScale   , m_scale   , alpha)
+    ) : composeModelMatrix(m_position, m_rotation, m_scale);
+
+    if (m_parent) {
+        result = m_parent->getInterpolatedModelMatrix(alpha) * result;
+    }
+
+    return result;
 }
 
 matrix4x4f& transformf::getModelMatrix() {
@@ -308,13 +379,7 @@ matrix4x4f& transformf::getModelMatrix() {
         return m_modelMatrix;
     }
 
-    matrix4x4f translationMatrix = matrix4x4f::translation(m_position);
-    matrix4x4f rotationMatrixX   = matrix4x4f::rotation(m_rotation.x, vector4f::right());
-    matrix4x4f rotationMatrixY   = matrix4x4f::rotation(m_rotation.y, vector4f::up());
-    matrix4x4f rotationMatrixZ   = matrix4x4f::rotation(m_rotation.z, vector4f::front());
-    matrix4x4f scaleMatrix       = matrix4x4f::scale(m_scale);
-
-    this->m_modelMatrix = (scaleMatrix * rotationMatrixZ * rotationMatrixY * rotationMatrixX * translationMatrix);
+    this->m_modelMatrix = composeModelMatrix(m_position, m_rotation, m_scale);
 
     if (m_parent) {
         this->m_modelMatrix = m_parent->getModelMatrix() * this->m_modelMatrix;
@@ -323,4 +388,62 @@ matrix4x4f& transformf::getModelMatrix() {
     m_dirty = false;
 
     return this->m_modelMatrix;
+}
+
+// Boundsf
+
+vector4f boundsf::center() const {
+    vector4f result = (min + max) * 0.5f;
+    result.w = 1.0f;
+    return result;
+}
+
+vector4f boundsf::extents() const {
+    vector4f result = (max - min) * 0.5f;
+    result.w = 0.0f;
+    return result;
+}
+
+float boundsf::radius() const {
+    return extents().length3d();
+}
+
+void boundsf::expand(const vector4f& point) {
+    min.simd = _mm_min_ps(min.simd, point.simd);
+    max.simd = _mm_max_ps(max.simd, point.simd);
+    min.w = 0.0f;
+    max.w = 0.0f;
+}
+
+void boundsf::merge(const boundsf& other) {
+    if (!other.isValid()) {
+        return;
+    }
+
+    min.simd = _mm_min_ps(min.simd, other.min.simd);
+    max.simd = _mm_max_ps(max.simd, other.max.simd);
+}
+
+boundsf boundsf::transformed(const matrix4x4f& matrix) const {
+    if (!isValid()) {
+        return *this;
+    }
+
+    // Arvo's method: the new extents are the old ones projected on the absolute rotation/scale part
+    const vector4f oldCenter  = center();
+    const vector4f oldExtents = extents();
+
+    const vector4f newCenter = oldCenter * matrix;
+    vector4f newExtents;
+    for (int i = 0; i < 3; i++) {
+        newExtents.as_array[i] = SDL_fabsf(matrix.as_array_rows[i][0]) * oldExtents.x +
+                                 SDL_fabsf(matrix.as_array_rows[i][1]) * oldExtents.y +
+                                 SDL_fabsf(matrix.as_array_rows[i][2]) * oldExtents.z;
+    }
+    newExtents.w = 0.0f;
+
+    boundsf result(newCenter - newExtents, newCenter + newExtents);
+    result.min.w = 0.0f;
+    result.max.w = 0.0f;
+    return result;
 }
\ No newline at end of file
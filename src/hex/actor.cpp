@@ -7,11 +7,103 @@ namespace hex {
 
 static uint32_t s_actorID = 0;
 
+/**
+ * @brief Free list allocator handing out actor sized blocks from large chunks.
+ */
+class ActorPool {
+public:
+    static constexpr size_t BLOCKS_PER_CHUNK = 256;
+
+    void* allocate() {
+        if (m_freeList == nullptr) {
+            grow();
+        }
+
+        FreeBlock* block = m_freeList;
+        m_freeList = block->next;
+        return block;
+    }
+
+    void release(void* pointer) {
+        FreeBlock* block = static_cast<FreeBlock*>(pointer);
+        block->next = m_freeList;
+        m_freeList = block;
+    }
+protected:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+    static constexpr size_t BLOCK_SIZE = sizeof(Actor) > sizeof(FreeBlock) ? sizeof(Actor) : sizeof(FreeBlock);
+
+    std::vector<std::unique_ptr<std::byte[]>> m_chunks;
+    FreeBlock* m_freeList = nullptr;
+
+    void grow() {
+        // Actors are never over-aligned, the default alignment of new is enough
+        auto chunk = std::make_unique<std::byte[]>(BLOCK_SIZE * BLOCKS_PER_CHUNK);
+        for (size_t i = BLOCKS_PER_CHUNK; i > 0; i--) {
+            release(chunk.get() + (i - 1) * BLOCK_SIZE);
+        }
+        m_chunks.push_back(std::move(chunk));
+    }
+};
+
+// Never destroyed, actors owned by static objects may outlive any static pool
+static ActorPool* s_actorPool = new ActorPool();
+
+void* Actor::operator new(size_t size) {
+    if (size != sizeof(Actor)) {
+        return ::operator new(size);
+    }
+    return s_actorPool->allocate();
+}
+
+void Actor::operator delete(void* pointer, size_t size) {
+    if (pointer == nullptr) {
+        return;
+    }
+    if (size != sizeof(Actor)) {
+        ::operator delete(pointer);
+        return;
+    }
+    s_actorPool->release(pointer);
+}
+
+Actor::Actor(Actor* parent, const Actor& prototype) {
+    m_enabled = prototype.m_enabled;
+    m_static  = prototype.m_static;
+    m_staticBatch = prototype.m_staticBatch;
+    m_editorExpanded = false;
+    m_name    = prototype.m_name;
+
+    m_parent = parent;
+    if (m_parent != nullptr)
+        m_parent->m_children.push_back(this);
+
+    s_hierarchyRevision++;
+
+    m_components.reserve(prototype.m_components.size());
+    for (const auto& component : prototype.m_components) {
+        auto copy = component->clone(this);
+        if (copy == nullptr) {
+            cinder::warn("Component can't be copied: " + component->getPrettyName());
+            continue;
+        }
+        m_components.push_back(std::move(copy));
+    }
+
+    // Every component exists now, dependencies can be resolved
+    for (const auto& component : m_components) {
+        component->onParentChanged();
+    }
+}
+
 Actor::Actor(Actor* parent) {
     m_parent = parent;
     if (m_parent != nullptr)
         m_parent->addChild(this);
     cinder::log("Actor created.");
+    s_hierarchyRevision++;
 
     m_name.resize(64);
     snprintf(m_name.data(), m_name.capacity(), "Actor_%03d", s_actorID++);
@@ -20,28 +112,27 @@ Actor::Actor(Actor* parent) {
 Actor::~Actor() {
     m_children.clear();
     m_components.clear();
-    cinder::log("Actor destroyed.");
+    s_hierarchyRevision++;
+
+    if (!s_suppressDestroyMessage) {
+        cinder::log("Actor destroyed... extra messages suppressed.");
+        s_suppressDestroyMessage = true;
+    }
 }
 
-void Actor::update() {
+void Actor::render(const prism::View& view) {
     if (!m_enabled) {
         return;
     }
 
-    for (const auto& component : m_components) {
-        if (component->isEnabled())
-            component->update();
-    }
-}
-
-void Actor::render(codex::Shader* overrideShader) {
-    if (!m_enabled) {
+    if ((view.actorFilter == prism::ActorFilter::STATIC_ONLY  && !m_static) ||
+        (view.actorFilter == prism::ActorFilter::DYNAMIC_ONLY &&  m_static)) {
         return;
     }
 
     for (const auto& component : m_components) {
         if (component->isEnabled())
-            component->render(overrideShader);
+            component->render(view);
     }
 }
 
@@ -53,6 +144,7 @@ void Actor::addChild(Actor* actor) {
 
     m_children.push_back(actor);
     actor->setParent(this);
+    s_hierarchyRevision++;
 }
 
 void Actor::removeChild(Actor* actor) {
@@ -64,6 +156,7 @@ void Actor::removeChild(Actor* actor) {
     for (auto it = m_children.begin(); it != m_children.end(); ++it) {
         if (*it == actor) {
             m_children.erase(it);
+            s_hierarchyRevision++;
             return;
         }
     }
@@ -73,6 +166,7 @@ void Actor::removeChild(Actor* actor) {
 
 void Actor::setParent(Actor* actor) {
     m_parent = actor;
+    s_hierarchyRevision++;
 
     for (const auto& component : m_components) {
         component->onParentChanged();
@@ -87,10 +181,13 @@ void Actor::editorUI() {
     }
     ImGui::SameLine();
     ImGui::SetNextItemWidth(-0.001f);
-    ImGui::InputText("##actor_name", m_name.data(), m_name.capacity(), ImGuiInputTextFlags_EnterReturnsTrue);
+    if (ImGui::InputText("##actor_name", m_name.data(), m_name.capacity(), ImGuiInputTextFlags_EnterReturnsTrue)) {
+        s_hierarchyRevision++;
+    }
     ImGui::Separator();
 
     ImGui::Text("Parent actor: %s", (m_parent != nullptr) ? m_parent->m_name.c_str() : "None");
+    ImGui::Checkbox("Static", &m_static);
     ImGui::Separator();
 
     auto availableSpace = ImGui::GetContentRegionAvail();
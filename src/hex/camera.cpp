@@ -10,19 +10,19 @@ Camera::Camera(CameraViewport viewport, float fieldOfView, vector4f position, ve
 
     this->m_position = position;
     this->m_rotation = rotation;
+    this->storePreviousState();
     
     this->updateProjectionMatrix();
 }
 
 Camera::Camera(float left, float right, float bottom, float top, float nearPlane, float farPlane) {
-    this->m_isOrthographic = true;
-    this->m_viewport = {0.0f, 0.0f, right - left, top - bottom};
     this->m_fieldOfView = 0.0f;
 
     this->m_position = vector4f::zero();
     this->m_rotation = vector4f::zero();
+    this->storePreviousState();
 
-    this->m_projection = matrix4x4f::orthographic(left, right, bottom, top, nearPlane, farPlane);
+    this->setOrthographic(left, right, bottom, top, nearPlane, farPlane);
 }
 
 Camera::Camera(CameraViewport viewport): Camera(viewport, 80.0f, vector4f::zero(), vector4f::zero()) {}
@@ -46,9 +46,33 @@ void Camera::update(CameraInput& input, float deltaTime, float mouseSensitivity)
     input.rotation.pitch = 0.0f;
 }
 
+void Camera::storePreviousState() {
+    this->m_previousPosition = this->m_position;
+    this->m_previousRotation = this->m_rotation;
+}
+
+vector4f Camera::getInterpolatedPosition() const {
+    if (m_interpolation >= 1.0f)
+        return m_position;
+
+    return vector4f::lerp(m_previousPosition, m_position, m_interpolation);
+}
+
+vector4f Camera::getInterpolatedRotation() const {
+    if (m_interpolation >= 1.0f)
+        return m_rotation;
+
+    // The yaw wraps around at +-PI, interpolate along the shorter arc
+    vector4f previous = m_previousRotation;
+    if (m_rotation.y - previous.y >  SDL_PI_F) previous.y += 2.0f * SDL_PI_F;
+    if (m_rotation.y - previous.y < -SDL_PI_F) previous.y -= 2.0f * SDL_PI_F;
+
+    return vector4f::lerp(previous, m_rotation, m_interpolation);
+}
+
 void Camera::updateViewMatrix() {
-    this->m_translation = matrix4x4f::translation(this->m_position * -1.0f);
-    this->m_lookAt      = matrix4x4f::lookAt(this->m_rotation);
+    this->m_translation = matrix4x4f::translation(this->getInterpolatedPosition() * -1.0f);
+    this->m_lookAt      = matrix4x4f::lookAt(this->getInterpolatedRotation());
     this->m_view        = this->m_translation * this->m_lookAt;
 }
 
@@ -62,12 +86,21 @@ void Camera::updateProjectionMatrix() {
     if (this->m_isOrthographic)
         return; // TODO: make it changeable
 
-    this->m_projection = matrix4x4f::perspective(
+    this->m_unjitteredProjection = matrix4x4f::perspective(
         this->m_fieldOfView * (SDL_PI_F / 180.0f), 
         this->m_viewport.w / this->m_viewport.h, 
         0.5f,   
         100.0f //TODO: make configurable
     );
+    // Translating the clip space position moves it by the jitter times w, a constant offset after the divide
+    this->m_projection = this->m_unjitteredProjection * matrix4x4f::translation(this->m_jitter.x, this->m_jitter.y, 0.0f);
+}
+
+void Camera::setOrthographic(float left, float right, float bottom, float top, float nearPlane, float farPlane) {
+    this->m_isOrthographic = true;
+    this->m_viewport = {0.0f, 0.0f, right - left, top - bottom};
+    this->m_projection = matrix4x4f::orthographic(left, right, bottom, top, nearPlane, farPlane);
+    this->m_unjitteredProjection = this->m_projection;
 }
 
 matrix4x4f Camera::getProjectionMatrix() {
@@ -76,6 +109,18 @@ matrix4x4f Camera::getProjectionMatrix() {
     return this->m_projection;
 }
 
+void Camera::beginFrame(const vector4f& jitter) {
+    m_jitter = jitter;
+    updateViewMatrix();
+    updateProjectionMatrix();
+
+    // The first frame has nothing to move from
+    const matrix4x4f viewProjection = m_view * m_unjitteredProjection;
+    m_previousViewProjection = m_frameStarted ? m_viewProjection : viewProjection;
+    m_viewProjection = viewProjection;
+    m_frameStarted = true;
+}
+
 void Camera::updateForwardVector() {
     m_forward = vector4f::front() * m_lookAt;
 }
@@ -89,7 +134,11 @@ CameraUniformBufferData* Camera::getShaderBufferPointer() {
     updateViewMatrix();
     updateForwardVector();
 
-    return &m_shaderBufferData;
+    // The simulated position stays untouched, the shaders get the rendered one
+    m_interpolatedBufferData = m_shaderBufferData;
+    m_interpolatedBufferData.m_position = getInterpolatedPosition();
+
+    return &m_interpolatedBufferData;
 }
 
 void Camera::cameraWindow(bool separateWindow) {
@@ -106,14 +155,16 @@ void Camera::cameraWindow(bool separateWindow) {
 
     ImGui::TableNextColumn();
     ImGui::SetNextItemWidth(-0.001f);
-    ImGui::InputFloat3("##cam_pos", &this->m_position.x);
+    if (ImGui::InputFloat3("##cam_pos", &this->m_position.x))
+        this->m_previousPosition = this->m_position;
 
     ImGui::TableNextColumn();
     ImGui::Text("Rotation: ");
 
     ImGui::TableNextColumn();
     ImGui::SetNextItemWidth(-0.001f);
-    ImGui::InputFloat2("##cam_rot", &this->m_rotation.x);
+    if (ImGui::InputFloat2("##cam_rot", &this->m_rotation.x))
+        this->m_previousRotation = this->m_rotation;
 
     ImGui::TableNextColumn();
     ImGui::SetNextItemWidth(-0.001f);
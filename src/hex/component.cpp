@@ -1,8 +1,24 @@
 #include "hex/component.hpp"
+#include "hex/tickScheduler.hpp"
 #include "imgui.h"
 
 namespace hex {
 
+Actor* const Component::getActor() const {
+    return m_actor;
+}
+
+void Component::wake() {
+    if (!m_sleeping) {
+        return;
+    }
+
+    m_sleeping = false;
+    if (m_scheduler != nullptr && !m_inActiveList) {
+        m_scheduler->enqueueWake(this);
+    }
+}
+
 void Component::editorUI() {
     ImGui::Text("%s", getPrettyName().c_str());
     ImGui::Separator();
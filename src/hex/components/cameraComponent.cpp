@@ -1,5 +1,6 @@
 #include "hex/components/cameraComponent.hpp"
 #include "hex/actor.hpp"
+#include "renderDevice.hpp"
 #include "glad.h"
 
 namespace hex {
@@ -7,6 +8,7 @@ namespace hex {
 static unsigned int UNIFORM_BINDING_POINT = 0;
 
 CameraComponent::CameraComponent(Actor* actor, CameraViewport viewport, float fov, vector4f position, vector4f rotation) : Component(actor) {
+    m_tickGroup = TickGroup::PRE_PHYSICS;
     m_camera = std::make_unique<Camera>(viewport, fov, position, rotation);
     m_cameraUniformBuffer = std::make_unique<codex::UniformBuffer>(sizeof(CameraUniformBufferData), UNIFORM_BINDING_POINT++);
 
@@ -14,17 +16,31 @@ CameraComponent::CameraComponent(Actor* actor, CameraViewport viewport, float fo
 }
 
 CameraComponent::CameraComponent(Actor* actor, float left, float right, float bottom, float top, float nearPlane, float farPlane) : Component(actor) {
+    m_tickGroup = TickGroup::PRE_PHYSICS;
     m_camera = std::make_unique<Camera>(left, right, bottom, top, nearPlane, farPlane);
     m_cameraUniformBuffer = std::make_unique<codex::UniformBuffer>(sizeof(CameraUniformBufferData), UNIFORM_BINDING_POINT++);
 
     m_dependenciesFound = true;
 }
 
-void CameraComponent::update() {
+void CameraComponent::update(float deltaTime) {
+    m_camera->storePreviousState();
 
+    const bool idle = m_cameraInput.lock || (
+        m_cameraInput.movement.x == 0.0f && m_cameraInput.movement.y == 0.0f && m_cameraInput.movement.z == 0.0f &&
+        m_cameraInput.rotation.pitch == 0.0f && m_cameraInput.rotation.yaw == 0.0f
+    );
+
+    // Sleeps only after an idle tick, so the previous state caught up with the current one
+    if (idle) {
+        sleep();
+        return;
+    }
+
+    m_camera->update(m_cameraInput, deltaTime);
 }
 
-void CameraComponent::render(codex::Shader* overrideShader) {
+void CameraComponent::render(const prism::View& view) {
     if (m_camera->isOrtographic())
         return; // TODO: temporary fix, make a better solution later
 
@@ -37,11 +53,7 @@ void CameraComponent::render(codex::Shader* overrideShader) {
 void CameraComponent::resizeCamera(float width, float height) {
     m_camera->setViewport({0, 0, width, height});
     m_camera->updateProjectionMatrix();
-    glViewport(0, 0, width, height);
-}
-
-void CameraComponent::sendDebugCameraInput(float deltaTime) {
-    m_camera->update(m_cameraInput, deltaTime);
+    cinder::RenderDevice::setViewport(0, 0, width, height);
 }
 
 void CameraComponent::editorUI() {
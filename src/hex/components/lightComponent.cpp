@@ -0,0 +1,130 @@
+#include "hex/components/lightComponent.hpp"
+#include "hex/actor.hpp"
+
+#include "cinder.hpp"
+#include "imgui.h"
+
+#include <cmath>
+
+namespace hex {
+
+LightComponent::LightComponent(Actor* actor, prism::LightType type, vector4f color, float intensity, float range) : Component(actor) {
+    m_type      = type;
+    m_color     = color;
+    m_intensity = intensity;
+    m_range     = range;
+    m_tickGroup = TickGroup::NONE;
+
+    m_dependenciesFound = resolveDependencies();
+}
+
+LightComponent::LightComponent(Actor* actor, const LightComponent& other) : Component(actor) {
+    m_enabled    = other.m_enabled;
+    m_tickGroup  = TickGroup::NONE;
+    m_type       = other.m_type;
+    m_color      = other.m_color;
+    m_intensity  = other.m_intensity;
+    m_range      = other.m_range;
+    m_innerAngle = other.m_innerAngle;
+    m_outerAngle = other.m_outerAngle;
+}
+
+std::unique_ptr<Component> LightComponent::clone(Actor* actor) const {
+    return std::unique_ptr<Component>(new LightComponent(actor, *this));
+}
+
+void LightComponent::update(float deltaTime) {
+    // Nothing to do here
+}
+
+void LightComponent::render(const prism::View& view) {
+    if (view.lights == nullptr || m_transformComponent == nullptr) {
+        return;
+    }
+
+    const matrix4x4f modelMatrix = m_transformComponent->getTransform().getInterpolatedModelMatrix(view.interpolation);
+    const vector4f position  = vector4f(0.0f, 0.0f, 0.0f, 1.0f) * modelMatrix;
+    const vector4f direction = (vector4f::front() * modelMatrix).normalize3d();
+
+    if (m_type != prism::LightType::DIRECTIONAL && view.frustumCulling) {
+        const vector4f extent(m_range, m_range, m_range, 0.0f);
+        if (!view.frustum.intersects(boundsf(position - extent, position + extent))) {
+            return;
+        }
+    }
+
+    prism::LightData light;
+    light.positionRange = vector4f(position.x, position.y, position.z, m_range);
+    light.directionType = vector4f(direction.x, direction.y, direction.z, static_cast<float>(m_type));
+    light.color         = vector4f(m_color.x * m_intensity, m_color.y * m_intensity, m_color.z * m_intensity, 0.0f);
+    light.spotAngles    = vector4f(std::cos(m_innerAngle), std::cos(m_outerAngle), 0.0f, 0.0f);
+    view.lights->push_back(light);
+}
+
+bool LightComponent::resolveDependencies() {
+    m_transformComponent = m_actor->getComponent<TransformComponent>();
+    if (m_transformComponent == nullptr) {
+        cinder::warn("Light component requires a transform component.");
+        return false;
+    }
+    return true;
+}
+
+void LightComponent::onParentChanged() {
+    m_dependenciesFound = resolveDependencies();
+}
+
+void LightComponent::editorUI() {
+    if (!ImGui::BeginTable("##light_props", 2, ImGuiTableFlags_SizingStretchProp | ImGuiTableFlags_BordersInner)) {
+        return;
+    }
+
+    ImGui::TableNextColumn();
+    ImGui::Text("Type: ");
+    ImGui::TableNextColumn();
+    if (ImGui::RadioButton("Point", m_type == prism::LightType::POINT)) {
+        m_type = prism::LightType::POINT;
+    }
+    ImGui::SameLine();
+    if (ImGui::RadioButton("Spot", m_type == prism::LightType::SPOT)) {
+        m_type = prism::LightType::SPOT;
+    }
+    ImGui::SameLine();
+    if (ImGui::RadioButton("Directional", m_type == prism::LightType::DIRECTIONAL)) {
+        m_type = prism::LightType::DIRECTIONAL;
+    }
+
+    ImGui::TableNextColumn();
+    ImGui::Text("Color: ");
+    ImGui::TableNextColumn();
+    ImGui::SetNextItemWidth(-0.001f);
+    ImGui::ColorEdit3("##light_color", &m_color.x);
+
+    ImGui::TableNextColumn();
+    ImGui::Text("Intensity: ");
+    ImGui::TableNextColumn();
+    ImGui::SetNextItemWidth(-0.001f);
+    ImGui::InputFloat("##light_intensity", &m_intensity, 0.0f, 0.0f);
+
+    if (m_type != prism::LightType::DIRECTIONAL) {
+        ImGui::TableNextColumn();
+        ImGui::Text("Range: ");
+        ImGui::TableNextColumn();
+        ImGui::SetNextItemWidth(-0.001f);
+        ImGui::InputFloat("##light_range", &m_range, 0.0f, 0.0f);
+    }
+
+    if (m_type == prism::LightType::SPOT) {
+        ImGui::TableNextColumn();
+        ImGui::Text("Cone: ");
+        ImGui::TableNextColumn();
+        ImGui::SetNextItemWidth(-0.001f);
+        ImGui::SliderAngle("##light_inner", &m_innerAngle, 0.0f, 89.0f);
+        ImGui::SetNextItemWidth(-0.001f);
+        ImGui::SliderAngle("##light_outer", &m_outerAngle, 0.0f, 89.0f);
+    }
+
+    ImGui::EndTable();
+}
+
+}; // namespace hex
\ No newline at end of file
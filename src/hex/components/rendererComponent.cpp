@@ -9,7 +9,8 @@ namespace hex {
 RendererComponent::RendererComponent(Actor* actor, codex::Shader* shader, codex::Material* material, codex::Mesh* mesh) : Component(actor) {
     m_shader   = shader;
     m_material = material;
-    m_mesh     = mesh;
+    setMesh(mesh);
+    m_tickGroup = TickGroup::NONE;
 
     m_dependenciesFound = resolveDependencies();
 }
@@ -18,30 +19,200 @@ RendererComponent::RendererComponent(Actor* actor) : hex::RendererComponent(acto
     // Nothing to do here
 }
 
-void RendererComponent::update() {
+RendererComponent::RendererComponent(Actor* actor, const RendererComponent& other) : Component(actor) {
+    m_enabled       = other.m_enabled;
+    m_tickGroup     = TickGroup::NONE;
+    m_shader        = other.m_shader;
+    m_material      = other.m_material;
+    m_mesh          = other.m_mesh;
+    m_castShadows   = other.m_castShadows;
+
+    m_lodLevels     = other.m_lodLevels;
+    m_lodMode       = other.m_lodMode;
+    m_lodCrossFade  = other.m_lodCrossFade;
+    m_lodFadeRange  = other.m_lodFadeRange;
+    m_customLODs    = other.m_customLODs;
+    m_lodChainDirty = other.m_lodChainDirty;
+}
+
+RendererComponent::~RendererComponent() {
+    if (m_objectBuffer != nullptr) {
+        m_objectBuffer->release(m_objectSlot);
+    }
+}
+
+std::unique_ptr<Component> RendererComponent::clone(Actor* actor) const {
+    return std::unique_ptr<Component>(new RendererComponent(actor, *this));
+}
+
+std::vector<LODLevel>& RendererComponent::editLODLevels() {
+    if (m_lodLevels.use_count() > 1) {
+        m_lodLevels = std::make_shared<std::vector<LODLevel>>(*m_lodLevels);
+    }
+    return *m_lodLevels;
+}
+
+void RendererComponent::update(float deltaTime) {
     // Nothing to do here
 }
 
-void RendererComponent::render(codex::Shader* overrideShader) {
-    if (m_shader == nullptr || m_mesh == nullptr) {
+void RendererComponent::setMesh(codex::Mesh* mesh) {
+    m_mesh = mesh;
+    m_customLODs = false;
+    m_lodChainDirty = true;
+}
+
+void RendererComponent::setLODLevels(const std::vector<LODLevel>& levels) {
+    if (levels.empty()) {
+        cinder::warn("Tried setting an empty detail level chain.");
         return;
     }
 
-    if (!m_shader->isInitialized() || !m_mesh->isInitialized()) {
+    m_lodLevels = std::make_shared<std::vector<LODLevel>>(levels);
+    m_mesh = levels[0].mesh;
+    m_customLODs = true;
+    m_lodChainDirty = false;
+}
+
+const std::vector<LODLevel>& RendererComponent::resolveLODLevels() {
+    if (m_lodChainDirty) {
+        rebuildLODChain();
+    }
+    return *m_lodLevels;
+}
+
+void RendererComponent::rebuildLODChain() {
+    // The mesh loads asynchronously, its levels are only known once it's initialized
+    if (m_mesh == nullptr || !m_mesh->isInitialized()) {
         return;
     }
 
-    matrix4x4f& baseTransform = m_transformComponent->getTransform().getModelMatrix();
-    matrix4x4f& meshTransform = m_mesh->getTransform()->getModelMatrix();
+    auto levels = std::make_shared<std::vector<LODLevel>>();
+    levels->push_back({ m_mesh, 1.0f });
+
+    float threshold = m_lodMode == LODMode::SCREEN_SIZE ? 0.4f : 15.0f;
+    for (const auto& lod : m_mesh->getLODs()) {
+        levels->push_back({ lod, threshold });
+        threshold = m_lodMode == LODMode::SCREEN_SIZE ? threshold * 0.5f : threshold * 2.0f;
+    }
+
+    m_lodLevels = levels;
+    m_lodChainDirty = false;
+}
 
-    if (overrideShader == nullptr) {
-        m_shader->bind();
-        if (m_material != nullptr && m_material->isInitialized())
-            m_material->bindTextures(m_shader);
-        m_shader->setUniform("modelMatrix", baseTransform * meshTransform);
+int RendererComponent::selectLOD(const prism::View& view, const boundsf& worldBounds, float* fade) const {
+    *fade = 0.0f;
+
+    const auto& levels = *m_lodLevels;
+    const int count = static_cast<int>(levels.size());
+    if (count <= 1) {
+        return 0;
+    }
+
+    const bool screenSizeMode = m_lodMode == LODMode::SCREEN_SIZE;
+    const vector4f center = worldBounds.center();
+    const float metric = screenSizeMode ?
+        view.screenSize(center, worldBounds.radius()) :
+        view.distanceTo(center);
+
+    int level = 0;
+    for (int i = 1; i < count; i++) {
+        const bool coarser = screenSizeMode ?
+            metric < levels[i].threshold :
+            metric > levels[i].threshold;
+        if (!coarser) {
+            break;
+        }
+        level = i;
+    }
+
+    // The band is placed for the unbiased levels, biased views switch without fading
+    float nextFade = 0.0f;
+    if (m_lodCrossFade && view.lodCrossFade && view.lodBias == 0 && level + 1 < count) {
+        const float threshold = levels[level + 1].threshold;
+        if (screenSizeMode) {
+            const float bandStart = threshold * (1.0f + m_lodFadeRange);
+            nextFade = (bandStart - metric) / (bandStart - threshold);
+        } else {
+            const float bandStart = threshold * (1.0f - m_lodFadeRange);
+            nextFade = (metric - bandStart) / (threshold - bandStart);
+        }
+    }
+
+    level = SDL_clamp(level + view.lodBias, 0, count - 1);
+    if (nextFade > 0.0f && nextFade < 1.0f && level + 1 < count) {
+        *fade = nextFade;
+    }
+
+    return level;
+}
+
+void RendererComponent::pushLevel(const prism::View& view, int level, const matrix4x4f& modelMatrix, const matrix4x4f& previousModelMatrix, const boundsf& bounds, float depth, float fade) {
+    codex::Mesh* mesh = m_lodLevels->empty() ? m_mesh : (*m_lodLevels)[level].mesh;
+    if (mesh == nullptr || !mesh->isInitialized()) {
+        mesh = m_mesh;
+    }
+
+    prism::DrawPacket packet;
+    packet.modelMatrix = modelMatrix;
+    packet.previousModelMatrix = previousModelMatrix;
+    packet.mesh        = mesh;
+    packet.lodFade     = fade;
+    packet.objectIndex = m_objectSlot;
+    packet.bounds      = bounds;
+    if (view.overrideShader == nullptr) {
+        packet.shader   = m_shader;
+        packet.material = m_material;
     } else {
-        overrideShader->bind();
-        overrideShader->setUniform("modelMatrix", baseTransform * meshTransform);
+        packet.shader   = view.overrideShader;
+    }
+
+    view.queue->push(packet, view.pass, depth);
+}
+
+const matrix4x4f& RendererComponent::updateMotion(const prism::View& view, const matrix4x4f& modelMatrix) {
+    // Untracked views (like the shadow views) keep the history, they share the object buffer with the scene view
+    if (view.frame == 0) {
+        return m_motionFrame != 0 ? m_previousModelMatrix : modelMatrix;
+    }
+
+    if (view.frame != m_motionFrame) {
+        // Objects skipped for a frame (culled or disabled) start over without motion
+        m_previousModelMatrix = (m_motionFrame != 0 && m_motionFrame + 1 == view.frame) ? m_frameModelMatrix : modelMatrix;
+        m_frameModelMatrix = modelMatrix;
+        m_motionFrame = view.frame;
+    }
+    return m_previousModelMatrix;
+}
+
+void RendererComponent::updateObjectSlot(const prism::View& view, const matrix4x4f& modelMatrix, const matrix4x4f& previousModelMatrix) {
+    if (view.objects != m_objectBuffer) {
+        if (m_objectBuffer != nullptr) {
+            m_objectBuffer->release(m_objectSlot);
+        }
+        m_objectBuffer = view.objects;
+        m_objectSlot = m_objectBuffer != nullptr ? m_objectBuffer->allocate() : prism::ObjectBuffer::INVALID_SLOT;
+    }
+
+    if (m_objectBuffer == nullptr) {
+        return;
+    }
+
+    // Materials not (yet) in the table use the empty entry, their draws bind the textures directly
+    uint32_t materialIndex = m_material != nullptr ? m_material->getTableIndex() : 0;
+    if (materialIndex == codex::MaterialTable::NOT_RESIDENT) {
+        materialIndex = 0;
+    }
+    m_objectBuffer->update(m_objectSlot, modelMatrix, previousModelMatrix, materialIndex);
+}
+
+void RendererComponent::render(const prism::View& view) {
+    if (m_shader == nullptr || m_mesh == nullptr || view.queue == nullptr) {
+        return;
+    }
+
+    if (!m_shader->isInitialized() || !m_mesh->isInitialized()) {
+        return;
     }
 
     if (m_transformComponent == nullptr) {
@@ -49,11 +220,43 @@ void RendererComponent::render(codex::Shader* overrideShader) {
         return;
     }
 
-    m_mesh->draw();
+    if (view.pass == prism::PASS_SHADOW && !m_castShadows) {
+        return;
+    }
+
+    if (m_lodChainDirty) {
+        rebuildLODChain();
+    }
+
+    const matrix4x4f baseTransform = m_transformComponent->getTransform().getInterpolatedModelMatrix(view.interpolation);
+    matrix4x4f& meshTransform = m_mesh->getTransform()->getModelMatrix();
+    const matrix4x4f modelMatrix = baseTransform * meshTransform;
+
+    const boundsf worldBounds = m_mesh->getBounds().transformed(modelMatrix);
+    if (view.frustumCulling && worldBounds.isValid() && !view.frustum.intersects(worldBounds)) {
+        return;
+    }
+
+    const float depth = worldBounds.isValid() ? view.distanceTo(worldBounds.center()) : 0.0f;
+
+    const matrix4x4f& previousModelMatrix = updateMotion(view, modelMatrix);
+    updateObjectSlot(view, modelMatrix, previousModelMatrix);
+
+    float fade = 0.0f;
+    const int level = selectLOD(view, worldBounds, &fade);
+    m_lastLODLevel = level;
+
+    if (fade == 0.0f) {
+        pushLevel(view, level, modelMatrix, previousModelMatrix, worldBounds, depth, 0.0f);
+        return;
+    }
+
+    // Complementary dither patterns, the sum of the two levels covers every pixel once
+    pushLevel(view, level    , modelMatrix, previousModelMatrix, worldBounds, depth,  (1.0f - fade));
+    pushLevel(view, level + 1, modelMatrix, previousModelMatrix, worldBounds, depth, -(1.0f - fade));
 }
 
 bool RendererComponent::resolveDependencies() {
-    cinder::log("Resolving dependencies for renderer component.");
     m_transformComponent = m_actor->getComponent<TransformComponent>();
     if (m_transformComponent == nullptr) {
         cinder::warn("Renderer component requires a transform component.");
@@ -101,6 +304,47 @@ void RendererComponent::editorUI() {
         }
     }
 
+    ImGui::TableNextColumn();
+    ImGui::Text("Cast shadows: ");
+    ImGui::TableNextColumn();
+    ImGui::Checkbox("##cast_shadows", &m_castShadows);
+
+    ImGui::TableNextColumn();
+    ImGui::Text("LOD: ");
+    ImGui::TableNextColumn();
+    ImGui::Text("%d / %d", m_lastLODLevel, m_lodLevels->empty() ? 0 : static_cast<int>(m_lodLevels->size()) - 1);
+
+    ImGui::TableNextColumn();
+    ImGui::Text("LOD mode: ");
+    ImGui::TableNextColumn();
+    if (ImGui::RadioButton("Screen size", m_lodMode == LODMode::SCREEN_SIZE)) {
+        m_lodMode = LODMode::SCREEN_SIZE;
+        m_lodChainDirty = !m_customLODs;
+    }
+    ImGui::SameLine();
+    if (ImGui::RadioButton("Distance", m_lodMode == LODMode::DISTANCE)) {
+        m_lodMode = LODMode::DISTANCE;
+        m_lodChainDirty = !m_customLODs;
+    }
+
+    ImGui::TableNextColumn();
+    ImGui::Text("Cross-fade: ");
+    ImGui::TableNextColumn();
+    ImGui::Checkbox("##lod_crossfade", &m_lodCrossFade);
+
+    char label[32];
+    for (int i = 1; i < m_lodLevels->size(); i++) {
+        ImGui::TableNextColumn();
+        ImGui::Text("LOD %d: ", i);
+        ImGui::TableNextColumn();
+        ImGui::SetNextItemWidth(-0.001f);
+        snprintf(label, sizeof(label), "##lod_threshold_%d", i);
+        float threshold = (*m_lodLevels)[i].threshold;
+        if (ImGui::InputFloat(label, &threshold, 0.0f, 0.0f)) {
+            editLODLevels()[i].threshold = threshold;
+        }
+    }
+
     ImGui::EndTable();
 }
 
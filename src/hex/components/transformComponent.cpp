@@ -6,9 +6,21 @@
 namespace hex {
 
 TransformComponent::TransformComponent(Actor* actor) : Component(actor), m_transform() {
+    m_tickGroup = TickGroup::NONE;
     onParentChanged();
 }
 
+TransformComponent::TransformComponent(Actor* actor, const TransformComponent& other) : Component(actor), m_transform(other.m_transform) {
+    m_enabled = other.m_enabled;
+    m_tickGroup = TickGroup::NONE;
+    // The parent is set once the actor is complete
+    m_transform.setParent(nullptr);
+}
+
+std::unique_ptr<Component> TransformComponent::clone(Actor* actor) const {
+    return std::unique_ptr<Component>(new TransformComponent(actor, *this));
+}
+
 void TransformComponent::onParentChanged() {
     auto parent = m_actor->getParent();
     if (parent == nullptr) {
@@ -22,11 +34,11 @@ void TransformComponent::onParentChanged() {
     }
 }
 
-void TransformComponent::update() {
+void TransformComponent::update(float deltaTime) {
     // Nothing to do
 }
 
-void TransformComponent::render(codex::Shader* overrideShader) {
+void TransformComponent::render(const prism::View& view) {
     // Nothing to do
 }
 
@@ -1,5 +1,6 @@
 #include "cinder.hpp"
 #include "hex/framebuffer.hpp"
+#include "renderDevice.hpp"
 
 #include <glad.h>
 #include <math.h>
@@ -8,97 +9,73 @@ namespace hex {
 
 // Framebuffer
     
-Framebuffer::Framebuffer(int width, int height, bool depthOnly) 
-    : m_colorTarget(nullptr, width, height, depthOnly ? 1 : 4, true)
-{
+Framebuffer::Framebuffer(int width, int height, bool depthOnly) : m_depthOnly(depthOnly) {
     glGenFramebuffers(1, &m_framebufferHandle);
-    glBindFramebuffer(GL_FRAMEBUFFER, m_framebufferHandle);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SRGB_DECODE_EXT, GL_DECODE_EXT);
-
-    m_colorTarget.bind(0);
-    m_colorTarget.attachToFramebuffer(GL_COLOR_ATTACHMENT0);
-
-    glGenRenderbuffers(1, &m_depthStencilTarget);
-    glBindRenderbuffer(GL_RENDERBUFFER, m_depthStencilTarget);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depthStencilTarget);
+    cinder::RenderDevice::bindFramebuffer(GL_FRAMEBUFFER, m_framebufferHandle);
+
+    if (depthOnly) {
+        // Nothing is written but depth, the fragment stage can be skipped entirely
+        createDepthTexture(width, height);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+    } else {
+        m_colorTarget = std::make_unique<codex::Texture>(nullptr, width, height, 4, true);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SRGB_DECODE_EXT, GL_DECODE_EXT);
+
+        m_colorTarget->bind(0);
+        m_colorTarget->attachToFramebuffer(GL_COLOR_ATTACHMENT0);
+
+        glGenRenderbuffers(1, &m_depthStencilTarget);
+        glBindRenderbuffer(GL_RENDERBUFFER, m_depthStencilTarget);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depthStencilTarget);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    }
 
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
         cinder::error("Framebuffer is not complete!");
     }
     cinder::log("Created framebuffer.");
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    cinder::RenderDevice::bindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 Framebuffer::~Framebuffer() {
-    glDeleteFramebuffers(1, &m_framebufferHandle);
+    cinder::RenderDevice::deleteFramebuffer(m_framebufferHandle);
+    cinder::RenderDevice::deleteTexture(m_depthTexture);
     glDeleteRenderbuffers(1, &m_depthStencilTarget);
     cinder::log("Framebuffer destroyed.");
 }
 
+void Framebuffer::createDepthTexture(int width, int height) {
+    // Sampled through comparison samplers, the texture itself compares nothing, so it can be viewed too
+    glCreateTextures(GL_TEXTURE_2D, 1, &m_depthTexture);
+    glTextureStorage2D(m_depthTexture, 1, GL_DEPTH_COMPONENT16, width, height);
+    glTextureParameteri(m_depthTexture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTextureParameteri(m_depthTexture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(m_depthTexture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(m_depthTexture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glNamedFramebufferTexture(m_framebufferHandle, GL_DEPTH_ATTACHMENT, m_depthTexture, 0);
+}
+
 void Framebuffer::bind() {
-    glBindFramebuffer(GL_FRAMEBUFFER, m_framebufferHandle);
+    cinder::RenderDevice::bindFramebuffer(GL_FRAMEBUFFER, m_framebufferHandle);
 }
 
 void Framebuffer::unbind() {
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    cinder::RenderDevice::bindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void Framebuffer::resize(int width, int height) {
-    m_colorTarget.resize(width, height);
-
-    glBindRenderbuffer(GL_RENDERBUFFER, m_depthStencilTarget);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
-    glBindRenderbuffer(GL_RENDERBUFFER, 0);
-}
-
-// GBuffer
-
-GBuffer::GBuffer(int width, int height) 
-    : Framebuffer(width, height) 
-    , m_normalTarget(nullptr, width, height, 4, true)
-    , m_positionTarget(nullptr, width, height, 4, true)
-    , m_aoRoughnessMetallicTarget(nullptr, width, height, 4)
-{
-    glBindFramebuffer(GL_FRAMEBUFFER, m_framebufferHandle);
-
-    m_normalTarget.bind(1);
-    m_normalTarget.attachToFramebuffer(GL_COLOR_ATTACHMENT1);
-
-    m_positionTarget.bind(2);
-    m_positionTarget.attachToFramebuffer(GL_COLOR_ATTACHMENT2);
-
-    m_aoRoughnessMetallicTarget.bind(3);
-    m_aoRoughnessMetallicTarget.attachToFramebuffer(GL_COLOR_ATTACHMENT3);
-
-    GLenum attachments[6] = {
-        GL_COLOR_ATTACHMENT0, 
-        GL_COLOR_ATTACHMENT1, 
-        GL_COLOR_ATTACHMENT2, 
-        GL_COLOR_ATTACHMENT3,
-    };
-    glDrawBuffers(6, attachments);
-
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-        cinder::error("GBuffer is not complete!");
+    if (m_depthOnly) {
+        // The storage is immutable, the texture is replaced
+        cinder::RenderDevice::deleteTexture(m_depthTexture);
+        createDepthTexture(width, height);
+        return;
     }
-    cinder::log("Created GBuffer.");
-
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-}
-
-GBuffer::~GBuffer() {
-    // Base destructor will be called automatically
-    cinder::log("GBuffer destroyed.");
-}
 
-void GBuffer::resize(int width, int height) {
-    m_colorTarget.resize(width, height);
-    m_normalTarget.resize(width, height);
-    m_positionTarget.resize(width, height);
-    m_aoRoughnessMetallicTarget.resize(width, height);
+    m_colorTarget->resize(width, height);
 
     glBindRenderbuffer(GL_RENDERBUFFER, m_depthStencilTarget);
     glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
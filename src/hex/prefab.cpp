@@ -0,0 +1,54 @@
+#include "hex/prefab.hpp"
+#include "hex/scene.hpp"
+
+namespace hex {
+
+Prefab::Prefab(const Actor* source) {
+    if (source == nullptr) {
+        cinder::warn("Tried creating a prefab from a null actor.");
+        return;
+    }
+
+    capture(source, -1);
+    cinder::log("Prefab created from actor: " + source->getName());
+}
+
+void Prefab::capture(const Actor* source, int parentIndex) {
+    Actor* parent = parentIndex < 0 ? nullptr : m_prototypes[parentIndex].get();
+
+    const int index = static_cast<int>(m_prototypes.size());
+    m_prototypes.push_back(std::unique_ptr<Actor>(new Actor(parent, *source)));
+    m_parentIndices.push_back(parentIndex);
+
+    for (const Actor* child : source->getChildren()) {
+        capture(child, index);
+    }
+}
+
+std::vector<Actor*> Prefab::instantiate(Scene* scene, size_t count, Actor* parent) const {
+    std::vector<Actor*> roots;
+    if (scene == nullptr || m_prototypes.empty()) {
+        cinder::warn("Tried instantiating a prefab without a scene or actors.");
+        return roots;
+    }
+
+    roots.reserve(count);
+    std::vector<std::unique_ptr<Actor>> actors;
+    actors.reserve(count * m_prototypes.size());
+
+    std::vector<Actor*> copies(m_prototypes.size());
+    for (size_t instance = 0; instance < count; instance++) {
+        for (size_t i = 0; i < m_prototypes.size(); i++) {
+            Actor* copyParent = m_parentIndices[i] < 0 ? parent : copies[m_parentIndices[i]];
+            copies[i] = new Actor(copyParent, *m_prototypes[i]);
+            actors.emplace_back(copies[i]);
+        }
+        roots.push_back(copies[0]);
+    }
+
+    scene->addActors(actors);
+    cinder::log(std::format("Instantiated {} copies of prefab: {}", count, getRoot()->getName()));
+    return roots;
+}
+
+}; // namespace hex
@@ -1,8 +1,14 @@
 #include "hex/scene.hpp"
+#include "hex/components/rendererComponent.hpp"
+#include "hex/components/transformComponent.hpp"
 
 #include "imgui.h"
 #include <IconsMaterialSymbols.h>
 
+#include <cmath>
+#include <map>
+#include <tuple>
+
 namespace hex {
 
 Scene::Scene() {
@@ -13,16 +19,326 @@ Scene::~Scene() {
     
 }
 
-void Scene::update() {
+void Scene::update(float deltaTime) {
+    // Transforms snapshot themselves when first changed in the new tick
+    transformf::beginSimulationTick();
+
+    m_tickScheduler.update(m_actors, deltaTime);
+
+    if (m_staticBatchingPending) {
+        const bool timedOut = ++m_staticBatchingWait >= StaticBatchSettings::MAX_WAIT_UPDATES;
+        if (buildStaticBatches(timedOut)) {
+            m_staticBatchingPending = false;
+        }
+    }
+}
+
+void Scene::render(const prism::View& view) {
+    prism::View queuedView = view;
+    if (queuedView.queue == nullptr) {
+        queuedView.queue = &m_renderQueue;
+    }
+    queuedView.objects = &m_objectBuffer;
+
+    queuedView.queue->clear();
+    if (queuedView.lights != nullptr) {
+        queuedView.lights->clear();
+    }
     for (const auto& actor : m_actors) {
-        actor->update();
+        actor->render(queuedView);
     }
+
+    // Only the objects that moved since the last view are sent
+    m_objectBuffer.upload();
+    queuedView.queue->sort();
+    queuedView.queue->submit(queuedView);
 }
 
-void Scene::render(codex::Shader* overrideShader) {
+/**
+ * @brief Appends the transformed geometry of a mesh part to a batch.
+ */
+static void appendToBatch(codex::MeshPart* batch, const codex::MeshPart& source, uint32_t stride, const matrix4x4f& modelMatrix, const matrix4x4f& normalMatrix, bool hasDirections) {
+    const uint32_t baseVertex = batch->vertexCount;
+
+    for (uint32_t v = 0; v < source.vertexCount; v++) {
+        const float* vertex = &source.vertices[v * stride];
+        const size_t offset = batch->vertices.size();
+        batch->vertices.insert(batch->vertices.end(), vertex, vertex + stride);
+        float* out = &batch->vertices[offset];
+
+        const vector4f position = vector4f(out[0], out[1], out[2], 1.0f) * modelMatrix;
+        out[0] = position.x; out[1] = position.y; out[2] = position.z;
+        batch->bounds.expand(position);
+
+        if (!hasDirections) {
+            continue;
+        }
+
+        // Normal and tangent
+        for (int attribute = 3; attribute <= 6; attribute += 3) {
+            vector4f direction = vector4f(out[attribute], out[attribute + 1], out[attribute + 2], 0.0f) * normalMatrix;
+            direction.w = 0.0f;
+            const float length = direction.length3d();
+            if (length > 0.0f) {
+                direction = direction / length;
+            }
+            out[attribute] = direction.x; out[attribute + 1] = direction.y; out[attribute + 2] = direction.z;
+        }
+    }
+
+    for (const uint32_t index : source.indices) {
+        batch->indices.push_back(baseVertex + index);
+    }
+
+    batch->vertexCount += source.vertexCount;
+    batch->indexCount  += source.indexCount;
+}
+
+bool Scene::buildStaticBatches(bool skipUnloaded) {
+    // A part of the mesh, with its counterparts in the detail levels
+    struct Entry {
+        std::vector<codex::Mesh*> parts;
+        const matrix4x4f* modelMatrix;
+        uint32_t renderer;  // Index into renderers
+        std::vector<codex::MeshPart> sources;
+    };
+    // Renderers only share a batch if they select and fade their levels the same way
+    struct LODKey {
+        std::vector<float> thresholds;
+        LODMode mode;
+        bool crossFade;
+        float fadeRange;
+
+        auto operator<=>(const LODKey&) const = default;
+    };
+    using GroupKey = std::tuple<codex::Shader*, codex::Material*, bool, LODKey, int, int, int>;
+    std::map<GroupKey, std::vector<Entry>> groups;
+
+    std::vector<RendererComponent*> renderers;
+    std::vector<std::unique_ptr<matrix4x4f>> modelMatrices;
+    int skippedMeshes = 0, mismatchedLODs = 0;
+
     for (const auto& actor : m_actors) {
-        actor->render(overrideShader);
+        if (!actor->isStatic() || !actor->isEnabled() || actor->isStaticBatch()) {
+            continue;
+        }
+
+        auto renderer  = actor->getComponent<RendererComponent>(true);
+        auto transform = actor->getComponent<TransformComponent>(true);
+        if (renderer == nullptr || transform == nullptr || !renderer->isEnabled()) {
+            continue;
+        }
+
+        codex::Mesh* mesh = renderer->getMesh();
+        if (mesh == nullptr || renderer->getShader() == nullptr) {
+            continue;
+        }
+        if (!mesh->isInitialized()) {
+            if (!skipUnloaded) {
+                return false;
+            }
+            skippedMeshes++;
+            continue;
+        }
+        if (mesh->getParts().empty()) {
+            continue;
+        }
+
+        // Every level has to be made of the same parts, like the generated ones are
+        const std::vector<LODLevel>& levels = renderer->resolveLODLevels();
+        LODKey lodKey = { {}, renderer->getLODMode(), renderer->isLODCrossFadeEnabled(), renderer->getLODFadeRange() };
+        bool matchingLODs = true;
+        for (size_t level = 1; level < levels.size(); level++) {
+            const codex::Mesh* lod = levels[level].mesh;
+            if (lod != nullptr && !lod->isInitialized()) {
+                if (!skipUnloaded) {
+                    return false;
+                }
+                skippedMeshes++;
+                matchingLODs = false;
+                break;
+            }
+            if (lod == nullptr || lod->getParts().size() != mesh->getParts().size()) {
+                matchingLODs = false;
+                mismatchedLODs++;
+                break;
+            }
+            lodKey.thresholds.push_back(levels[level].threshold);
+        }
+        if (!matchingLODs) {
+            continue;
+        }
+        if (lodKey.thresholds.empty()) {
+            lodKey = { {}, LODMode::SCREEN_SIZE, false, 0.0f };
+        }
+
+        const matrix4x4f modelMatrix = transform->getTransform().getModelMatrix() * mesh->getTransform()->getModelMatrix();
+        modelMatrices.push_back(std::make_unique<matrix4x4f>(modelMatrix));
+        renderers.push_back(renderer);
+
+        // Clustered by part, a single imported mesh may span the whole scene
+        const auto& parts = mesh->getParts();
+        for (size_t i = 0; i < parts.size(); i++) {
+            const boundsf worldBounds = parts[i]->getBounds().transformed(modelMatrix);
+            const vector4f center = worldBounds.isValid() ? worldBounds.center() : vector4f::zero();
+
+            const GroupKey key = {
+                renderer->getShader(), renderer->getMaterial(), renderer->isCastingShadows(), lodKey,
+                static_cast<int>(std::floor(center.x / StaticBatchSettings::CELL_SIZE)),
+                static_cast<int>(std::floor(center.y / StaticBatchSettings::CELL_SIZE)),
+                static_cast<int>(std::floor(center.z / StaticBatchSettings::CELL_SIZE))
+            };
+
+            Entry entry = { { parts[i] }, modelMatrices.back().get(), static_cast<uint32_t>(renderers.size() - 1), {} };
+            for (size_t level = 1; level < levels.size(); level++) {
+                entry.parts.push_back(levels[level].mesh->getParts()[i]);
+            }
+            groups[key].push_back(std::move(entry));
+        }
+    }
+
+    // Only reached once, the request is done after this
+    if (skippedMeshes > 0) {
+        cinder::warn(std::format("Static batching left out {} meshes that didn't load in time.", skippedMeshes));
+    }
+    if (mismatchedLODs > 0) {
+        cinder::warn(std::format("Static batching left out {} meshes with detail levels not made of the same parts.", mismatchedLODs));
+    }
+
+    if (groups.empty()) {
+        return true;
+    }
+
+    // Renderers with a part that can't be merged keep drawing on their own, so
+    // every part is read before any of them goes into a batch
+    std::vector<bool> incomplete(renderers.size(), false);
+    int totalParts = 0;
+
+    for (auto& [key, entries] : groups) {
+        const uint32_t stride = codex::Layout::calculateStride(entries[0].parts[0]->getLayout());
+        for (Entry& entry : entries) {
+            totalParts++;
+            entry.sources.resize(entry.parts.size());
+            for (size_t level = 0; level < entry.parts.size(); level++) {
+                if (codex::Layout::calculateStride(entry.parts[level]->getLayout()) != stride) {
+                    cinder::warn("Skipped a mesh part with a different vertex layout while batching.");
+                    incomplete[entry.renderer] = true;
+                    break;
+                }
+                if (!entry.parts[level]->readVertexData(&entry.sources[level])) {
+                    incomplete[entry.renderer] = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    static uint32_t s_batchID = 0;
+    int mergedParts = 0, batchCount = 0;
+
+    for (auto& [key, entries] : groups) {
+        const std::vector<float>& thresholds = std::get<3>(key).thresholds;
+        const size_t levelCount = thresholds.size() + 1;
+
+        std::vector<std::unique_ptr<codex::MeshPart>> batches;
+        for (size_t level = 0; level < levelCount; level++) {
+            batches.push_back(std::make_unique<codex::MeshPart>());
+            batches.back()->vertexCount = 0;
+            batches.back()->indexCount  = 0;
+        }
+
+        std::vector<codex::Layout> layout = entries[0].parts[0]->getLayout();
+        const uint32_t stride = codex::Layout::calculateStride(layout) / sizeof(float);
+        const bool hasDirections = layout.size() >= 3 &&
+            layout[0].getType() == codex::Layout::FLOAT3 &&
+            layout[1].getType() == codex::Layout::FLOAT3 &&
+            layout[2].getType() == codex::Layout::FLOAT3;
+
+        std::vector<uint32_t> batchedRenderers;  // Of the parts in the batch
+
+        auto flush = [&]() {
+            if (batches[0]->indexCount == 0) {
+                return;
+            }
+
+            // The levels are selected for the whole batch, from its own bounds
+            const uint32_t batchID = s_batchID++;
+            const std::string name = std::format("static_batch_{:0>3}", batchID);
+            std::vector<LODLevel> levels;
+            for (size_t level = 0; level < levelCount; level++) {
+                const std::string meshName = level == 0 ? name + ".mesh" : std::format("{}_lod{}.mesh", name, level);
+                codex::Mesh* batchMesh = codex::Mesh::createRuntimeMesh(batches[level].get(), layout, meshName);
+                if (batchMesh == nullptr) {
+                    levels.clear();
+                    break;
+                }
+                levels.push_back({ batchMesh, level == 0 ? 1.0f : thresholds[level - 1] });
+            }
+
+            if (!levels.empty()) {
+                Actor* batchActor = newActor();
+                batchActor->setName(name);
+                batchActor->setStatic(true);
+                batchActor->setStaticBatch(true);
+                batchActor->addComponent<TransformComponent>();
+                batchActor->addComponent<RendererComponent>(std::get<0>(key), std::get<1>(key), levels[0].mesh);
+                auto renderer = batchActor->getComponent<RendererComponent>();
+                renderer->setCastShadows(std::get<2>(key));
+                if (levels.size() > 1) {
+                    renderer->setLODMode(std::get<3>(key).mode);
+                    renderer->setLODCrossFade(std::get<3>(key).crossFade, std::get<3>(key).fadeRange);
+                    renderer->setLODLevels(levels);
+                }
+                batchCount++;
+            } else {
+                // Their other parts may already be in a batch, drawing them twice beats not at all
+                for (const uint32_t renderer : batchedRenderers) {
+                    incomplete[renderer] = true;
+                }
+            }
+
+            batchedRenderers.clear();
+            for (auto& batch : batches) {
+                batch = std::make_unique<codex::MeshPart>();
+                batch->vertexCount = 0;
+                batch->indexCount  = 0;
+            }
+        };
+
+        for (Entry& entry : entries) {
+            if (incomplete[entry.renderer]) {
+                continue;
+            }
+            // The full detail level is always the largest
+            if (batches[0]->vertexCount + entry.sources[0].vertexCount > StaticBatchSettings::MAX_VERTICES) {
+                flush();
+            }
+
+            const matrix4x4f normalMatrix = entry.modelMatrix->inverse().transpose();
+            for (size_t level = 0; level < levelCount; level++) {
+                appendToBatch(batches[level].get(), entry.sources[level], stride, *entry.modelMatrix, normalMatrix, hasDirections);
+            }
+            batchedRenderers.push_back(entry.renderer);
+            mergedParts++;
+
+            // The batches hold their own copies now
+            entry.sources.clear();
+        }
+        flush();
     }
+
+    // The batches now draw the geometry of the complete ones
+    uint32_t disabledRenderers = 0;
+    for (uint32_t i = 0; i < renderers.size(); i++) {
+        if (!incomplete[i]) {
+            renderers[i]->setEnabled(false);
+            disabledRenderers++;
+        }
+    }
+
+    cinder::log(std::format("Static batching merged {} parts of {} actors into {} batches, skipped {} parts ({} actors keep drawing on their own).",
+        mergedParts, disabledRenderers, batchCount, totalParts - mergedParts, renderers.size() - disabledRenderers));
+    return true;
 }
 
 Actor* Scene::newActor() {
@@ -31,6 +347,14 @@ Actor* Scene::newActor() {
     return actor;
 }
 
+void Scene::addActors(std::vector<std::unique_ptr<Actor>>& actors) {
+    m_actors.reserve(m_actors.size() + actors.size());
+    for (auto& actor : actors) {
+        m_actors.push_back(std::move(actor));
+    }
+    actors.clear();
+}
+
 void Scene::removeActor(Actor* actor) {
     for (auto it = m_actors.begin(); it != m_actors.end(); ++it) {
         if (it->get() == actor) {
@@ -40,22 +364,110 @@ void Scene::removeActor(Actor* actor) {
     }
 }
 
-char buffer[64];
-void Scene::drawActorTree(Actor* actor, int depth) {
-    if (actor == nullptr) {
+/**
+ * @brief Case insensitive substring search.
+ * 
+ * @param text The text to search in
+ * @param lowercasePattern The pattern to search for, already in lowercase
+ */
+static bool containsIgnoreCase(const char* text, const std::string& lowercasePattern) {
+    const size_t length = SDL_strlen(text);
+    if (lowercasePattern.size() > length) {
+        return false;
+    }
+
+    for (size_t start = 0; start + lowercasePattern.size() <= length; start++) {
+        size_t i = 0;
+        while (i < lowercasePattern.size() && SDL_tolower(text[start + i]) == lowercasePattern[i]) {
+            i++;
+        }
+        if (i == lowercasePattern.size()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Scene::rebuildHierarchyRows() {
+    std::string filter = m_hierarchyFilter;
+    for (char& character : filter) {
+        character = static_cast<char>(SDL_tolower(character));
+    }
+
+    const uint64_t revision = Actor::getHierarchyRevision();
+    const bool hierarchyChanged = revision != m_hierarchyRowsRevision;
+    if (!hierarchyChanged && filter == m_lastHierarchyFilter) {
         return;
     }
 
-    for (int i = 0; i < depth; i++) {
-        ImGui::Text(" ");
-        ImGui::SameLine();
+    m_hierarchyRows.clear();
+
+    if (filter.empty()) {
+        m_filterMatches.clear();
+
+        // Depth first, only descending into expanded actors
+        std::vector<std::pair<Actor*, int>> stack;
+        for (auto it = m_actors.rbegin(); it != m_actors.rend(); ++it) {
+            if ((*it)->getParent() == nullptr)
+                stack.push_back({ it->get(), 0 });
+        }
+
+        while (!stack.empty()) {
+            auto [actor, depth] = stack.back();
+            stack.pop_back();
+
+            const auto& children = actor->getChildren();
+            m_hierarchyRows.push_back({ actor, depth, !children.empty(), actor->getName().c_str() });
+
+            if (!actor->isEditorExpanded())
+                continue;
+
+            for (auto it = children.rbegin(); it != children.rend(); ++it) {
+                stack.push_back({ *it, depth + 1 });
+            }
+        }
+    } else {
+        // A longer filter containing the previous one can only match a subset of the previous matches
+        const bool narrowing = !hierarchyChanged && !m_lastHierarchyFilter.empty() &&
+                               filter.find(m_lastHierarchyFilter) != std::string::npos;
+
+        std::vector<Actor*> candidates;
+        if (narrowing) {
+            candidates.swap(m_filterMatches);
+        } else {
+            candidates.reserve(m_actors.size());
+            for (const auto& actor : m_actors) {
+                candidates.push_back(actor.get());
+            }
+        }
+
+        m_filterMatches.clear();
+        for (Actor* actor : candidates) {
+            if (containsIgnoreCase(actor->getName().c_str(), filter)) {
+                m_filterMatches.push_back(actor);
+            }
+        }
+
+        // Matches are listed flat, regardless of their parents being collapsed
+        m_hierarchyRows.reserve(m_filterMatches.size());
+        for (Actor* actor : m_filterMatches) {
+            m_hierarchyRows.push_back({ actor, 0, false, actor->getName().c_str() });
+        }
     }
 
-    auto children = actor->getChildren();
-    if (!children.empty()) {
+    m_hierarchyRowsRevision = revision;
+    m_lastHierarchyFilter = filter;
+}
+
+void Scene::drawHierarchyRow(const HierarchyRow& row) {
+    Actor* actor = row.actor;
+    ImGui::PushID(actor);
+
+    ImGui::SetCursorPosX(ImGui::GetCursorPosX() + row.depth * ImGui::GetFontSize());
+
+    if (row.hasChildren) {
         auto expanded = actor->isEditorExpanded();
-        snprintf(buffer, 64, "%s##%p", expanded ? ICON_MS_KEYBOARD_ARROW_DOWN : ICON_MS_KEYBOARD_ARROW_RIGHT, actor);
-        if (ImGui::Button(buffer)) {
+        if (ImGui::Button(expanded ? ICON_MS_KEYBOARD_ARROW_DOWN : ICON_MS_KEYBOARD_ARROW_RIGHT)) {
             actor->setEditorExpanded(!expanded);
         }
     } else {
@@ -63,35 +475,38 @@ void Scene::drawActorTree(Actor* actor, int depth) {
     }
     ImGui::SameLine();
 
-    snprintf(buffer, 64, "%s##%p", actor->isEnabled() ? ICON_MS_CHECK_BOX : ICON_MS_CHECK_BOX_OUTLINE_BLANK, actor);
-    if (ImGui::Button(buffer)) {
+    if (ImGui::Button(actor->isEnabled() ? ICON_MS_CHECK_BOX : ICON_MS_CHECK_BOX_OUTLINE_BLANK)) {
         actor->setEnabled(!actor->isEnabled());
     }
     ImGui::SameLine();
 
-    snprintf(buffer, 64, "%s##%p", actor->getName().c_str(), actor);
-    if (ImGui::Button(buffer, ImVec2(-0.1f, 0))) {
+    if (ImGui::Button(row.label.c_str(), ImVec2(-0.1f, 0))) {
         m_selectedActor = actor;
     }
 
-    if (!actor->isEditorExpanded())
-        return;
-
-    for (const auto& child : children) {
-        drawActorTree(child, depth + 1);
-    }
+    ImGui::PopID();
 }
 
 void Scene::editorUI() {
     ImGui::Begin("Scene", nullptr);
 
+    ImGui::SetNextItemWidth(-0.001f);
+    ImGui::InputText("##hierarchy_filter", m_hierarchyFilter, sizeof(m_hierarchyFilter));
+
     auto availableSpace = ImGui::GetContentRegionAvail();
     ImGui::BeginChild("Tree", ImVec2(0, availableSpace.y * 0.4f), ImGuiChildFlags_Border);
 
-    for (const auto& actor : m_actors) {
-        if (actor->getParent() == nullptr)
-            drawActorTree(actor.get());
+    rebuildHierarchyRows();
+
+    // Only the rows in view are submitted
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(m_hierarchyRows.size()));
+    while (clipper.Step()) {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+            drawHierarchyRow(m_hierarchyRows[i]);
+        }
     }
+    clipper.End();
 
     ImGui::EndChild();
 
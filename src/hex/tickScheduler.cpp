@@ -0,0 +1,145 @@
+#include "hex/tickScheduler.hpp"
+#include "hex/actor.hpp"
+#include "hex/components/transformComponent.hpp"
+
+namespace hex {
+
+const char* TickScheduler::getGroupName(TickGroup group) {
+    switch (group) {
+        case TickGroup::PRE_PHYSICS: return "Pre-physics";
+        case TickGroup::UPDATE:      return "Update";
+        case TickGroup::POST_UPDATE: return "Post-update";
+        case TickGroup::ON_DEMAND:   return "On demand";
+        default:                     return "None";
+    }
+}
+
+void TickScheduler::rebuild(const std::vector<std::unique_ptr<Actor>>& actors) {
+    for (auto& group : m_groups) {
+        group.clear();
+    }
+    m_wokenComponents.clear();
+    m_transformWatches.clear();
+    m_sleepingCount = 0;
+
+    std::array<uint32_t, GROUP_COUNT> registered = {};
+
+    for (const auto& actor : actors) {
+        for (const auto& component : actor->getComponents()) {
+            if (component->m_tickGroup == TickGroup::NONE) {
+                continue;
+            }
+
+            const size_t group = static_cast<size_t>(component->m_tickGroup);
+            component->m_scheduler = this;
+            // Spread the components ticking every Nth tick evenly between the ticks
+            component->m_tickPhase = registered[group]++ % component->m_tickInterval;
+            component->m_inActiveList = false;
+
+            if (component->m_sleeping) {
+                putToSleep(component.get());
+                continue;
+            }
+
+            component->m_inActiveList = true;
+            m_groups[group].push_back(component.get());
+        }
+    }
+
+    for (size_t group = 0; group < GROUP_COUNT; group++) {
+        m_stats[group].registered = registered[group];
+    }
+
+    m_revision = Component::getTickRevision();
+}
+
+void TickScheduler::putToSleep(Component* component) {
+    component->m_inActiveList = false;
+    m_sleepingCount++;
+
+    if (!component->m_wakeOnTransformChange) {
+        return;
+    }
+
+    auto transform = component->getActor()->getComponent<TransformComponent>(true);
+    if (transform != nullptr) {
+        m_transformWatches.push_back({ component, &transform->getTransform(), transform->getTransform().getVersion() });
+    }
+}
+
+void TickScheduler::wakeWatched() {
+    for (size_t i = 0; i < m_transformWatches.size();) {
+        auto& watch = m_transformWatches[i];
+
+        const bool moved = watch.transform->getVersion() != watch.version;
+        if (moved) {
+            watch.component->wake();
+        }
+
+        // Woken by the transform, or by something else
+        if (!watch.component->m_sleeping) {
+            watch = m_transformWatches.back();
+            m_transformWatches.pop_back();
+            continue;
+        }
+        i++;
+    }
+}
+
+void TickScheduler::update(const std::vector<std::unique_ptr<Actor>>& actors, float deltaTime) {
+    if (m_revision != Component::getTickRevision()) {
+        rebuild(actors);
+    }
+
+    wakeWatched();
+
+    for (Component* component : m_wokenComponents) {
+        if (component->m_sleeping || component->m_inActiveList) {
+            continue;
+        }
+
+        component->m_inActiveList = true;
+        m_sleepingCount--;
+        m_groups[static_cast<size_t>(component->m_tickGroup)].push_back(component);
+    }
+    m_wokenComponents.clear();
+
+    for (size_t group = 0; group < GROUP_COUNT; group++) {
+        const uint64_t startTime = SDL_GetTicksNS();
+        const bool onDemand = group == static_cast<size_t>(TickGroup::ON_DEMAND);
+
+        auto& components = m_groups[group];
+        auto& stats = m_stats[group];
+        stats.active = static_cast<uint32_t>(components.size());
+        stats.ticked = 0;
+
+        for (size_t i = 0; i < components.size();) {
+            Component* component = components[i];
+
+            const bool due = (m_tickCount + component->m_tickPhase) % component->m_tickInterval == 0;
+            if (!component->m_sleeping && due && component->isEnabled() && component->getActor()->isEnabled()) {
+                // Goes back to sleep after the tick, unless it asks for another one
+                if (onDemand) {
+                    component->m_sleeping = true;
+                }
+
+                component->update(deltaTime * component->m_tickInterval);
+                stats.ticked++;
+            }
+
+            if (component->m_sleeping) {
+                components[i] = components.back();
+                components.pop_back();
+                putToSleep(component);
+                continue;
+            }
+            i++;
+        }
+
+        stats.time = (SDL_GetTicksNS() - startTime) * 0.000'001;
+    }
+
+    m_tickCount++;
+}
+
+}; // namespace hex
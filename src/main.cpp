@@ -1,15 +1,27 @@
 #include "app.hpp"
 #include "cinder.hpp"
 #include "floatmath.hpp"
+#include "renderDevice.hpp"
 
 #include "hex/components/cameraComponent.hpp"
 #include "hex/components/rendererComponent.hpp"
 #include "hex/components/transformComponent.hpp"
+#include "hex/components/lightComponent.hpp"
 #include "hex/framebuffer.hpp"
 #include "hex/camera.hpp"
 #include "hex/scene.hpp"
 #include "hex/actor.hpp"
 
+#include "prism/view.hpp"
+#include "prism/cascadedShadows.hpp"
+#include "prism/renderGraph.hpp"
+#include "prism/tiledLighting.hpp"
+#include "prism/depthPrepass.hpp"
+#include "prism/occlusionCulling.hpp"
+#include "prism/dynamicResolution.hpp"
+#include "prism/temporalAA.hpp"
+#include "prism/gpuProfiler.hpp"
+
 #include "echo/ui.hpp"
 #include "echo/event.hpp"
 #include "echo/console.hpp"
@@ -53,26 +65,47 @@ CameraComponent* activeCameraComponent = nullptr;
 // TODO: make it part of prism (rendering module)
 typedef struct { int x, y; float dpi; } windowStruct;
 windowStruct lastFrameWindowSize{100, 100, 1.0f};
-std::unique_ptr<GBuffer> sceneFramebuffer = nullptr;
-std::unique_ptr<Framebuffer> combinedFramebuffer = nullptr;
+prism::RenderGraph renderGraph;
+std::string renderOutput = "display";  // The graph resource shown in the render window
+bool slimGBuffer = true;               // Reconstructs the position from depth, with packed normals
 
-Camera* lightCamera = nullptr;
-std::unique_ptr<Framebuffer> shadowCastingFramebuffer = nullptr;
+Camera* lightCamera = nullptr; // Only its rotation is used, the cascades are fitted to the view
+constexpr int SHADOW_LOD_BIAS = 1;
+constexpr uint32_t SHADOW_CASCADES = 4;
+constexpr int SHADOW_CASCADE_SIZE = 1024;
+constexpr float SHADOW_DISTANCE = 60.0f;
+std::unique_ptr<prism::CascadedShadows> cascadedShadows = nullptr;
 
 codex::Mesh *quadMesh = nullptr;
 codex::Shader *combineShader = nullptr;
 codex::Shader *shadowShader = nullptr;
-double shadowLastTime = 0.0;
+codex::Shader *lightCullingShader = nullptr;
+codex::Shader *depthPrepassShader = nullptr;
+codex::Shader *depthPyramidShader = nullptr;
+codex::Shader *occlusionCullingShader = nullptr;
+codex::Shader *upscaleShader = nullptr;
+codex::Shader *temporalAAShader = nullptr;
+
+prism::TiledLighting tiledLighting;
+int spawnedLights = 0;
+
+prism::RenderQueue sceneQueue;
+prism::DepthPrepass depthPrepass;
+prism::OcclusionCulling occlusionCulling;
+prism::DynamicResolution dynamicResolution;
+prism::TemporalAA temporalAA;
+prism::GPUProfiler gpuProfiler;
+uint64_t frameNumber = 0;
 
 codex::Mesh *skyboxMesh = nullptr;
 codex::Shader *skyboxShader = nullptr;
 codex::Texture *skyboxTexture = nullptr;
 
 void initGLParams() {
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
-    glFrontFace(GL_CCW);
+    RenderDevice::setEnabled(GL_DEPTH_TEST, true);
+    RenderDevice::setEnabled(GL_CULL_FACE, true);
+    RenderDevice::setCullFace(GL_BACK);
+    RenderDevice::setFrontFace(GL_CCW);
 }
 
 void initDebugStuff() {
@@ -110,6 +143,37 @@ void initDebugStuff() {
     auto probesNode = library->tryGetAssetNode(assetPath);
     shadowShader = library->tryLoadResource<Shader>(probesNode);
 
+    assetPath = "./assets/shaders/glsl/TiledLighting.shader";
+    library->formatPath(&assetPath);
+    auto cullingNode = library->tryGetAssetNode(assetPath);
+    lightCullingShader = library->tryLoadResource<Shader>(cullingNode);
+
+    assetPath = "./assets/shaders/glsl/DepthPrepass.shader";
+    library->formatPath(&assetPath);
+    auto prepassNode = library->tryGetAssetNode(assetPath);
+    depthPrepassShader = library->tryLoadResource<Shader>(prepassNode);
+
+    assetPath = "./assets/shaders/glsl/DepthPyramid.shader";
+    library->formatPath(&assetPath);
+    auto pyramidNode = library->tryGetAssetNode(assetPath);
+    depthPyramidShader = library->tryLoadResource<Shader>(pyramidNode);
+
+    assetPath = "./assets/shaders/glsl/OcclusionCulling.shader";
+    library->formatPath(&assetPath);
+    auto occlusionNode = library->tryGetAssetNode(assetPath);
+    occlusionCullingShader = library->tryLoadResource<Shader>(occlusionNode);
+    occlusionCulling.setShaders(depthPyramidShader, occlusionCullingShader);
+
+    assetPath = "./assets/shaders/glsl/Upscale.shader";
+    library->formatPath(&assetPath);
+    auto upscaleNode = library->tryGetAssetNode(assetPath);
+    upscaleShader = library->tryLoadResource<Shader>(upscaleNode);
+
+    assetPath = "./assets/shaders/glsl/TAA.shader";
+    library->formatPath(&assetPath);
+    auto temporalAANode = library->tryGetAssetNode(assetPath);
+    temporalAAShader = library->tryLoadResource<Shader>(temporalAANode);
+
     // Load later so shaders are ready
     assetPath = "./assets/models/shading_example.glb";
     //assetPath = "./assets/models/NewSponza_Main_glTF_003.gltf";
@@ -119,8 +183,10 @@ void initDebugStuff() {
 
     Actor* actor = scene.newActor();
     actor->setName("Sponza");
+    actor->setStatic(true);
     actor->addComponent<TransformComponent>();
     actor->addComponent<RendererComponent>(shader, material, mesh);
+    scene.requestStaticBatching();
     
     /*
     assetPath = "./assets/models/sphere.glb";
@@ -166,6 +232,26 @@ void initDebugStuff() {
     skyboxShader = library->tryLoadResource<Shader>(skyboxShaderNode);
 }
 
+/**
+ * @brief Scatters point lights of random colors over the scene, for testing the tiled lighting.
+ */
+void spawnDebugLights(int count) {
+    for (int i = 0; i < count; i++) {
+        Actor* lightActor = scene.newActor();
+        lightActor->setName(std::format("Point light {}", ++spawnedLights));
+        lightActor->addComponent<TransformComponent>();
+        lightActor->getComponent<TransformComponent>()->getTransform().setPosition(vector4f(
+            SDL_randf() * 30.0f - 15.0f,
+            SDL_randf() * 8.0f  + 0.5f,
+            SDL_randf() * 30.0f - 15.0f,
+            0.0f
+        ));
+
+        const vector4f color(0.2f + SDL_randf() * 0.8f, 0.2f + SDL_randf() * 0.8f, 0.2f + SDL_randf() * 0.8f, 1.0f);
+        lightActor->addComponent<LightComponent>(prism::LightType::POINT, color, 4.0f, 3.0f + SDL_randf() * 3.0f);
+    }
+}
+
 void initEvents() {    
     auto events = app->getEventManager();
 
@@ -199,6 +285,7 @@ void initEvents() {
             default:
                 break;
         }
+        activeCameraComponent->wake();
         return SDL_APP_CONTINUE;
     });
     events->add(SDL_EVENT_KEY_UP, [](SDL_Event* event) {
@@ -218,11 +305,13 @@ void initEvents() {
             default:
                 break;
         }
+        activeCameraComponent->wake();
         return SDL_APP_CONTINUE;
     });
     events->add(SDL_EVENT_MOUSE_MOTION, [](SDL_Event* event) {        
         activeCameraComponent->getCameraInput()->rotation.pitch += event->motion.xrel;
         activeCameraComponent->getCameraInput()->rotation.yaw   += event->motion.yrel;
+        activeCameraComponent->wake();
 
         return SDL_APP_CONTINUE;
     });
@@ -266,6 +355,89 @@ void performanceWindow() {
     float fps = 1.0f / deltaTime;
     ImGui::Text("FPS: ~%03.00f", fps);
 
+    const auto& queueStats = sceneQueue.getStats();
+    ImGui::Text("Draws: %u in %u calls, %u multi-draws of %u commands (shader changes: %u, material changes: %u, mesh changes: %u)",
+        queueStats.packets, queueStats.drawCalls, queueStats.multiDraws, queueStats.indirectCommands,
+        queueStats.shaderChanges, queueStats.materialChanges, queueStats.meshChanges);
+    const auto& prepassStats = depthPrepass.getStats();
+    ImGui::Text("G-buffer stage: %.02f ms without depth pre-pass, %.02f ms with (%s, overdraw %.02fx, %u pre-pass draw calls)",
+        prepassStats.withoutPrepassMs, prepassStats.withPrepassMs, prepassStats.enabled ? "on" : "off",
+        prepassStats.overdraw, prepassStats.enabled ? depthPrepass.getQueueStats().drawCalls : 0u);
+    ImGui::Text("Scene GPU time: ~%.02f ms of %.01f ms, rendering at %.0f%% (%d x %d), %u resolution changes",
+        dynamicResolution.getFrameTime(), dynamicResolution.getBudget(), dynamicResolution.getScale() * 100.0f,
+        dynamicResolution.scaleWidth(lastFrameWindowSize.x), dynamicResolution.scaleHeight(lastFrameWindowSize.y),
+        dynamicResolution.getChangeCount());
+    const auto& jitter = temporalAA.getJitter();
+    ImGui::Text("Temporal anti-aliasing: %s, jitter (%+.02f, %+.02f) px",
+        temporalAA.isEnabled() ? "on" : "off", jitter.x, jitter.y);
+    const auto& occlusionStats = occlusionCulling.getStats();
+    ImGui::Text("Occlusion culling: %u instances tested against a %ux%u depth pyramid of %u levels",
+        occlusionStats.testedInstances, occlusionStats.pyramidWidth, occlusionStats.pyramidHeight, occlusionStats.pyramidLevels);
+    const auto& objectBuffer = scene.getObjectBuffer();
+    ImGui::Text("Objects: %u slots, %u uploaded in %u ranges",
+        objectBuffer.getSlotCount(), objectBuffer.getLastUploadedCount(), objectBuffer.getLastUploadRanges());
+    auto materialTable = app->getMaterialTable();
+    ImGui::Text("Material table: %u materials in %u texture pools", materialTable->getMaterialCount() - 1, materialTable->getPoolCount());
+    auto geometryArena = app->getGeometryArena();
+    for (uint32_t i = 0; i < geometryArena->getFormatCount(); i++) {
+        const auto formatStats = geometryArena->getFormatStats(i);
+        ImGui::Text("Geometry (%u byte vertices): %u / %u vertices, %u / %u indices, %u free ranges",
+            formatStats.stride, formatStats.usedVertices, formatStats.vertexCapacity,
+            formatStats.usedIndices, formatStats.indexCapacity, formatStats.freeRanges);
+    }
+    for (uint32_t i = 0; i < cascadedShadows->getCascadeCount(); i++) {
+        const auto& cascade = cascadedShadows->getCascade(i);
+        ImGui::Text("Shadow cascade %u: up to %.01fm, %.01fm wide, every %u frames, updated %u times, %u static (rendered %u times), %u dynamic casters",
+            i, cascade.splitDistance, cascade.radius * 2.0f, cascade.updateInterval, cascade.updateCount,
+            cascade.renderer->getStaticCasterCount(), cascade.renderer->getStaticRenderCount(), cascade.renderer->getDynamicCasterCount());
+    }
+
+    auto timestep = app->getTimestep();
+    ImGui::Text("Simulation: %d ticks this frame, %llu total, %0.02fs dropped",
+        timestep->getLastFrameTicks(), static_cast<unsigned long long>(timestep->getTickCount()), timestep->getDroppedTime());
+
+    float tickRate = static_cast<float>(timestep->getTickRate());
+    if (ImGui::SliderFloat("Tick rate", &tickRate, 10.0f, 240.0f, "%.0f Hz")) {
+        timestep->setTickRate(tickRate);
+    }
+    int maxCatchUpTicks = timestep->getMaxCatchUpTicks();
+    if (ImGui::SliderInt("Max catch-up ticks", &maxCatchUpTicks, 1, 20)) {
+        timestep->setMaxCatchUpTicks(maxCatchUpTicks);
+    }
+
+    const auto& deviceStats = RenderDevice::getLastFrameStats();
+    ImGui::Text("GL state changes: %u issued, %u skipped", deviceStats.issued, deviceStats.skipped);
+
+    const auto streamBuffer = app->getStreamBuffer();
+    ImGui::Text("Stream buffer: %zu / %zu KB used, %u stalls",
+        streamBuffer->getUsedSize() / 1024, streamBuffer->getFrameSize() / 1024, streamBuffer->getStallCount());
+
+    const auto& scheduler = scene.getTickScheduler();
+    if (ImGui::BeginTable("##tick_groups", 5, ImGuiTableFlags_SizingStretchProp)) {
+        ImGui::TableSetupColumn("Tick group");
+        ImGui::TableSetupColumn("Registered");
+        ImGui::TableSetupColumn("Active");
+        ImGui::TableSetupColumn("Ticked");
+        ImGui::TableSetupColumn("Time (ms)");
+        ImGui::TableHeadersRow();
+
+        for (auto group : { TickGroup::PRE_PHYSICS, TickGroup::UPDATE, TickGroup::POST_UPDATE, TickGroup::ON_DEMAND }) {
+            const auto& groupStats = scheduler.getStats(group);
+            ImGui::TableNextColumn(); ImGui::Text("%s", TickScheduler::getGroupName(group));
+            ImGui::TableNextColumn(); ImGui::Text("%u", groupStats.registered);
+            ImGui::TableNextColumn(); ImGui::Text("%u", groupStats.active);
+            ImGui::TableNextColumn(); ImGui::Text("%u", groupStats.ticked);
+            ImGui::TableNextColumn(); ImGui::Text("%0.03f", groupStats.time);
+        }
+        ImGui::EndTable();
+    }
+    ImGui::Text("Sleeping components: %u", scheduler.getSleepingCount());
+
+    bool instancing = sceneQueue.isInstancingEnabled();
+    if (ImGui::Checkbox("Instancing", &instancing)) {
+        sceneQueue.setInstancingEnabled(instancing);
+    }
+
     frameTimesAvg[frameTimeAvgIndex] = fps;
     frameTimeAvgIndex = (frameTimeAvgIndex + 1) % frameTimesAvg.size();
 
@@ -302,7 +474,50 @@ void performanceWindow() {
     ImGui::End();
 }
 
-unsigned int targetHandle = -1;
+void profilerWindow() {
+    ImGui::Begin("GPU Profiler", nullptr);
+
+    bool enabled = gpuProfiler.isEnabled();
+    if (ImGui::Checkbox("Enabled", &enabled)) {
+        gpuProfiler.setEnabled(enabled);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Export CSV")) {
+        gpuProfiler.exportCSV("profile.csv");
+    }
+
+    const auto frameHistory = gpuProfiler.getFrameHistory();
+    ImGui::Text("%llu frames read back, %u skipped, statistics of the last %zu",
+        static_cast<unsigned long long>(gpuProfiler.getFinishedFrameCount()), gpuProfiler.getSkipCount(), frameHistory.size());
+    ImGui::PlotLines("##gpuFrames", frameHistory.data(), static_cast<int>(frameHistory.size()), 0,
+                     "GPU frame time (ms)", 0.0f, 33.3f, ImVec2(-1, 80));
+
+    // Passes are nested in the frame, the frame row is their total with the gaps between them
+    static constexpr std::array<const char*, 8> columns = {
+        "Scope", "GPU last", "GPU avg", "GPU p95", "GPU p99", "CPU avg", "CPU p95", "CPU p99"
+    };
+    if (ImGui::BeginTable("##profilerScopes", static_cast<int>(columns.size()), ImGuiTableFlags_SizingStretchProp | ImGuiTableFlags_BordersInner | ImGuiTableFlags_RowBg)) {
+        for (const char* column : columns) {
+            ImGui::TableSetupColumn(column);
+        }
+        ImGui::TableHeadersRow();
+
+        for (const auto& stats : gpuProfiler.getStats()) {
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", stats.name.c_str());
+            for (const float time : { stats.gpuLast, stats.gpuAverage, stats.gpuP95, stats.gpuP99, stats.cpuAverage, stats.cpuP95, stats.cpuP99 }) {
+                ImGui::TableNextColumn();
+                ImGui::Text("%.03f ms", time);
+            }
+        }
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
+
+unsigned int targetHandle = 0;
+ImVec2 targetScale(1.0f, 1.0f); // The rendered part of the target, the scene targets are only rendered into partially
 
 void renderWindow() {
     ImGui::Begin("Render", nullptr);
@@ -318,20 +533,15 @@ void renderWindow() {
         lastFrameWindowSize.y = height;
         lastFrameWindowSize.dpi = dpi;
 
+        // The render graph picks up the new size next frame
         activeCameraComponent->resizeCamera(width, height);
-        sceneFramebuffer->resize(width, height);
-        combinedFramebuffer->resize(width, height);
-    }
-
-    if (targetHandle == -1) {
-        targetHandle = combinedFramebuffer->getColorTarget().getHandle();
     }
 
     ImGui::Image(
         targetHandle,
         ImVec2(width / dpi, height / dpi),
-        ImVec2(0, 1),
-        ImVec2(1, 0)
+        ImVec2(0, targetScale.y),
+        ImVec2(targetScale.x, 0)
     );
 
     ImGui::SetCursorPos(ImVec2(10, startPos));
@@ -344,30 +554,78 @@ void debugWindow() {
     ImGui::Begin("Debug", nullptr);
 
     ImGui::Text("Current render target: %u", targetHandle);
-    
-    unsigned int combinedHandle = combinedFramebuffer->getColorTarget().getHandle();
-    bool combinedTarget = ImGui::RadioButton("Combined", targetHandle == combinedHandle);
-    if (combinedTarget) targetHandle = combinedHandle;
 
-    unsigned int colorHandle = sceneFramebuffer->getColorTarget().getHandle();
-    bool colorTarget = ImGui::RadioButton("Color", targetHandle == colorHandle);
-    if (colorTarget) targetHandle = colorHandle;
+    // Passes only feeding the other views are culled while not shown
+    static constexpr std::array<std::pair<const char*, const char*>, 12> outputs = {{
+        { "Upscaled"             , "display"                     },
+        { "Combined"             , "combined"                    },
+        { "Color"                , "gbuffer.diffuse"             },
+        { "Normal"               , "gbuffer.normal"              },
+        { "Position"             , "gbuffer.position"            },
+        { "AO/Roughness/Metallic", "gbuffer.aoRoughnessMetallic" },
+        { "Depth"                , "gbuffer.depth"               },
+        { "Velocity"             , "gbuffer.velocity"            },
+        { "Shadow cascade 0"     , "shadowMap.0"                 },
+        { "Shadow cascade 1"     , "shadowMap.1"                 },
+        { "Shadow cascade 2"     , "shadowMap.2"                 },
+        { "Shadow cascade 3"     , "shadowMap.3"                 },
+    }};
+    for (const auto& [label, name] : outputs) {
+        if (slimGBuffer && std::string(name) == "gbuffer.position") {
+            continue;
+        }
+        if (ImGui::RadioButton(label, renderOutput == name)) {
+            renderOutput = name;
+        }
+    }
+
+    ImGui::Checkbox("Slim G-buffer", &slimGBuffer);
+
+    bool dynamicScaling = dynamicResolution.isEnabled();
+    if (ImGui::Checkbox("Dynamic resolution", &dynamicScaling)) {
+        dynamicResolution.setEnabled(dynamicScaling);
+    }
+    float budget = dynamicResolution.getBudget();
+    if (ImGui::SliderFloat("GPU budget", &budget, 2.0f, 50.0f, "%.1f ms")) {
+        dynamicResolution.setBudget(budget);
+    }
+    float fixedScale = dynamicResolution.getFixedScale();
+    if (ImGui::SliderFloat("Fixed render scale", &fixedScale, prism::DynamicResolution::MIN_SCALE, prism::DynamicResolution::MAX_SCALE, "%.2f")) {
+        dynamicResolution.setFixedScale(fixedScale);
+    }
 
-    unsigned int normalHandle = sceneFramebuffer->getNormalTarget().getHandle();
-    bool normalTarget = ImGui::RadioButton("Normal", targetHandle == normalHandle);
-    if (normalTarget) targetHandle = normalHandle;
+    bool temporal = temporalAA.isEnabled();
+    if (ImGui::Checkbox("Temporal anti-aliasing", &temporal)) {
+        temporalAA.setEnabled(temporal);
+    }
 
-    unsigned int positionHandle = sceneFramebuffer->getPositionTarget().getHandle();
-    bool positionTarget = ImGui::RadioButton("Position", targetHandle == positionHandle);
-    if (positionTarget) targetHandle = positionHandle;
+    bool occlusion = occlusionCulling.isEnabled();
+    if (ImGui::Checkbox("Occlusion culling", &occlusion)) {
+        occlusionCulling.setEnabled(occlusion);
+    }
 
-    unsigned int aoRoughnessMetallicHandle = sceneFramebuffer->getAORoughnessMetallicTarget().getHandle();
-    bool aoRoughnessMetallicTarget = ImGui::RadioButton("AO/Roughness/Metallic", targetHandle == aoRoughnessMetallicHandle);
-    if (aoRoughnessMetallicTarget) targetHandle = aoRoughnessMetallicHandle;
+    static constexpr std::array<const char*, 3> prepassModes = { "Off", "On", "Auto" };
+    int prepassMode = static_cast<int>(scene.getDepthPrepassMode());
+    if (ImGui::Combo("Depth pre-pass", &prepassMode, prepassModes.data(), static_cast<int>(prepassModes.size()))) {
+        scene.setDepthPrepassMode(static_cast<prism::DepthPrepassMode>(prepassMode));
+    }
 
-    unsigned int shadowCastingHandle = shadowCastingFramebuffer->getColorTarget().getHandle();
-    bool shadowCastingTarget = ImGui::RadioButton("Skylight Shadow", targetHandle == shadowCastingHandle);
-    if (shadowCastingTarget) targetHandle = shadowCastingHandle;
+    const auto& graphStats = renderGraph.getStats();
+    ImGui::Text("Render graph: %u passes, %u culled", graphStats.passes, graphStats.culledPasses);
+    ImGui::Text("Transients: %u in %u textures, %.01f MB instead of %.01f MB",
+        graphStats.transients, graphStats.physicalTextures,
+        graphStats.physicalBytes / (1024.0f * 1024.0f), graphStats.transientBytes / (1024.0f * 1024.0f));
+    for (const auto& pass : renderGraph.getExecutedPasses()) {
+        ImGui::BulletText("%s", pass.c_str());
+    }
+
+    ImGui::Separator();
+
+    const auto& lightingStats = tiledLighting.getStats();
+    ImGui::Text("Tiled lighting: %u visible lights, %ux%u tiles", lightingStats.lights, lightingStats.tilesX, lightingStats.tilesY);
+    if (ImGui::Button("Add 100 point lights")) {
+        spawnDebugLights(100);
+    }
 
     ImGui::End();
 }
@@ -388,9 +646,8 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
 
     initDebugStuff();
 
-    sceneFramebuffer = std::make_unique<GBuffer>(1920, 1200);
-    combinedFramebuffer = std::make_unique<Framebuffer>(1920, 1200);
-    shadowCastingFramebuffer = std::make_unique<Framebuffer>(2048, 2048, true);
+    cascadedShadows = std::make_unique<prism::CascadedShadows>(SHADOW_CASCADES, SHADOW_CASCADE_SIZE, SHADOW_DISTANCE);
+    renderGraph.setProfiler(&gpuProfiler);
 
     // Enable adaptive vsync
     SDL_GL_SetSwapInterval(-1);
@@ -399,6 +656,7 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
     ui->addUIFunction(renderWindow);
     ui->addUIFunction(performanceWindow);
     ui->addUIFunction(debugWindow);
+    ui->addUIFunction(profilerWindow);
     ui->addUIFunction(Library::assetsWindow);
     ui->addUIFunction([]() {
         app->getConsole()->drawConsole();
@@ -428,6 +686,9 @@ SDL_AppResult SDL_AppIterate(void *appstate) {
     // Upadte asset library
     app->getLibrary()->checkForFinishedAsync();
 
+    RenderDevice::beginFrame();
+    app->getStreamBuffer()->beginFrame();
+
     // ======================
     // Time management
     
@@ -435,134 +696,301 @@ SDL_AppResult SDL_AppIterate(void *appstate) {
     deltaTime = nowTime - lastTime;
     lastTime = nowTime;
 
+    // The results arrive a few frames later, paired with the delta time of their frame
+    gpuProfiler.beginFrame(deltaTime * 1000.0);
+
     // ======================
     // Process new frame
 
     app->getUIManager()->newFrame();
-    activeCameraComponent->sendDebugCameraInput(deltaTime);
     
     // ======================
-    // Update "game" logic
+    // Update "game" logic, in fixed ticks
 
-    // if (mesh)
-    //     mesh->rotation.y += deltaTime * 0.314f;
+    auto timestep = app->getTimestep();
+    auto camera   = activeCameraComponent->getCamera();
+
+    // The camera component handles the input, in the pre-physics group
+    const int ticks = timestep->advance(deltaTime);
+    for (int tick = 0; tick < ticks; tick++) {
+        scene.update(static_cast<float>(timestep->getTickDelta()));
+    }
+
+    // Rendering happens between the last two ticks
+    const float interpolation = timestep->getAlpha();
+    camera->setInterpolation(interpolation);
     
 
     // ======================
     // Render
-    // G-buffer pass
 
-    glClearColor(0, 0, 0, 1);
+    RenderDevice::setClearColor(0, 0, 0, 1);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    sceneFramebuffer->bind();
+    // The targets are allocated at the full size, the scene is rendered into their bottom left corner
+    dynamicResolution.beginFrame();
+    const int width  = lastFrameWindowSize.x;
+    const int height = lastFrameWindowSize.y;
+    const int renderWidth  = dynamicResolution.scaleWidth(width);
+    const int renderHeight = dynamicResolution.scaleHeight(height);
+    const int shadowSize = cascadedShadows->getSize();
+
+    // The jitter moves the samples within the pixels of the rendered size
+    const bool temporalResolve = temporalAA.isEnabled() && temporalAAShader->isInitialized() && quadMesh->isInitialized();
+    if (temporalResolve) {
+        temporalAA.resize(width, height);
+    }
+    const vector4f jitter = temporalAA.beginFrame(renderWidth, renderHeight);
+    camera->beginFrame(temporalResolve ? jitter : vector4f::zero());
+    frameNumber++;
+
+    renderGraph.reset();
+    // Slim: 20 bytes per pixel (RGBA8 color, octahedral RG16 normal, RGBA8 material, RG16F velocity, depth)
+    // Wide: 36 bytes per pixel (RGBA16F color, normal and position, RGBA8 material, RG16F velocity, depth)
+    const uint32_t diffuseFormat = slimGBuffer ? GL_RGBA8 : GL_RGBA16F;
+    const uint32_t normalFormat  = slimGBuffer ? GL_RG16_SNORM : GL_RGBA16F;
+    renderGraph.createTexture("gbuffer.diffuse"            , { width, height, diffuseFormat });
+    renderGraph.createTexture("gbuffer.normal"             , { width, height, normalFormat });
+    renderGraph.createTexture("gbuffer.aoRoughnessMetallic", { width, height, GL_RGBA8 });
+    renderGraph.createTexture("gbuffer.velocity"           , { width, height, GL_RG16F });
+    renderGraph.createTexture("gbuffer.depth"              , { width, height, GL_DEPTH24_STENCIL8 });
+    if (!slimGBuffer) {
+        renderGraph.createTexture("gbuffer.position"       , { width, height, GL_RGBA16F });
+    }
+    renderGraph.createTexture("combined"                   , { width, height, GL_RGBA16F });
+    if (temporalResolve) {
+        // The output is kept as the history of the next frame
+        renderGraph.importTexture("display", temporalAA.getOutputTexture(), { width, height, GL_RGBA16F });
+    } else {
+        renderGraph.createTexture("display"                , { width, height, GL_RGBA16F });
+    }
+    for (uint32_t i = 0; i < cascadedShadows->getCascadeCount(); i++) {
+        renderGraph.importTexture(std::format("shadowMap.{}", i), cascadedShadows->getShadowMap(i), { shadowSize, shadowSize, GL_DEPTH_COMPONENT16 });
+    }
+
+    tiledLighting.resize(width, height);
+    const int tilesX = static_cast<int>(tiledLighting.getTileCountX());
+    const int tilesY = static_cast<int>(tiledLighting.getTileCountY());
+    renderGraph.importTexture("lightGrid", tiledLighting.getGridTexture(), { tilesX, tilesY, GL_RG32UI });
 
-        glViewport(0, 0, lastFrameWindowSize.x, lastFrameWindowSize.y);
-        glClearColor(0, 0, 0, 1);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);   
-        glEnable(GL_DEPTH_TEST);
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
-        glFrontFace(GL_CCW);
+    occlusionCulling.resize(width, height);
 
-        scene.render();
+    // G-buffer pass
 
-        if (skyboxShader->isInitialized() && skyboxMesh->isInitialized() && skyboxTexture->isInitialized()) {
-            glDisable(GL_CULL_FACE);
-            glEnable(GL_DEPTH_TEST);
+    // The passes rendering at the scaled resolution are timed for picking the resolution
+    auto gbufferPass = renderGraph.addPass("G-buffer", [&](const prism::RenderGraphContext& context) {
+        dynamicResolution.beginPass();
+        RenderDevice::setClearColor(0, 0, 0, 1);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        RenderDevice::setEnabled(GL_DEPTH_TEST, true);
+        RenderDevice::setEnabled(GL_CULL_FACE, true);
+        RenderDevice::setCullFace(GL_BACK);
+        RenderDevice::setFrontFace(GL_CCW);
+
+        prism::View sceneView = prism::View::fromCamera(activeCameraComponent->getCamera());
+        sceneView.queue = &sceneQueue;
+        sceneView.lights = &tiledLighting.getLights();
+        sceneView.occlusion = &occlusionCulling;
+        sceneView.interpolation = interpolation;
+        sceneView.frame = frameNumber;
+        depthPrepass.render(scene, sceneView, depthPrepassShader, renderWidth, renderHeight);
+        dynamicResolution.endPass();
+    })
+        .attach("gbuffer.diffuse")
+        .attach("gbuffer.normal")
+        .attach("gbuffer.aoRoughnessMetallic")
+        .attach("gbuffer.velocity");
+    if (!slimGBuffer) {
+        gbufferPass.attach("gbuffer.position");
+    }
+    gbufferPass
+        .attach("gbuffer.depth")
+        .viewport(renderWidth, renderHeight);
+
+    // Skybox pass, behind the scene
+
+    if (skyboxShader->isInitialized() && skyboxMesh->isInitialized() && skyboxTexture->isInitialized()) {
+        renderGraph.addPass("Skybox", [&](const prism::RenderGraphContext& context) {
+            // Tested against the scene, but not written, so the lighting pass can tell the sky apart
+            RenderDevice::setEnabled(GL_CULL_FACE, false);
+            RenderDevice::setEnabled(GL_DEPTH_TEST, true);
+            RenderDevice::setDepthMask(false);
 
             skyboxShader->bind();
             skyboxShader->setUniform("viewMatrix", activeCameraComponent->getCamera()->getViewMatrix());
             skyboxShader->setUniform("projectionMatrix", activeCameraComponent->getCamera()->getProjectionMatrix());
-            skyboxShader->setUniform("cameraPosition", activeCameraComponent->getCamera()->getPosition());
+            skyboxShader->setUniform("cameraPosition", activeCameraComponent->getCamera()->getInterpolatedPosition());
 
             skyboxTexture->bind(0);
             skyboxShader->setUniform("skyboxTexture", 0);
 
             skyboxMesh->draw();
 
-            glEnable(GL_CULL_FACE);
-            glDisable(GL_DEPTH_TEST);
-        }
-
-    sceneFramebuffer->unbind();
-
-    // Shadow pass
-    // TODO: only render when something changed or from time to time
+            RenderDevice::setDepthMask(true);
+            RenderDevice::setEnabled(GL_CULL_FACE, true);
+        })
+            .attach("gbuffer.diffuse")
+            .attach("gbuffer.depth")
+            .viewport(renderWidth, renderHeight);
+    }
 
-    if (shadowShader->isInitialized() && shadowLastTime + 0.32 < nowTime) {
-    shadowLastTime = nowTime;
+    // Shadow pass, using coarser detail levels, only the cascades due this frame are updated
 
-    shadowCastingFramebuffer->bind();
+    if (shadowShader->isInitialized()) {
+        auto shadowPass = renderGraph.addPass("Shadow", [&](const prism::RenderGraphContext& context) {
+            cascadedShadows->render(scene, activeCameraComponent->getCamera(), lightCamera->getRotation(), shadowShader, SHADOW_LOD_BIAS, interpolation);
+        });
+        for (uint32_t i = 0; i < cascadedShadows->getCascadeCount(); i++) {
+            shadowPass.write(std::format("shadowMap.{}", i));
+        }
+    }
 
-        glViewport(0, 0, 2048, 2048);
-        glClearColor(0, 0, 0, 1);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        glDisable(GL_CULL_FACE);
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GL_LESS);
-        
-        shadowShader->bind();
-        shadowShader->setUniform("viewMatrix", lightCamera->getViewMatrix());
-        shadowShader->setUniform("projectionMatrix", lightCamera->getProjectionMatrix());
-        // Render all objects again
-        scene.render(shadowShader);
+    // Light culling pass, building the light lists of the screen tiles from the depth bounds
+
+    const bool lightCulling = lightCullingShader->isInitialized();
+    if (lightCulling) {
+        renderGraph.addPass("Light culling", [&](const prism::RenderGraphContext& context) {
+            dynamicResolution.beginPass();
+            auto camera = activeCameraComponent->getCamera();
+            tiledLighting.cull(lightCullingShader, context.getTexture("gbuffer.depth"), camera->getViewMatrix(), camera->getProjectionMatrix(), renderWidth, renderHeight);
+            dynamicResolution.endPass();
+        })
+            .read("gbuffer.depth")
+            .write("lightGrid");
+    }
 
-    shadowCastingFramebuffer->unbind();
+    // Depth pyramid pass, the next frame is occlusion culled against the depth of this one
 
+    if (occlusionCulling.isEnabled() && depthPyramidShader->isInitialized()) {
+        renderGraph.addPass("Depth pyramid", [&](const prism::RenderGraphContext& context) {
+            // Without the jitter of the frame, the next frame projects its boxes with its own offset
+            auto camera = activeCameraComponent->getCamera();
+            occlusionCulling.buildPyramid(context.getTexture("gbuffer.depth"), renderWidth, renderHeight, camera->getViewMatrix() * camera->getUnjitteredProjectionMatrix());
+        })
+            .read("gbuffer.depth")
+            .sideEffect();
     }
 
     // Combine pass
 
     if (combineShader->isInitialized() && quadMesh->isInitialized()) {
+        auto combinePass = renderGraph.addPass("Combine", [&](const prism::RenderGraphContext& context) {
+            dynamicResolution.beginPass();
+            RenderDevice::setClearColor(0, 0, 0, 1);
+            glClear(GL_COLOR_BUFFER_BIT);
+            RenderDevice::setEnabled(GL_DEPTH_TEST, false);
+
+            combineShader->bind();
+            combineShader->setUniform("gDiffuse", 0);
+            combineShader->setUniform("gNormal", 1);
+            combineShader->setUniform("gPosition", 2);
+            combineShader->setUniform("gAORoughnessMetallic", 3);
+            combineShader->setUniform("gDepth", 6);
+
+            RenderDevice::bindTexture(0, context.getTexture("gbuffer.diffuse"));
+            RenderDevice::bindTexture(1, context.getTexture("gbuffer.normal"));
+            RenderDevice::bindTexture(3, context.getTexture("gbuffer.aoRoughnessMetallic"));
+            RenderDevice::bindTexture(6, context.getTexture("gbuffer.depth"));
+
+            auto camera = activeCameraComponent->getCamera();
+            combineShader->setUniform("reconstructPosition", slimGBuffer ? 1 : 0);
+            combineShader->setUniform("inverseViewProjection", (camera->getViewMatrix() * camera->getProjectionMatrix()).inverse());
+            if (!slimGBuffer) {
+                RenderDevice::bindTexture(2, context.getTexture("gbuffer.position"));
+            }
 
-    combinedFramebuffer->bind();
-
-        glViewport(0, 0, lastFrameWindowSize.x, lastFrameWindowSize.y);
-        glClearColor(0, 0, 0, 1);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);   
-        glDisable(GL_DEPTH_TEST);
-
-        glBindFramebuffer(GL_READ_FRAMEBUFFER, sceneFramebuffer->getHandle());
-        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, combinedFramebuffer->getHandle());
-        glBlitFramebuffer(
-            0, 0, lastFrameWindowSize.x, lastFrameWindowSize.y,
-            0, 0, lastFrameWindowSize.x, lastFrameWindowSize.y,
-            GL_DEPTH_BUFFER_BIT,
-            GL_NEAREST
-        );
-        glBindFramebuffer(GL_FRAMEBUFFER, combinedFramebuffer->getHandle());
-
-        combineShader->bind();
-        combineShader->setUniform("gDiffuse", 0);
-        combineShader->setUniform("gNormal", 1);
-        combineShader->setUniform("gPosition", 2);
-        combineShader->setUniform("gAORoughnessMetallic", 3);
-        combineShader->setUniform("shadowMap", 4);
+            combineShader->setUniform("lightDirection", lightCamera->getForwardVector());
 
-        sceneFramebuffer->getColorTarget().bind(0);
-        sceneFramebuffer->getNormalTarget().bind(1);
-        sceneFramebuffer->getPositionTarget().bind(2);
-        sceneFramebuffer->getAORoughnessMetallicTarget().bind(3);
-        shadowCastingFramebuffer->getColorTarget().bind(4);
+            cascadedShadows->bindUniforms();
+            for (uint32_t i = 0; i < cascadedShadows->getCascadeCount(); i++) {
+                RenderDevice::bindTexture(prism::CascadedShadows::FIRST_TEXTURE_UNIT + i, context.getTexture(std::format("shadowMap.{}", i)));
+                RenderDevice::bindSampler(prism::CascadedShadows::FIRST_TEXTURE_UNIT + i, cascadedShadows->getCompareSampler());
+            }
 
-        combineShader->setUniform("lightViewMatrix"      , lightCamera->getViewMatrix());
-        combineShader->setUniform("lightProjectionMatrix", lightCamera->getProjectionMatrix());
-        combineShader->setUniform("lightDirection"       , lightCamera->getForwardVector());
+            skyboxTexture->bind(5);
+            combineShader->setUniform("skyboxTexture", 5);
 
-        skyboxTexture->bind(5);
-        combineShader->setUniform("skyboxTexture", 5);
+            combineShader->setUniform("tiledLighting", lightCulling ? 1 : 0);
+            if (lightCulling) {
+                combineShader->setUniform("lightGrid", 7);
+                RenderDevice::bindTexture(7, context.getTexture("lightGrid"));
+                tiledLighting.bind();
+            }
 
-        quadMesh->draw();
+            quadMesh->draw();
+            dynamicResolution.endPass();
+        })
+            .read("gbuffer.diffuse")
+            .read("gbuffer.normal")
+            .read("gbuffer.aoRoughnessMetallic")
+            .read("gbuffer.depth")
+            .attach("combined")
+            .viewport(renderWidth, renderHeight);
+        if (!slimGBuffer) {
+            combinePass.read("gbuffer.position");
+        }
+        if (lightCulling) {
+            combinePass.read("lightGrid");
+        }
+        for (uint32_t i = 0; i < cascadedShadows->getCascadeCount(); i++) {
+            combinePass.read(std::format("shadowMap.{}", i));
+        }
+    }
 
-    combinedFramebuffer->unbind();
+    // Temporal anti-aliasing pass accumulating the jittered frames at the output resolution,
+    // or an upscale pass stretching the rendered corner over the output
+
+    if (temporalResolve) {
+        renderGraph.addPass("Temporal anti-aliasing", [&](const prism::RenderGraphContext& context) {
+            temporalAA.resolve(temporalAAShader, quadMesh,
+                context.getTexture("combined"), context.getTexture("gbuffer.velocity"), context.getTexture("gbuffer.depth"),
+                camera, width, height);
+        })
+            .read("combined")
+            .read("gbuffer.velocity")
+            .read("gbuffer.depth")
+            .write("display");
+    } else if (upscaleShader->isInitialized() && quadMesh->isInitialized()) {
+        renderGraph.addPass("Upscale", [&](const prism::RenderGraphContext& context) {
+            RenderDevice::setEnabled(GL_DEPTH_TEST, false);
+
+            upscaleShader->bind();
+            upscaleShader->setUniform("sourceTexture", 0);
+            upscaleShader->setUniform("sourceRegion", vector4f(
+                static_cast<float>(renderWidth) / width, static_cast<float>(renderHeight) / height,
+                0.5f / width, 0.5f / height
+            ));
+            RenderDevice::bindTexture(0, context.getTexture("combined"));
+
+            quadMesh->draw();
+        })
+            .read("combined")
+            .attach("display");
+    }
 
+    // The position target only exists in the wide layout
+    if (slimGBuffer && renderOutput == "gbuffer.position") {
+        renderOutput = "combined";
     }
+    renderGraph.setOutput(renderOutput);
+    renderGraph.execute();
+    targetHandle = renderGraph.getTexture(renderOutput);
+
+    // Only the scene targets are rendered at the scaled resolution
+    const bool scaledOutput = renderOutput == "combined" || renderOutput.starts_with("gbuffer.");
+    targetScale = scaledOutput ?
+        ImVec2(static_cast<float>(renderWidth) / width, static_cast<float>(renderHeight) / height) :
+        ImVec2(1.0f, 1.0f);
 
     // Draw UI on top of everything
-    app->getUIManager()->render();
+    {
+        prism::GPUProfiler::Scope scope(&gpuProfiler, "UI");
+        app->getUIManager()->render();
+    }
+    gpuProfiler.endFrame();
 
     // Finalize frame
+    app->getStreamBuffer()->endFrame();
     SDL_GL_SwapWindow(app->getWindowPtr());
 
     // ======================
@@ -0,0 +1,160 @@
+#include "prism/cascadedShadows.hpp"
+
+#include "cinder.hpp"
+#include "hex/scene.hpp"
+
+#include <glad.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace prism {
+
+CascadedShadows::CascadedShadows(uint32_t cascadeCount, int size, float distance)
+    : m_size(size), m_distance(distance), m_uniformBuffer(sizeof(CascadeUniformData), UNIFORM_BINDING)
+{
+    cascadeCount = std::clamp(cascadeCount, 1u, MAX_CASCADES);
+    m_cascades.resize(cascadeCount);
+
+    for (uint32_t i = 0; i < cascadeCount; i++) {
+        auto& cascade = m_cascades[i];
+        cascade.renderer = std::make_unique<ShadowRenderer>(size);
+        cascade.camera   = std::make_unique<hex::Camera>(-1.0f, 1.0f, -1.0f, 1.0f, 0.1f, 1.0f);
+        // Near every frame, then every 2nd, 4th, 8th frame
+        cascade.updateInterval = 1u << i;
+    }
+
+    // The maps stay plain depth textures, so they can be viewed, comparison happens through the sampler
+    glCreateSamplers(1, &m_compareSampler);
+    glSamplerParameteri(m_compareSampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glSamplerParameteri(m_compareSampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glSamplerParameteri(m_compareSampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glSamplerParameteri(m_compareSampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glSamplerParameteri(m_compareSampler, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glSamplerParameteri(m_compareSampler, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+}
+
+CascadedShadows::~CascadedShadows() {
+    glDeleteSamplers(1, &m_compareSampler);
+}
+
+void CascadedShadows::invalidate() {
+    for (auto& cascade : m_cascades) {
+        cascade.renderer->invalidate();
+        cascade.rendered = false;
+    }
+}
+
+void CascadedShadows::computeSplits(float nearDistance, float farDistance) {
+    const uint32_t count = getCascadeCount();
+    for (uint32_t i = 0; i < count; i++) {
+        const float fraction = static_cast<float>(i + 1) / count;
+        const float logarithmic = nearDistance * std::pow(farDistance / nearDistance, fraction);
+        const float uniform     = nearDistance + (farDistance - nearDistance) * fraction;
+        m_cascades[i].splitDistance = m_splitBlend * logarithmic + (1.0f - m_splitBlend) * uniform;
+    }
+}
+
+void CascadedShadows::fitCascade(uint32_t index, const std::array<vector4f, 8>& corners, float nearDistance, float farDistance, const vector4f& lightRotation) {
+    auto& cascade = m_cascades[index];
+
+    const float sliceStart = index == 0 ? nearDistance : m_cascades[index - 1].splitDistance;
+    const float sliceEnd   = cascade.splitDistance;
+    const float startFraction = (sliceStart - nearDistance) / (farDistance - nearDistance);
+    const float endFraction   = (sliceEnd   - nearDistance) / (farDistance - nearDistance);
+
+    // The corners of the slice lie on the edges of the frustum
+    std::array<vector4f, 8> slice;
+    vector4f center = vector4f::zero();
+    for (int i = 0; i < 4; i++) {
+        slice[i]     = vector4f::lerp(corners[i], corners[i + 4], startFraction);
+        slice[i + 4] = vector4f::lerp(corners[i], corners[i + 4], endFraction);
+        center = center + slice[i] + slice[i + 4];
+    }
+    center = center / 8.0f;
+
+    // The bounding sphere only depends on the shape of the slice, rounded so float noise can't change it
+    float radius = 0.0f;
+    for (const auto& corner : slice) {
+        radius = std::max(radius, (corner - center).length3d());
+    }
+    radius = std::ceil(radius * 16.0f) / 16.0f;
+
+    // Moves in whole texels of the light space
+    const float texelSize = 2.0f * radius / m_size;
+    const matrix4x4f lightMatrix = matrix4x4f::lookAt(lightRotation);
+    vector4f lightSpaceCenter = center * lightMatrix;
+    lightSpaceCenter.x = std::floor(lightSpaceCenter.x / texelSize) * texelSize;
+    lightSpaceCenter.y = std::floor(lightSpaceCenter.y / texelSize) * texelSize;
+    center = lightSpaceCenter * lightMatrix.inverse();
+    center.w = 0.0f;
+
+    // Depth covers the sphere, and the casters between it and the light
+    cascade.camera->setPosition(center);
+    cascade.camera->setRotation(lightRotation);
+    cascade.camera->setOrthographic(-radius, radius, -radius, radius, -(radius + CASTER_DISTANCE), radius);
+
+    cascade.radius = radius;
+    // A bit over a texel in world space, but never below a few steps of the 16 bit depth
+    cascade.depthBias = std::max(1.5f * texelSize / (2.0f * radius + CASTER_DISTANCE), 4.0f / 65535.0f);
+}
+
+void CascadedShadows::render(hex::Scene& scene, hex::Camera* viewCamera, const vector4f& lightRotation, codex::Shader* shader, int lodBias, float interpolation) {
+    m_frame++;
+
+    const matrix4x4f inverseViewProjection = (viewCamera->getViewMatrix() * viewCamera->getProjectionMatrix()).inverse();
+    std::array<vector4f, 8> corners;
+    for (int i = 0; i < 8; i++) {
+        const vector4f ndc(
+            (i & 1) ? 1.0f : -1.0f,
+            (i & 2) ? 1.0f : -1.0f,
+            (i & 4) ? 1.0f : -1.0f,
+            1.0f
+        );
+        const vector4f world = ndc * inverseViewProjection;
+        corners[i] = world / world.w;
+    }
+
+    // Works for any projection, without knowing its planes
+    const vector4f eye = viewCamera->getInterpolatedPosition();
+    vector4f nearCenter = vector4f::zero(), farCenter = vector4f::zero();
+    for (int i = 0; i < 4; i++) {
+        nearCenter = nearCenter + corners[i];
+        farCenter  = farCenter  + corners[i + 4];
+    }
+    const float nearDistance = (nearCenter / 4.0f - eye).length3d();
+    const float farDistance  = (farCenter  / 4.0f - eye).length3d();
+
+    computeSplits(nearDistance, std::min(m_distance, farDistance));
+
+    for (uint32_t i = 0; i < getCascadeCount(); i++) {
+        auto& cascade = m_cascades[i];
+
+        // Offset by the index, so the far cascades don't all update on the same frame
+        const bool due = !cascade.rendered || (m_frame + i) % cascade.updateInterval == 0;
+        if (!due) {
+            continue;
+        }
+
+        fitCascade(i, corners, nearDistance, farDistance, lightRotation);
+        cascade.renderer->render(scene, cascade.camera.get(), shader, lodBias, interpolation);
+
+        cascade.viewProjection = cascade.camera->getViewMatrix() * cascade.camera->getProjectionMatrix();
+        cascade.rendered = true;
+        cascade.updateCount++;
+    }
+}
+
+void CascadedShadows::bindUniforms() {
+    CascadeUniformData data;
+    for (uint32_t i = 0; i < MAX_CASCADES; i++) {
+        const bool used = i < getCascadeCount();
+        data.viewProjections[i] = used ? m_cascades[i].viewProjection : matrix4x4f();
+        data.depthBias.as_array[i] = used ? m_cascades[i].depthBias : 0.0f;
+    }
+    data.params = vector4f(static_cast<float>(getCascadeCount()), 0.0f, 0.0f, 0.0f);
+
+    m_uniformBuffer.updateData(&data);
+}
+
+}; // namespace prism
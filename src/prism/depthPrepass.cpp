@@ -0,0 +1,77 @@
+#include "prism/depthPrepass.hpp"
+
+#include "renderDevice.hpp"
+#include "hex/scene.hpp"
+
+#include <glad.h>
+
+namespace prism {
+
+DepthPrepass::DepthPrepass()
+    : m_stageTimers{ GPUQuery(GL_TIME_ELAPSED), GPUQuery(GL_TIME_ELAPSED) }, m_samples(GL_SAMPLES_PASSED) {}
+
+bool DepthPrepass::isEnabled(DepthPrepassMode mode) const {
+    switch (mode) {
+        case DepthPrepassMode::ON:   return true;
+        case DepthPrepassMode::AUTO: return m_autoEnabled;
+        default:                     return false;
+    }
+}
+
+void DepthPrepass::render(hex::Scene& scene, const View& view, codex::Shader* depthShader, int width, int height) {
+    updateStats(width, height);
+
+    const bool prepass = isEnabled(scene.getDepthPrepassMode()) && depthShader != nullptr && depthShader->isInitialized();
+    m_stats.enabled = prepass;
+
+    GPUQuery& timer = m_stageTimers[prepass ? 1 : 0];
+    timer.begin();
+
+    // The first depth tested pass sees the overdraw, in both modes
+    m_samples.begin();
+    if (prepass) {
+        View depthView = view;
+        depthView.overrideShader = depthShader;
+        depthView.queue  = &m_queue;
+        depthView.lights = nullptr;
+
+        cinder::RenderDevice::setColorMask(false);
+        scene.render(depthView);
+        m_samples.end();
+        cinder::RenderDevice::setColorMask(true);
+
+        cinder::RenderDevice::setDepthFunc(GL_EQUAL);
+        cinder::RenderDevice::setDepthMask(false);
+        scene.render(view);
+        cinder::RenderDevice::setDepthMask(true);
+        cinder::RenderDevice::setDepthFunc(GL_LESS);
+    } else {
+        scene.render(view);
+        m_samples.end();
+    }
+
+    timer.end();
+}
+
+void DepthPrepass::updateStats(int width, int height) {
+    if (m_stageTimers[0].hasResult()) {
+        m_stats.withoutPrepassMs = m_stageTimers[0].getAverage() / 1e6;
+    }
+    if (m_stageTimers[1].hasResult()) {
+        m_stats.withPrepassMs = m_stageTimers[1].getAverage() / 1e6;
+    }
+
+    if (m_samples.getResultCount() == m_samplesSeen) {
+        return;
+    }
+    m_samplesSeen = m_samples.getResultCount();
+
+    const double pixels = static_cast<double>(width) * static_cast<double>(height);
+    m_stats.overdraw = pixels > 0.0 ? static_cast<float>(m_samples.getResult() / pixels) : 0.0f;
+
+    if (m_autoEnabled ? m_stats.overdraw < DISABLE_OVERDRAW : m_stats.overdraw > ENABLE_OVERDRAW) {
+        m_autoEnabled = !m_autoEnabled;
+    }
+}
+
+}; // namespace prism
@@ -0,0 +1,109 @@
+#include "prism/dynamicResolution.hpp"
+
+#include <glad.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace prism {
+
+DynamicResolution::DynamicResolution() {}
+
+void DynamicResolution::setEnabled(bool enabled) {
+    m_enabled = enabled;
+    m_resultsToSkip = GPUQuery::RING_SIZE;
+}
+
+void DynamicResolution::setFixedScale(float scale) {
+    m_fixedScale = std::clamp(scale, MIN_SCALE, MAX_SCALE);
+}
+
+int DynamicResolution::scaleWidth(int width) const {
+    return std::max(static_cast<int>(std::lround(width * getScale())), 1);
+}
+
+int DynamicResolution::scaleHeight(int height) const {
+    return std::max(static_cast<int>(std::lround(height * getScale())), 1);
+}
+
+void DynamicResolution::beginFrame() {
+    // A pass came or went, the measurements in flight don't add up to a frame anymore
+    if (m_passIndex != m_passCount) {
+        m_passTimers.resize(m_passIndex);
+        m_passCount = m_passIndex;
+        m_resultsSeen = getResultCount();
+        m_resultsToSkip = GPUQuery::RING_SIZE;
+        m_frameTimeMs = 0.0;
+    }
+    m_passIndex = 0;
+
+    update();
+}
+
+void DynamicResolution::beginPass() {
+    if (m_passIndex == m_passTimers.size()) {
+        m_passTimers.push_back(std::make_unique<GPUQuery>(GL_TIMESTAMP));
+    }
+    m_passTimers[m_passIndex]->begin();
+}
+
+void DynamicResolution::endPass() {
+    m_passTimers[m_passIndex++]->end();
+}
+
+uint32_t DynamicResolution::getResultCount() const {
+    if (m_passTimers.empty()) {
+        return 0;
+    }
+
+    uint32_t resultCount = UINT32_MAX;
+    for (const auto& timer : m_passTimers) {
+        resultCount = std::min(resultCount, timer->getResultCount());
+    }
+    return resultCount;
+}
+
+void DynamicResolution::update() {
+    const uint32_t resultCount = getResultCount();
+    if (resultCount == m_resultsSeen) {
+        return;
+    }
+    // Several measurements may finish between two frames, only the latest one is kept
+    const uint32_t newResults = resultCount - m_resultsSeen;
+    m_resultsSeen = resultCount;
+
+    if (m_resultsToSkip > 0) {
+        const uint32_t skipped = std::min(newResults, m_resultsToSkip);
+        m_resultsToSkip -= skipped;
+        if (skipped == newResults) {
+            m_frameTimeMs = 0.0;
+            return;
+        }
+    }
+
+    double frameTime = 0.0;
+    for (const auto& timer : m_passTimers) {
+        frameTime += timer->getResult() / 1e6;
+    }
+    m_frameTimeMs = m_frameTimeMs == 0.0 ? frameTime : m_frameTimeMs + (frameTime - m_frameTimeMs) * AVERAGE_WEIGHT;
+
+    const double load = m_frameTimeMs / m_budgetMs;
+    if (!m_enabled || m_budgetMs <= 0.0f || (load <= SCALE_DOWN_LOAD && load >= SCALE_UP_LOAD)) {
+        return;
+    }
+
+    // The time follows the pixel count, the square of the scale
+    float scale = m_scale * static_cast<float>(std::sqrt(TARGET_LOAD / load));
+    scale = std::clamp(scale, m_scale - MAX_STEP, m_scale + MAX_STEP);
+    scale = std::round(scale / SCALE_GRANULARITY) * SCALE_GRANULARITY;
+    scale = std::clamp(scale, MIN_SCALE, MAX_SCALE);
+    if (scale == m_scale) {
+        return;
+    }
+
+    m_scale = scale;
+    m_changeCount++;
+    m_resultsToSkip = GPUQuery::RING_SIZE;
+}
+
+}; // namespace prism
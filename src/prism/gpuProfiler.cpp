@@ -0,0 +1,286 @@
+#include "prism/gpuProfiler.hpp"
+
+#include "cinder.hpp"
+
+#include <glad.h>
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <fstream>
+
+namespace prism {
+
+GPUProfiler::Scope::Scope(GPUProfiler* profiler, const std::string& name) : m_profiler(profiler) {
+    m_marker = m_profiler != nullptr ? m_profiler->begin(name) : NONE;
+}
+
+GPUProfiler::Scope::~Scope() {
+    if (m_profiler != nullptr) {
+        m_profiler->end(m_marker);
+    }
+}
+
+GPUProfiler::~GPUProfiler() {
+    release();
+}
+
+void GPUProfiler::release() {
+    for (PendingFrame& frame : m_frames) {
+        if (!frame.queries.empty()) {
+            glDeleteQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+        }
+        frame.queries.clear();
+        frame.markers.clear();
+        frame.pending = false;
+    }
+}
+
+void GPUProfiler::setEnabled(bool enabled) {
+    // Takes effect from the next frame, the recorded one is finished
+    m_enabled = enabled;
+}
+
+uint32_t GPUProfiler::findScope(const std::string& name) {
+    const auto it = m_scopeIndices.find(name);
+    if (it != m_scopeIndices.end()) {
+        return it->second;
+    }
+
+    const uint32_t index = static_cast<uint32_t>(m_scopeNames.size());
+    m_scopeNames.push_back(name);
+    m_scopeIndices.emplace(name, index);
+    return index;
+}
+
+void GPUProfiler::beginFrame(double cpuFrameTime) {
+    m_frameNumber++;
+    if (!m_enabled) {
+        return;
+    }
+
+    if (collect()) {
+        updateStats();
+    }
+
+    PendingFrame& frame = m_frames[m_current];
+    if (frame.pending) {
+        m_skipCount++;
+        return;
+    }
+
+    frame.number = m_frameNumber;
+    frame.cpuFrameTime = cpuFrameTime;
+    frame.markers.clear();
+    m_recording = true;
+
+    begin("Frame");
+}
+
+void GPUProfiler::endFrame() {
+    if (!m_recording) {
+        return;
+    }
+
+    // The frame marker is ended last, its timestamp finishes the frame
+    end(0);
+    m_frames[m_current].pending = true;
+    m_current = (m_current + 1) % RING_SIZE;
+    m_recording = false;
+}
+
+uint32_t GPUProfiler::begin(const std::string& name) {
+    if (!m_recording) {
+        return NONE;
+    }
+
+    PendingFrame& frame = m_frames[m_current];
+    const uint32_t marker = static_cast<uint32_t>(frame.markers.size());
+
+    // Created on first use, as the queries need a context
+    if (frame.queries.size() < (marker + 1) * 2) {
+        const size_t created = frame.queries.size();
+        frame.queries.resize(std::max<size_t>(created * 2, 16));
+        glCreateQueries(GL_TIMESTAMP, static_cast<GLsizei>(frame.queries.size() - created), frame.queries.data() + created);
+    }
+
+    frame.markers.push_back({ findScope(name), Clock::now() });
+    glQueryCounter(frame.queries[marker * 2], GL_TIMESTAMP);
+    return marker;
+}
+
+void GPUProfiler::end(uint32_t marker) {
+    if (!m_recording || marker == NONE) {
+        return;
+    }
+
+    PendingFrame& frame = m_frames[m_current];
+    Marker& recorded = frame.markers[marker];
+    glQueryCounter(frame.queries[marker * 2 + 1], GL_TIMESTAMP);
+    recorded.cpuTime = std::chrono::duration<float, std::milli>(Clock::now() - recorded.cpuBegin).count();
+}
+
+bool GPUProfiler::collect() {
+    // Frames finish in order, so the first unavailable one ends the search
+    bool finished = false;
+    for (uint32_t i = 0; i < RING_SIZE; i++) {
+        PendingFrame& frame = m_frames[(m_current + i) % RING_SIZE];
+        if (!frame.pending) {
+            continue;
+        }
+
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(frame.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == GL_FALSE) {
+            break;
+        }
+
+        resolve(frame);
+        frame.pending = false;
+        finished = true;
+    }
+    return finished;
+}
+
+void GPUProfiler::resolve(PendingFrame& frame) {
+    FrameRecord* record = nullptr;
+    if (m_history.size() < HISTORY_SIZE) {
+        record = &m_history.emplace_back();
+    } else {
+        record = &m_history[m_historyNext];
+    }
+    m_historyNext = (m_historyNext + 1) % HISTORY_SIZE;
+    m_finishedFrames++;
+
+    record->number = frame.number;
+    record->cpuFrameTime = frame.cpuFrameTime;
+    record->gpuTimes.assign(m_scopeNames.size(), -1.0f);
+    record->cpuTimes.assign(m_scopeNames.size(), -1.0f);
+
+    for (uint32_t i = 0; i < frame.markers.size(); i++) {
+        const Marker& marker = frame.markers[i];
+        // A scope left open has no end timestamp to read
+        if (marker.cpuTime < 0.0f) {
+            continue;
+        }
+
+        GLuint64 begin = 0;
+        GLuint64 end   = 0;
+        glGetQueryObjectui64v(frame.queries[i * 2    ], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(frame.queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+        const float gpuTime = static_cast<float>(static_cast<double>(end - begin) / 1e6);
+
+        // Scopes with the same name in a frame add up
+        float& gpuTotal = record->gpuTimes[marker.scope];
+        float& cpuTotal = record->cpuTimes[marker.scope];
+        gpuTotal = gpuTotal < 0.0f ? gpuTime : gpuTotal + gpuTime;
+        cpuTotal = cpuTotal < 0.0f ? marker.cpuTime : cpuTotal + marker.cpuTime;
+    }
+}
+
+const GPUProfiler::FrameRecord& GPUProfiler::getRecord(uint32_t index) const {
+    if (m_history.size() < HISTORY_SIZE) {
+        return m_history[index];
+    }
+    return m_history[(m_historyNext + index) % HISTORY_SIZE];
+}
+
+/**
+ * @brief The nearest-rank percentile of sorted values.
+ */
+static float percentile(const std::vector<float>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0.0f;
+    }
+    const size_t rank = static_cast<size_t>(std::ceil(fraction * static_cast<double>(sorted.size())));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+/**
+ * @brief Averages and sorts the values, for the percentiles.
+ */
+static float average(std::vector<float>& values) {
+    if (values.empty()) {
+        return 0.0f;
+    }
+
+    double sum = 0.0;
+    for (const float value : values) {
+        sum += value;
+    }
+    std::sort(values.begin(), values.end());
+    return static_cast<float>(sum / static_cast<double>(values.size()));
+}
+
+void GPUProfiler::updateStats() {
+    m_stats.resize(m_scopeNames.size());
+
+    std::vector<float> gpuTimes;
+    std::vector<float> cpuTimes;
+    const FrameRecord& latest = getRecord(static_cast<uint32_t>(m_history.size()) - 1);
+    for (uint32_t scope = 0; scope < m_scopeNames.size(); scope++) {
+        gpuTimes.clear();
+        cpuTimes.clear();
+        for (uint32_t i = 0; i < m_history.size(); i++) {
+            const FrameRecord& record = getRecord(i);
+            if (scope < record.gpuTimes.size() && record.gpuTimes[scope] >= 0.0f) {
+                gpuTimes.push_back(record.gpuTimes[scope]);
+                cpuTimes.push_back(record.cpuTimes[scope]);
+            }
+        }
+
+        ProfilerScopeStats& stats = m_stats[scope];
+        stats.name       = m_scopeNames[scope];
+        stats.samples    = static_cast<uint32_t>(gpuTimes.size());
+        stats.gpuLast    = scope < latest.gpuTimes.size() ? std::max(latest.gpuTimes[scope], 0.0f) : 0.0f;
+        stats.gpuAverage = average(gpuTimes);
+        stats.gpuP95     = percentile(gpuTimes, 0.95);
+        stats.gpuP99     = percentile(gpuTimes, 0.99);
+        stats.cpuAverage = average(cpuTimes);
+        stats.cpuP95     = percentile(cpuTimes, 0.95);
+        stats.cpuP99     = percentile(cpuTimes, 0.99);
+    }
+}
+
+std::vector<float> GPUProfiler::getFrameHistory() const {
+    std::vector<float> times;
+    times.reserve(m_history.size());
+    for (uint32_t i = 0; i < m_history.size(); i++) {
+        const FrameRecord& record = getRecord(i);
+        times.push_back(record.gpuTimes.empty() ? 0.0f : std::max(record.gpuTimes[0], 0.0f));
+    }
+    return times;
+}
+
+bool GPUProfiler::exportCSV(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        cinder::error(std::format("Failed to open profile export: {}", path));
+        return false;
+    }
+
+    file << "frame,cpu_frame_ms";
+    for (const std::string& name : m_scopeNames) {
+        file << std::format(",\"{} gpu_ms\",\"{} cpu_ms\"", name, name);
+    }
+    file << '\n';
+
+    // Scopes that didn't run in a frame are left empty
+    for (uint32_t i = 0; i < m_history.size(); i++) {
+        const FrameRecord& record = getRecord(i);
+        file << std::format("{},{:.4f}", record.number, record.cpuFrameTime);
+        for (uint32_t scope = 0; scope < m_scopeNames.size(); scope++) {
+            if (scope < record.gpuTimes.size() && record.gpuTimes[scope] >= 0.0f) {
+                file << std::format(",{:.4f},{:.4f}", record.gpuTimes[scope], record.cpuTimes[scope]);
+            } else {
+                file << ",,";
+            }
+        }
+        file << '\n';
+    }
+
+    cinder::log(std::format("Exported {} profiled frames to {}", m_history.size(), path));
+    return true;
+}
+
+}; // namespace prism
@@ -0,0 +1,87 @@
+#include "prism/gpuQuery.hpp"
+
+#include <glad.h>
+
+namespace prism {
+
+GPUQuery::GPUQuery(uint32_t target) : m_target(target) {}
+
+GPUQuery::~GPUQuery() {
+    if (m_queries[0] != 0) {
+        glDeleteQueries(isTimestamp() ? RING_SIZE * 2 : RING_SIZE, m_queries.data());
+    }
+}
+
+bool GPUQuery::isTimestamp() const {
+    return m_target == GL_TIMESTAMP;
+}
+
+void GPUQuery::collect() {
+    // Queries finish in order, so the first unavailable one ends the search
+    for (uint32_t i = 0; i < RING_SIZE; i++) {
+        const uint32_t slot = (m_next + i) % RING_SIZE;
+        if (!m_pending[slot]) {
+            continue;
+        }
+
+        // The end of a timestamp pair finishes last
+        const uint32_t last = isTimestamp() ? m_queries[RING_SIZE + slot] : m_queries[slot];
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(last, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == GL_FALSE) {
+            break;
+        }
+
+        GLuint64 result = 0;
+        glGetQueryObjectui64v(m_queries[slot], GL_QUERY_RESULT, &result);
+        if (isTimestamp()) {
+            GLuint64 end = 0;
+            glGetQueryObjectui64v(last, GL_QUERY_RESULT, &end);
+            result = end - result;
+        }
+        m_pending[slot] = false;
+
+        m_result = result;
+        m_average = m_resultCount == 0 ?
+            static_cast<double>(result) :
+            m_average + (static_cast<double>(result) - m_average) * AVERAGE_WEIGHT;
+        m_resultCount++;
+    }
+}
+
+void GPUQuery::begin() {
+    // Created on first use, as the queries need a context
+    if (m_queries[0] == 0) {
+        glCreateQueries(m_target, isTimestamp() ? RING_SIZE * 2 : RING_SIZE, m_queries.data());
+    }
+
+    collect();
+    if (m_pending[m_next]) {
+        m_skipCount++;
+        return;
+    }
+
+    if (isTimestamp()) {
+        glQueryCounter(m_queries[m_next], GL_TIMESTAMP);
+    } else {
+        glBeginQuery(m_target, m_queries[m_next]);
+    }
+    m_active = true;
+}
+
+void GPUQuery::end() {
+    if (!m_active) {
+        return;
+    }
+
+    if (isTimestamp()) {
+        glQueryCounter(m_queries[RING_SIZE + m_next], GL_TIMESTAMP);
+    } else {
+        glEndQuery(m_target);
+    }
+    m_pending[m_next] = true;
+    m_next = (m_next + 1) % RING_SIZE;
+    m_active = false;
+}
+
+}; // namespace prism
@@ -0,0 +1,111 @@
+#include "prism/objectBuffer.hpp"
+#include "renderDevice.hpp"
+
+#include <glad.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace prism {
+
+ObjectBuffer::~ObjectBuffer() {
+    cinder::RenderDevice::deleteBuffer(m_bufferHandle);
+}
+
+uint32_t ObjectBuffer::allocate() {
+    uint32_t slot;
+    if (!m_freeSlots.empty()) {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(m_objects.size());
+        m_objects.emplace_back();
+        m_dirtyFlags.push_back(false);
+    }
+
+    m_objects[slot] = ObjectData();
+    markDirty(slot);
+    return slot;
+}
+
+void ObjectBuffer::release(uint32_t slot) {
+    if (slot >= m_objects.size()) {
+        return;
+    }
+    m_freeSlots.push_back(slot);
+}
+
+void ObjectBuffer::markDirty(uint32_t slot) {
+    if (m_dirtyFlags[slot]) {
+        return;
+    }
+    m_dirtyFlags[slot] = true;
+    m_dirtySlots.push_back(slot);
+}
+
+void ObjectBuffer::update(uint32_t slot, const matrix4x4f& modelMatrix, const matrix4x4f& previousModelMatrix, uint32_t materialIndex) {
+    ObjectData& object = m_objects[slot];
+    if (object.materialIndex == materialIndex &&
+        std::memcmp(&object.modelMatrix, &modelMatrix, sizeof(matrix4x4f)) == 0 &&
+        std::memcmp(&object.previousModelMatrix, &previousModelMatrix, sizeof(matrix4x4f)) == 0) {
+        return;
+    }
+
+    object.modelMatrix = modelMatrix;
+    object.previousModelMatrix = previousModelMatrix;
+    object.materialIndex = materialIndex;
+    markDirty(slot);
+}
+
+void ObjectBuffer::upload() {
+    m_lastUploadedCount = 0;
+    m_lastUploadRanges = 0;
+
+    // Grown buffers are re-sent entirely
+    if (m_objects.size() > m_bufferCapacity) {
+        cinder::RenderDevice::deleteBuffer(m_bufferHandle);
+
+        m_bufferCapacity = std::max(m_objects.size(), m_bufferCapacity * 2);
+        glCreateBuffers(1, &m_bufferHandle);
+        glNamedBufferStorage(m_bufferHandle, m_bufferCapacity * sizeof(ObjectData), nullptr, GL_DYNAMIC_STORAGE_BIT);
+        glNamedBufferSubData(m_bufferHandle, 0, m_objects.size() * sizeof(ObjectData), m_objects.data());
+
+        for (const uint32_t slot : m_dirtySlots) {
+            m_dirtyFlags[slot] = false;
+        }
+        m_dirtySlots.clear();
+        m_lastUploadedCount = static_cast<uint32_t>(m_objects.size());
+        m_lastUploadRanges = 1;
+    }
+
+    if (!m_dirtySlots.empty()) {
+        std::sort(m_dirtySlots.begin(), m_dirtySlots.end());
+
+        size_t first = 0;
+        while (first < m_dirtySlots.size()) {
+            size_t last = first;
+            while (last + 1 < m_dirtySlots.size() && m_dirtySlots[last + 1] - m_dirtySlots[last] <= MERGE_GAP) {
+                last++;
+            }
+
+            const uint32_t begin = m_dirtySlots[first];
+            const uint32_t count = m_dirtySlots[last] - begin + 1;
+            glNamedBufferSubData(m_bufferHandle, begin * sizeof(ObjectData), count * sizeof(ObjectData), &m_objects[begin]);
+            m_lastUploadedCount += count;
+            m_lastUploadRanges++;
+
+            first = last + 1;
+        }
+
+        for (const uint32_t slot : m_dirtySlots) {
+            m_dirtyFlags[slot] = false;
+        }
+        m_dirtySlots.clear();
+    }
+
+    if (m_bufferHandle != 0) {
+        cinder::RenderDevice::bindBufferBase(GL_SHADER_STORAGE_BUFFER, BINDING, m_bufferHandle);
+    }
+}
+
+}; // namespace prism
@@ -0,0 +1,156 @@
+#include "prism/occlusionCulling.hpp"
+
+#include "cinder.hpp"
+#include "app.hpp"
+#include "renderDevice.hpp"
+#include "prism/renderQueue.hpp"
+
+#include <glad.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <format>
+
+namespace prism {
+
+OcclusionCulling::~OcclusionCulling() {
+    cinder::RenderDevice::deleteTexture(m_pyramidTexture);
+}
+
+void OcclusionCulling::setEnabled(bool enabled) {
+    m_enabled = enabled;
+    if (!enabled) {
+        invalidate();
+    }
+}
+
+bool OcclusionCulling::isReady() const {
+    return m_enabled && m_pyramidValid &&
+        m_cullingShader != nullptr && m_cullingShader->isInitialized();
+}
+
+void OcclusionCulling::resize(int width, int height) {
+    // Level 0 is already reduced, the depth itself is read only once
+    const uint32_t levelWidth  = std::max(width  / 2, 1);
+    const uint32_t levelHeight = std::max(height / 2, 1);
+    if (levelWidth == m_pyramidWidth && levelHeight == m_pyramidHeight && m_pyramidTexture != 0) {
+        return;
+    }
+
+    cinder::RenderDevice::deleteTexture(m_pyramidTexture);
+    m_pyramidWidth  = levelWidth;
+    m_pyramidHeight = levelHeight;
+    m_pyramidValid  = false;
+
+    glCreateTextures(GL_TEXTURE_2D, 1, &m_pyramidTexture);
+    glTextureStorage2D(m_pyramidTexture, std::bit_width(std::max(levelWidth, levelHeight)), GL_RG32F, levelWidth, levelHeight);
+    glTextureParameteri(m_pyramidTexture, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTextureParameteri(m_pyramidTexture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    cinder::log(std::format("Depth pyramid resized to {}x{}.", levelWidth, levelHeight));
+}
+
+void OcclusionCulling::buildPyramid(uint32_t depthTexture, int width, int height, const matrix4x4f& viewProjection) {
+    if (!m_enabled || m_pyramidTexture == 0 || m_pyramidShader == nullptr || !m_pyramidShader->isInitialized()) {
+        return;
+    }
+
+    // Only the levels of the rendered area are built, in the corner of the allocated ones
+    width  = std::clamp(width , 1, static_cast<int>(m_pyramidWidth ) * 2 + 1);
+    height = std::clamp(height, 1, static_cast<int>(m_pyramidHeight) * 2 + 1);
+    uint32_t sourceWidth  = width;
+    uint32_t sourceHeight = height;
+    uint32_t levelWidth   = std::max(width  / 2, 1);
+    uint32_t levelHeight  = std::max(height / 2, 1);
+    m_levels = std::bit_width(std::max(levelWidth, levelHeight));
+    m_stats.pyramidWidth  = levelWidth;
+    m_stats.pyramidHeight = levelHeight;
+    m_stats.pyramidLevels = m_levels;
+
+    m_pyramidShader->bind();
+    cinder::RenderDevice::bindTexture(0, depthTexture);
+    m_pyramidShader->setUniform("depthTexture", 0);
+
+    for (uint32_t level = 0; level < m_levels; level++) {
+        // Every level reduces the one below, the first one the depth buffer
+        m_pyramidShader->setUniform("fromDepth", level == 0 ? 1 : 0);
+        m_pyramidShader->setUniform("sourceWidth", static_cast<int>(sourceWidth));
+        m_pyramidShader->setUniform("sourceHeight", static_cast<int>(sourceHeight));
+        m_pyramidShader->setUniform("levelWidth", static_cast<int>(levelWidth));
+        m_pyramidShader->setUniform("levelHeight", static_cast<int>(levelHeight));
+        if (level > 0) {
+            glBindImageTexture(0, m_pyramidTexture, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_RG32F);
+        }
+        glBindImageTexture(1, m_pyramidTexture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_RG32F);
+
+        m_pyramidShader->dispatch(
+            (levelWidth  + PYRAMID_GROUP_SIZE - 1) / PYRAMID_GROUP_SIZE,
+            (levelHeight + PYRAMID_GROUP_SIZE - 1) / PYRAMID_GROUP_SIZE
+        );
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+        sourceWidth  = levelWidth;
+        sourceHeight = levelHeight;
+        levelWidth   = std::max(levelWidth  / 2, 1u);
+        levelHeight  = std::max(levelHeight / 2, 1u);
+    }
+
+    // The culling reads it through texel fetches
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    m_depthWidth  = width;
+    m_depthHeight = height;
+    m_viewProjection = viewProjection;
+    m_pyramidValid = true;
+}
+
+codex::StreamAllocation OcclusionCulling::cull(const codex::StreamAllocation& draws, const std::vector<CullData>& cullData, const codex::StreamAllocation& commands, uint32_t commandCount) {
+    const uint32_t instanceCount = static_cast<uint32_t>(cullData.size());
+    m_stats.testedInstances = 0;
+    if (!isReady() || instanceCount == 0 || commandCount == 0) {
+        return {};
+    }
+
+    auto* streamBuffer = cinder::app->getStreamBuffer();
+    auto bounds   = streamBuffer->allocate(instanceCount * sizeof(CullData), GL_SHADER_STORAGE_BUFFER);
+    auto counters = streamBuffer->allocate(instanceCount * sizeof(uint32_t), GL_SHADER_STORAGE_BUFFER);
+    auto visible  = streamBuffer->allocate(instanceCount * sizeof(DrawData), GL_SHADER_STORAGE_BUFFER);
+    if (!bounds.isValid() || !counters.isValid() || !visible.isValid()) {
+        return {};
+    }
+
+    // The counters are indexed by the base instance of the commands
+    std::memcpy(bounds.pointer, cullData.data(), bounds.size);
+    std::memset(counters.pointer, 0, counters.size);
+
+    cinder::RenderDevice::bindBufferRange(GL_SHADER_STORAGE_BUFFER, RenderQueue::DRAW_BUFFER_BINDING, draws.buffer, draws.offset, draws.size);
+    cinder::RenderDevice::bindBufferRange(GL_SHADER_STORAGE_BUFFER, CULL_DATA_BINDING, bounds.buffer, bounds.offset, bounds.size);
+    cinder::RenderDevice::bindBufferRange(GL_SHADER_STORAGE_BUFFER, VISIBLE_DRAW_BINDING, visible.buffer, visible.offset, visible.size);
+    cinder::RenderDevice::bindBufferRange(GL_SHADER_STORAGE_BUFFER, COUNTER_BINDING, counters.buffer, counters.offset, counters.size);
+    cinder::RenderDevice::bindBufferRange(GL_SHADER_STORAGE_BUFFER, COMMAND_BINDING, commands.buffer, commands.offset, commandCount * sizeof(DrawElementsIndirectCommand));
+    cinder::RenderDevice::bindTexture(0, m_pyramidTexture);
+
+    m_cullingShader->bind();
+    m_cullingShader->setUniform("depthPyramid", 0);
+    m_cullingShader->setUniform("pyramidLevels", static_cast<int>(m_levels));
+    m_cullingShader->setUniform("depthWidth", m_depthWidth);
+    m_cullingShader->setUniform("depthHeight", m_depthHeight);
+    m_cullingShader->setUniform("viewProjection", m_viewProjection);
+
+    // First the instances are tested and compacted, then the counts are written into the commands
+    m_cullingShader->setUniform("writeCommands", 0);
+    m_cullingShader->setUniform("itemCount", static_cast<int>(instanceCount));
+    m_cullingShader->dispatch((instanceCount + GROUP_SIZE - 1) / GROUP_SIZE);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    m_cullingShader->setUniform("writeCommands", 1);
+    m_cullingShader->setUniform("itemCount", static_cast<int>(commandCount));
+    m_cullingShader->dispatch((commandCount + GROUP_SIZE - 1) / GROUP_SIZE);
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+    m_stats.testedInstances = instanceCount;
+    return visible;
+}
+
+}; // namespace prism
@@ -0,0 +1,444 @@
+#include "cinder.hpp"
+#include "prism/renderGraph.hpp"
+#include "prism/gpuProfiler.hpp"
+#include "renderDevice.hpp"
+
+#include <glad.h>
+
+#include <algorithm>
+#include <format>
+
+namespace prism {
+
+uint32_t RenderGraphContext::getTexture(const std::string& name) const {
+    return m_graph->getTexture(name);
+}
+
+// Pass builder
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::read(const std::string& name) {
+    const uint32_t resource = m_graph->findResource(name);
+    if (resource == NONE) {
+        cinder::warn(std::format("Render pass \"{}\" reads the unknown resource \"{}\".", m_graph->m_passes[m_pass].name, name));
+        return *this;
+    }
+
+    m_graph->m_passes[m_pass].reads.push_back(resource);
+    m_graph->m_resources[resource].readers.push_back(m_pass);
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::write(const std::string& name) {
+    const uint32_t resource = m_graph->findResource(name);
+    if (resource == NONE) {
+        cinder::warn(std::format("Render pass \"{}\" writes the unknown resource \"{}\".", m_graph->m_passes[m_pass].name, name));
+        return *this;
+    }
+
+    m_graph->m_passes[m_pass].writes.push_back(resource);
+    m_graph->m_resources[resource].writers.push_back(m_pass);
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::attach(const std::string& name) {
+    const uint32_t resource = m_graph->findResource(name);
+    if (resource == NONE) {
+        cinder::warn(std::format("Render pass \"{}\" attaches the unknown resource \"{}\".", m_graph->m_passes[m_pass].name, name));
+        return *this;
+    }
+
+    m_graph->m_passes[m_pass].attachments.push_back(resource);
+    m_graph->m_resources[resource].writers.push_back(m_pass);
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::sideEffect() {
+    m_graph->m_passes[m_pass].sideEffect = true;
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::viewport(int width, int height) {
+    m_graph->m_passes[m_pass].viewportWidth  = width;
+    m_graph->m_passes[m_pass].viewportHeight = height;
+    return *this;
+}
+
+// Render graph
+
+RenderGraph::~RenderGraph() {
+    for (const auto& [attachments, framebuffer] : m_framebuffers) {
+        cinder::RenderDevice::deleteFramebuffer(framebuffer);
+    }
+    for (const PhysicalTexture& texture : m_textures) {
+        cinder::RenderDevice::deleteTexture(texture.handle);
+    }
+}
+
+void RenderGraph::reset() {
+    m_resources.clear();
+    m_resourceIndices.clear();
+    m_passes.clear();
+    m_output = NONE;
+
+    for (PhysicalTexture& texture : m_textures) {
+        texture.inUse = false;
+    }
+}
+
+uint32_t RenderGraph::findResource(const std::string& name) const {
+    const auto it = m_resourceIndices.find(name);
+    return it != m_resourceIndices.end() ? it->second : NONE;
+}
+
+uint32_t RenderGraph::declareResource(const std::string& name, const TextureDesc& desc) {
+    if (findResource(name) != NONE) {
+        cinder::warn(std::format("Render graph resource \"{}\" declared twice.", name));
+        return findResource(name);
+    }
+
+    const uint32_t index = static_cast<uint32_t>(m_resources.size());
+    m_resources.push_back({ name, desc });
+    m_resourceIndices[name] = index;
+    return index;
+}
+
+void RenderGraph::createTexture(const std::string& name, const TextureDesc& desc) {
+    declareResource(name, desc);
+}
+
+void RenderGraph::importTexture(const std::string& name, uint32_t texture, const TextureDesc& desc) {
+    Resource& resource = m_resources[declareResource(name, desc)];
+    resource.imported = true;
+    resource.texture  = texture;
+}
+
+RenderGraph::PassBuilder RenderGraph::addPass(const std::string& name, ExecuteFunction execute) {
+    m_passes.push_back({ name, std::move(execute) });
+    return PassBuilder(this, static_cast<uint32_t>(m_passes.size() - 1));
+}
+
+void RenderGraph::setOutput(const std::string& name) {
+    m_output = findResource(name);
+    if (m_output == NONE) {
+        cinder::warn(std::format("Render graph output \"{}\" is not a resource.", name));
+    }
+}
+
+uint32_t RenderGraph::getTexture(const std::string& name) const {
+    const uint32_t resource = findResource(name);
+    return resource != NONE ? m_resources[resource].texture : 0;
+}
+
+/*
+ * Reads see the final contents of a resource, so a pass reading it depends on every writer.
+ * Writers of the same resource build on each other, in the order they were declared.
+ */
+void RenderGraph::cull() {
+    for (Pass& pass : m_passes) {
+        pass.culled = true;
+    }
+
+    std::vector<uint32_t> stack;
+    auto markLive = [&](uint32_t pass) {
+        if (m_passes[pass].culled) {
+            m_passes[pass].culled = false;
+            stack.push_back(pass);
+        }
+    };
+
+    if (m_output != NONE) {
+        for (const uint32_t writer : m_resources[m_output].writers) {
+            markLive(writer);
+        }
+    }
+    for (uint32_t i = 0; i < m_passes.size(); i++) {
+        if (m_passes[i].sideEffect) {
+            markLive(i);
+        }
+    }
+
+    while (!stack.empty()) {
+        const uint32_t current = stack.back();
+        stack.pop_back();
+        const Pass& pass = m_passes[current];
+
+        for (const uint32_t resource : pass.reads) {
+            for (const uint32_t writer : m_resources[resource].writers) {
+                markLive(writer);
+            }
+        }
+        for (const auto* written : { &pass.writes, &pass.attachments }) {
+            for (const uint32_t resource : *written) {
+                for (const uint32_t writer : m_resources[resource].writers) {
+                    if (writer < current) {
+                        markLive(writer);
+                    }
+                }
+            }
+        }
+    }
+}
+
+std::vector<uint32_t> RenderGraph::sortPasses() const {
+    const uint32_t count = static_cast<uint32_t>(m_passes.size());
+
+    std::vector<std::vector<uint32_t>> dependents(count);
+    std::vector<uint32_t> dependencyCount(count, 0);
+    auto addEdge = [&](uint32_t from, uint32_t to) {
+        if (from == to || m_passes[from].culled) {
+            return;
+        }
+        dependents[from].push_back(to);
+        dependencyCount[to]++;
+    };
+
+    for (uint32_t i = 0; i < count; i++) {
+        const Pass& pass = m_passes[i];
+        if (pass.culled) {
+            continue;
+        }
+
+        for (const uint32_t resource : pass.reads) {
+            for (const uint32_t writer : m_resources[resource].writers) {
+                addEdge(writer, i);
+            }
+        }
+        for (const auto* written : { &pass.writes, &pass.attachments }) {
+            for (const uint32_t resource : *written) {
+                for (const uint32_t writer : m_resources[resource].writers) {
+                    if (writer < i) {
+                        addEdge(writer, i);
+                    }
+                }
+            }
+        }
+    }
+
+    // Kahn's algorithm, ties are broken by declaration order
+    std::vector<uint32_t> order;
+    std::vector<bool> scheduled(count, false);
+    while (true) {
+        uint32_t next = NONE;
+        for (uint32_t i = 0; i < count; i++) {
+            if (!m_passes[i].culled && !scheduled[i] && dependencyCount[i] == 0) {
+                next = i;
+                break;
+            }
+        }
+        if (next == NONE) {
+            break;
+        }
+
+        scheduled[next] = true;
+        order.push_back(next);
+        for (const uint32_t dependent : dependents[next]) {
+            dependencyCount[dependent]--;
+        }
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (!m_passes[i].culled && !scheduled[i]) {
+            cinder::warn(std::format("Render pass \"{}\" is part of a dependency cycle, skipped.", m_passes[i].name));
+        }
+    }
+
+    return order;
+}
+
+void RenderGraph::execute() {
+    m_stats = {};
+    m_stats.passes = static_cast<uint32_t>(m_passes.size());
+    m_executedPasses.clear();
+
+    cull();
+    const std::vector<uint32_t> order = sortPasses();
+    m_stats.culledPasses = m_stats.passes - static_cast<uint32_t>(order.size());
+
+    // Lifetimes in execution order
+    for (uint32_t i = 0; i < order.size(); i++) {
+        const Pass& pass = m_passes[order[i]];
+        for (const auto* used : { &pass.reads, &pass.writes, &pass.attachments }) {
+            for (const uint32_t index : *used) {
+                Resource& resource = m_resources[index];
+                if (resource.firstUse == NONE) {
+                    resource.firstUse = i;
+                }
+                resource.lastUse = i;
+            }
+        }
+    }
+
+    std::vector<uint32_t> usedTextures;
+    for (uint32_t i = 0; i < order.size(); i++) {
+        Pass& pass = m_passes[order[i]];
+
+        for (Resource& resource : m_resources) {
+            if (resource.firstUse != i || resource.imported) {
+                continue;
+            }
+            resource.texture = acquireTexture(resource.desc);
+            m_stats.transients++;
+            m_stats.transientBytes += textureSize(resource.desc);
+            if (std::find(usedTextures.begin(), usedTextures.end(), resource.texture) == usedTextures.end()) {
+                usedTextures.push_back(resource.texture);
+                m_stats.physicalBytes += textureSize(resource.desc);
+            }
+        }
+
+        uint32_t framebuffer = 0;
+        if (!pass.attachments.empty()) {
+            framebuffer = getFramebuffer(pass.attachments);
+            const TextureDesc& desc = m_resources[pass.attachments[0]].desc;
+            cinder::RenderDevice::setViewport(0, 0,
+                pass.viewportWidth  > 0 ? pass.viewportWidth  : desc.width,
+                pass.viewportHeight > 0 ? pass.viewportHeight : desc.height);
+        }
+        cinder::RenderDevice::bindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+        {
+            GPUProfiler::Scope scope(m_profiler, pass.name);
+            pass.execute(RenderGraphContext(this, framebuffer));
+        }
+        m_executedPasses.push_back(pass.name);
+
+        // The output outlives the frame, it is shown after the graph ran
+        for (uint32_t index = 0; index < m_resources.size(); index++) {
+            const Resource& resource = m_resources[index];
+            if (resource.lastUse == i && !resource.imported && index != m_output) {
+                releaseTexture(resource.texture);
+            }
+        }
+    }
+
+    cinder::RenderDevice::bindFramebuffer(GL_FRAMEBUFFER, 0);
+    m_stats.physicalTextures = static_cast<uint32_t>(usedTextures.size());
+
+    destroyUnusedTextures();
+}
+
+uint32_t RenderGraph::acquireTexture(const TextureDesc& desc) {
+    for (PhysicalTexture& texture : m_textures) {
+        if (!texture.inUse && texture.desc == desc) {
+            texture.inUse = true;
+            texture.usedThisFrame = true;
+            return texture.handle;
+        }
+    }
+
+    uint32_t handle = 0;
+    glCreateTextures(GL_TEXTURE_2D, 1, &handle);
+    glTextureStorage2D(handle, 1, desc.format, desc.width, desc.height);
+    glTextureParameteri(handle, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTextureParameteri(handle, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(handle, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(handle, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    m_textures.push_back({ desc, handle, true, true });
+    return handle;
+}
+
+void RenderGraph::releaseTexture(uint32_t handle) {
+    for (PhysicalTexture& texture : m_textures) {
+        if (texture.handle == handle) {
+            texture.inUse = false;
+            return;
+        }
+    }
+}
+
+void RenderGraph::destroyUnusedTextures() {
+    for (auto it = m_textures.begin(); it != m_textures.end();) {
+        if (it->usedThisFrame) {
+            it->usedThisFrame = false;
+            it++;
+            continue;
+        }
+
+        // The framebuffers would keep the texture alive
+        const uint32_t handle = it->handle;
+        for (auto framebuffer = m_framebuffers.begin(); framebuffer != m_framebuffers.end();) {
+            if (std::find(framebuffer->first.begin(), framebuffer->first.end(), handle) != framebuffer->first.end()) {
+                cinder::RenderDevice::deleteFramebuffer(framebuffer->second);
+                framebuffer = m_framebuffers.erase(framebuffer);
+            } else {
+                framebuffer++;
+            }
+        }
+
+        cinder::RenderDevice::deleteTexture(handle);
+        it = m_textures.erase(it);
+    }
+}
+
+uint32_t RenderGraph::getFramebuffer(const std::vector<uint32_t>& attachments) {
+    std::vector<uint32_t> key;
+    for (const uint32_t resource : attachments) {
+        key.push_back(m_resources[resource].texture);
+    }
+
+    const auto it = m_framebuffers.find(key);
+    if (it != m_framebuffers.end()) {
+        return it->second;
+    }
+
+    uint32_t framebuffer = 0;
+    glCreateFramebuffers(1, &framebuffer);
+
+    std::vector<GLenum> drawBuffers;
+    for (const uint32_t index : attachments) {
+        const Resource& resource = m_resources[index];
+        if (isDepthFormat(resource.desc.format)) {
+            const bool stencil = resource.desc.format == GL_DEPTH24_STENCIL8 || resource.desc.format == GL_DEPTH32F_STENCIL8;
+            glNamedFramebufferTexture(framebuffer, stencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT, resource.texture, 0);
+            continue;
+        }
+
+        const GLenum attachment = GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(drawBuffers.size());
+        glNamedFramebufferTexture(framebuffer, attachment, resource.texture, 0);
+        drawBuffers.push_back(attachment);
+    }
+
+    if (drawBuffers.empty()) {
+        glNamedFramebufferDrawBuffer(framebuffer, GL_NONE);
+    } else {
+        glNamedFramebufferDrawBuffers(framebuffer, static_cast<GLsizei>(drawBuffers.size()), drawBuffers.data());
+    }
+
+    if (glCheckNamedFramebufferStatus(framebuffer, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        cinder::error("Render graph framebuffer is not complete!");
+    }
+
+    m_framebuffers[key] = framebuffer;
+    return framebuffer;
+}
+
+uint64_t RenderGraph::textureSize(const TextureDesc& desc) {
+    uint64_t bytesPerPixel;
+    switch (desc.format) {
+        case GL_R8:                 bytesPerPixel = 1;  break;
+        case GL_RG8:
+        case GL_R16F:               bytesPerPixel = 2;  break;
+        case GL_RGBA32F:            bytesPerPixel = 16; break;
+        case GL_RGBA16F:
+        case GL_RG32F:
+        case GL_DEPTH32F_STENCIL8:  bytesPerPixel = 8;  break;
+        default:                    bytesPerPixel = 4;  break;
+    }
+    return bytesPerPixel * desc.width * desc.height;
+}
+
+bool RenderGraph::isDepthFormat(uint32_t format) {
+    switch (format) {
+        case GL_DEPTH_COMPONENT16:
+        case GL_DEPTH_COMPONENT24:
+        case GL_DEPTH_COMPONENT32:
+        case GL_DEPTH_COMPONENT32F:
+        case GL_DEPTH24_STENCIL8:
+        case GL_DEPTH32F_STENCIL8:
+            return true;
+        default:
+            return false;
+    }
+}
+
+}; // namespace prism
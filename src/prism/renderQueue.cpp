@@ -0,0 +1,309 @@
+#include "prism/renderQueue.hpp"
+#include "prism/view.hpp"
+#include "renderDevice.hpp"
+#include "cinder.hpp"
+
+#include <glad.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace prism {
+
+void RenderQueue::clear() {
+    m_packets.clear();
+    m_keys.clear();
+}
+
+void RenderQueue::push(const DrawPacket& packet, RenderPass pass, float depth) {
+    m_packets.push_back(packet);
+    m_keys.push_back(makeKey(pass, packet, depth));
+}
+
+uint64_t RenderQueue::makeKey(RenderPass pass, const DrawPacket& packet, float depth) {
+    const uint64_t shaderID   = packet.shader   != nullptr ? packet.shader->getResourceID()   : 0;
+    const uint64_t materialID = packet.material != nullptr ? packet.material->getResourceID() : 0;
+    const uint64_t meshID     = packet.mesh     != nullptr ? packet.mesh->getResourceID()     : 0;
+    // The ids are dense per type, the fields fit 4096 shaders and materials and 65536 meshes
+    // before aliasing, which would only interleave their draws, not break them
+
+    // The bit pattern of positive floats orders the same way as their values,
+    // the exponent and the top of the mantissa is enough for sorting front to back
+    uint32_t depthBits;
+    depth = SDL_max(depth, 0.0f);
+    std::memcpy(&depthBits, &depth, sizeof(float));
+
+    return (static_cast<uint64_t>(pass & 0xF) << 60) |
+           ((shaderID   & 0xFFF ) << 48) |
+           ((materialID & 0xFFF ) << 36) |
+           ((meshID     & 0xFFFF) << 20) |
+           static_cast<uint64_t>(depthBits >> 12);
+}
+
+void RenderQueue::sort() {
+    const uint32_t count = static_cast<uint32_t>(m_keys.size());
+
+    m_order.resize(count);
+    m_scratch.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+        m_order[i] = i;
+    }
+
+    if (count < 2) {
+        return;
+    }
+
+    // All the histograms in a single pass over the keys
+    std::array<std::array<uint32_t, 256>, 8> histograms = {};
+    for (const uint64_t key : m_keys) {
+        for (int pass = 0; pass < 8; pass++) {
+            histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+        }
+    }
+
+    for (int pass = 0; pass < 8; pass++) {
+        auto& histogram = histograms[pass];
+        const int shift = pass * 8;
+
+        // Every key shares this byte, the pass would not change the order
+        if (histogram[(m_keys[0] >> shift) & 0xFF] == count) {
+            continue;
+        }
+
+        uint32_t offset = 0;
+        for (auto& bucket : histogram) {
+            const uint32_t size = bucket;
+            bucket = offset;
+            offset += size;
+        }
+
+        for (const uint32_t index : m_order) {
+            m_scratch[histogram[(m_keys[index] >> shift) & 0xFF]++] = index;
+        }
+        m_order.swap(m_scratch);
+    }
+}
+
+bool RenderQueue::canBatch(const DrawPacket& first, const DrawPacket& other) {
+    if (first.shader != other.shader) {
+        return false;
+    }
+
+    // Materials in the table are read through the object data, they don't split the batch
+    return first.material == other.material || (isTableResident(first) && isTableResident(other));
+}
+
+bool RenderQueue::isTableResident(const DrawPacket& packet) {
+    return packet.material == nullptr || packet.material->isResident();
+}
+
+void RenderQueue::buildBatches(const View& view) {
+    m_batches.clear();
+    m_groups.clear();
+    m_drawData.clear();
+    m_commands.clear();
+    m_cullData.clear();
+
+    const bool occlusionCulling = view.occlusion != nullptr && view.occlusion->isReady();
+    const uint32_t count = static_cast<uint32_t>(m_order.size());
+    uint32_t first = 0;
+    while (first < count) {
+        const DrawPacket& packet = m_packets[m_order[first]];
+        const bool indirect = m_instancing && view.objects != nullptr &&
+            packet.shader->getInstancedVariant() != nullptr && isTableResident(packet);
+
+        uint32_t last = first + 1;
+        while (indirect && last < count && canBatch(packet, m_packets[m_order[last]])) {
+            last++;
+        }
+
+        Batch batch = { first, last - first, indirect, 0, 0 };
+        if (indirect) {
+            buildCommands(batch, occlusionCulling);
+        }
+
+        m_batches.push_back(batch);
+        first = last;
+    }
+}
+
+void RenderQueue::buildCommands(Batch& batch, bool occlusionCulling) {
+    m_batchCommands.clear();
+
+    const uint32_t end = batch.first + batch.count;
+    uint32_t first = batch.first;
+    while (first < end) {
+        const codex::Mesh* mesh = m_packets[m_order[first]].mesh;
+        const uint32_t baseInstance = static_cast<uint32_t>(m_drawData.size());
+
+        // Consecutive packets of the same mesh are instances of the same commands
+        uint32_t last = first;
+        while (last < end && m_packets[m_order[last]].mesh == mesh) {
+            const DrawPacket& packet = m_packets[m_order[last]];
+            m_drawData.push_back({ packet.objectIndex, packet.lodFade });
+            if (occlusionCulling) {
+                const boundsf& bounds = packet.bounds;
+                m_cullData.push_back({
+                    { bounds.min.x, bounds.min.y, bounds.min.z }, baseInstance,
+                    { bounds.max.x, bounds.max.y, bounds.max.z }
+                });
+            }
+            last++;
+        }
+
+        m_ranges.clear();
+        mesh->collectDrawRanges(m_ranges);
+        for (const codex::DrawRange& range : m_ranges) {
+            m_batchCommands.push_back({ range.vertexArray, {
+                range.indexCount, last - first, range.firstIndex, range.baseVertex, baseInstance
+            }});
+        }
+
+        first = last;
+    }
+
+    // The order of the commands doesn't matter, the draw data is found through the base instance
+    std::stable_sort(m_batchCommands.begin(), m_batchCommands.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+
+    batch.firstGroup = static_cast<uint32_t>(m_groups.size());
+    for (const auto& [vertexArray, command] : m_batchCommands) {
+        if (m_groups.size() == batch.firstGroup || m_groups.back().vertexArray != vertexArray) {
+            m_groups.push_back({ vertexArray, static_cast<uint32_t>(m_commands.size()), 0 });
+        }
+        m_groups.back().commandCount++;
+        m_commands.push_back(command);
+    }
+    batch.groupCount = static_cast<uint32_t>(m_groups.size()) - batch.firstGroup;
+}
+
+bool RenderQueue::uploadCommands(const View& view) {
+    if (m_commands.empty()) {
+        return true;
+    }
+
+    auto* streamBuffer = cinder::app->getStreamBuffer();
+    const size_t drawSize    = m_drawData.size() * sizeof(DrawData);
+    const size_t commandSize = m_commands.size() * sizeof(DrawElementsIndirectCommand);
+
+    auto draws    = streamBuffer->allocate(drawSize, GL_SHADER_STORAGE_BUFFER);
+    auto commands = streamBuffer->allocate(commandSize, GL_DRAW_INDIRECT_BUFFER);
+    if (!draws.isValid() || !commands.isValid()) {
+        return false;
+    }
+
+    std::memcpy(draws.pointer, m_drawData.data(), drawSize);
+    std::memcpy(commands.pointer, m_commands.data(), commandSize);
+
+    cinder::RenderDevice::bindBufferRange(GL_SHADER_STORAGE_BUFFER, DRAW_BUFFER_BINDING, draws.buffer, draws.offset, draws.size);
+
+    // Drawn unculled if the culling data doesn't fit
+    if (!m_cullData.empty()) {
+        auto visible = view.occlusion->cull(draws, m_cullData, commands, static_cast<uint32_t>(m_commands.size()));
+        if (visible.isValid()) {
+            cinder::RenderDevice::bindBufferRange(GL_SHADER_STORAGE_BUFFER, DRAW_BUFFER_BINDING, visible.buffer, visible.offset, visible.size);
+        }
+    }
+
+    cinder::RenderDevice::bindBuffer(GL_DRAW_INDIRECT_BUFFER, commands.buffer);
+    m_commandsOffset = commands.offset;
+    return true;
+}
+
+void RenderQueue::submit(const View& view) {
+    m_stats = {};
+    m_stats.packets = static_cast<uint32_t>(m_packets.size());
+
+    buildBatches(view);
+
+    // Out of space this frame, the batches are drawn one by one instead
+    if (!uploadCommands(view)) {
+        for (Batch& batch : m_batches) {
+            batch.indirect = false;
+        }
+    }
+
+    // The pools and the table are shared by every indirect batch
+    for (const Batch& batch : m_batches) {
+        if (batch.indirect) {
+            cinder::app->getMaterialTable()->bind();
+            break;
+        }
+    }
+
+    codex::Shader*   boundShader   = nullptr;
+    codex::Material* boundMaterial = nullptr;
+    codex::Mesh*     lastMesh      = nullptr;
+    float boundFade = NAN;
+
+    // Resolved once per shader change, so the per-draw path does no lookups
+    codex::UniformHandle<matrix4x4f> modelMatrixUniform;
+    codex::UniformHandle<matrix4x4f> previousModelMatrixUniform;
+    codex::UniformHandle<float>      lodFadeUniform;
+
+    for (const Batch& batch : m_batches) {
+        const DrawPacket& packet = m_packets[m_order[batch.first]];
+        codex::Shader* shader = batch.indirect ? packet.shader->getInstancedVariant() : packet.shader;
+
+        if (shader != boundShader) {
+            shader->bind();
+            modelMatrixUniform = shader->getUniformHandle<matrix4x4f>("modelMatrix");
+            previousModelMatrixUniform = shader->getUniformHandle<matrix4x4f>("previousModelMatrix");
+            lodFadeUniform     = shader->getUniformHandle<float>("lodFade");
+            boundShader   = shader;
+            boundMaterial = nullptr;
+            boundFade     = NAN;
+            m_stats.shaderChanges++;
+        }
+
+        if (batch.indirect) {
+            for (uint32_t i = batch.firstGroup; i < batch.firstGroup + batch.groupCount; i++) {
+                const CommandGroup& group = m_groups[i];
+                const intptr_t offset = m_commandsOffset + group.firstCommand * sizeof(DrawElementsIndirectCommand);
+
+                cinder::RenderDevice::bindVertexArray(group.vertexArray);
+                glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, reinterpret_cast<const void*>(offset), group.commandCount, 0);
+                m_stats.drawCalls++;
+                m_stats.multiDraws++;
+                m_stats.indirectCommands += group.commandCount;
+            }
+            m_stats.meshChanges += batch.groupCount;
+            continue;
+        }
+
+        for (uint32_t i = batch.first; i < batch.first + batch.count; i++) {
+            const DrawPacket& single = m_packets[m_order[i]];
+
+            // Sampler uniforms are per program, so a new shader means rebinding the material
+            if (single.material != boundMaterial) {
+                if (single.material != nullptr && single.material->isInitialized())
+                    single.material->bindTextures(boundShader);
+                boundMaterial = single.material;
+                m_stats.materialChanges++;
+            }
+
+            if (single.mesh != lastMesh) {
+                lastMesh = single.mesh;
+                m_stats.meshChanges++;
+            }
+
+            // Only the shaders with the uniform know about cross-fading (not the shadow shader)
+            if (lodFadeUniform.isValid() && single.lodFade != boundFade) {
+                boundShader->setUniform(lodFadeUniform, single.lodFade);
+                boundFade = single.lodFade;
+            }
+
+            boundShader->setUniform(modelMatrixUniform, single.modelMatrix);
+            if (previousModelMatrixUniform.isValid()) {
+                boundShader->setUniform(previousModelMatrixUniform, single.previousModelMatrix);
+            }
+            single.mesh->draw();
+            m_stats.drawCalls++;
+        }
+    }
+}
+
+}; // namespace prism
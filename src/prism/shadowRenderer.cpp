@@ -0,0 +1,131 @@
+#include "prism/shadowRenderer.hpp"
+
+#include "hex/scene.hpp"
+#include "hex/components/rendererComponent.hpp"
+#include "hex/components/transformComponent.hpp"
+#include "renderDevice.hpp"
+
+#include <glad.h>
+
+#include <cstring>
+
+namespace prism {
+
+/**
+ * @brief FNV-1a, mixing a value into the hash.
+ */
+template<typename T>
+static void hashValue(uint64_t* hash, const T& value) {
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    for (const unsigned char byte : bytes) {
+        *hash ^= byte;
+        *hash *= 0x100000001B3ull;
+    }
+}
+
+ShadowRenderer::ShadowRenderer(int size) : m_size(size) {
+    m_staticLayer = std::make_unique<hex::Framebuffer>(size, size, true);
+    m_shadowMap   = std::make_unique<hex::Framebuffer>(size, size, true);
+}
+
+uint64_t ShadowRenderer::computeStaticSignature(const hex::Scene& scene, const matrix4x4f& lightViewProjection) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    hashValue(&hash, lightViewProjection.as_array);
+
+    m_staticCasterCount  = 0;
+    m_dynamicCasterCount = 0;
+
+    for (const auto& actor : scene.getActors()) {
+        if (!actor->isEnabled()) {
+            continue;
+        }
+
+        auto renderer = actor->getComponent<hex::RendererComponent>(true);
+        if (renderer == nullptr || !renderer->isEnabled() || !renderer->isCastingShadows()) {
+            continue;
+        }
+
+        codex::Mesh* mesh = renderer->getMesh();
+        if (mesh == nullptr || !mesh->isInitialized()) {
+            continue;
+        }
+
+        if (!actor->isStatic()) {
+            m_dynamicCasterCount++;
+            continue;
+        }
+
+        auto transform = actor->getComponent<hex::TransformComponent>(true);
+        hashValue(&hash, actor.get());
+        hashValue(&hash, mesh);
+        hashValue(&hash, transform != nullptr ? transform->getTransform().getVersion() : 0u);
+        m_staticCasterCount++;
+    }
+
+    hashValue(&hash, m_staticCasterCount);
+    return hash;
+}
+
+void ShadowRenderer::render(hex::Scene& scene, hex::Camera* lightCamera, codex::Shader* shader, int lodBias, float interpolation) {
+    const uint32_t lastDynamicCasterCount = m_dynamicCasterCount;
+
+    View view = View::fromCamera(lightCamera, lodBias, shader);
+    view.pass = PASS_SHADOW;
+
+    const uint64_t signature = computeStaticSignature(scene, lightCamera->getViewMatrix() * lightCamera->getProjectionMatrix());
+    const bool staticChanged = m_staticDirty || signature != m_staticSignature;
+
+    // Nothing moved, the shadow map is still valid
+    if (!staticChanged && m_dynamicCasterCount == 0 && lastDynamicCasterCount == 0) {
+        return;
+    }
+
+    for (codex::Shader* program : { shader, shader->getInstancedVariant() }) {
+        if (program == nullptr) {
+            continue;
+        }
+        program->bind();
+        program->setUniform("viewMatrix", lightCamera->getViewMatrix());
+        program->setUniform("projectionMatrix", lightCamera->getProjectionMatrix());
+    }
+
+    cinder::RenderDevice::setViewport(0, 0, m_size, m_size);
+    cinder::RenderDevice::setEnabled(GL_CULL_FACE, false);
+    cinder::RenderDevice::setEnabled(GL_DEPTH_TEST, true);
+    cinder::RenderDevice::setDepthFunc(GL_LESS);
+
+    if (staticChanged) {
+        m_staticLayer->bind();
+        glClear(GL_DEPTH_BUFFER_BIT);
+
+        view.actorFilter = ActorFilter::STATIC_ONLY;
+        view.queue = &m_staticQueue;
+        scene.render(view);
+
+        m_staticSignature = signature;
+        m_staticDirty = false;
+        m_staticRenderCount++;
+    }
+
+    // The dynamic casters are depth tested against the static ones
+    glBlitNamedFramebuffer(
+        m_staticLayer->getHandle(), m_shadowMap->getHandle(),
+        0, 0, m_size, m_size,
+        0, 0, m_size, m_size,
+        GL_DEPTH_BUFFER_BIT, GL_NEAREST
+    );
+
+    if (m_dynamicCasterCount > 0) {
+        m_shadowMap->bind();
+
+        view.actorFilter = ActorFilter::DYNAMIC_ONLY;
+        view.queue = &m_dynamicQueue;
+        view.interpolation = interpolation;
+        scene.render(view);
+    }
+
+    m_shadowMap->unbind();
+}
+
+}; // namespace prism
@@ -0,0 +1,132 @@
+#include "prism/temporalAA.hpp"
+
+#include "cinder.hpp"
+#include "hex/camera.hpp"
+#include "renderDevice.hpp"
+
+#include <glad.h>
+
+#include <algorithm>
+#include <format>
+
+namespace prism {
+
+TemporalAA::~TemporalAA() {
+    release();
+}
+
+void TemporalAA::release() {
+    for (int i = 0; i < 2; i++) {
+        cinder::RenderDevice::deleteFramebuffer(m_framebuffers[i]);
+        cinder::RenderDevice::deleteTexture(m_histories[i]);
+        m_framebuffers[i] = 0;
+        m_histories[i] = 0;
+    }
+    m_historyValid = false;
+}
+
+void TemporalAA::setEnabled(bool enabled) {
+    if (enabled && !m_enabled) {
+        m_historyValid = false;
+    }
+    m_enabled = enabled;
+}
+
+void TemporalAA::resize(int width, int height) {
+    width  = std::max(width , 1);
+    height = std::max(height, 1);
+    if (width == m_width && height == m_height && m_histories[0] != 0) {
+        return;
+    }
+
+    release();
+    m_width  = width;
+    m_height = height;
+
+    glCreateTextures(GL_TEXTURE_2D, 2, m_histories);
+    glCreateFramebuffers(2, m_framebuffers);
+    for (int i = 0; i < 2; i++) {
+        glTextureStorage2D(m_histories[i], 1, GL_RGBA16F, m_width, m_height);
+        glTextureParameteri(m_histories[i], GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTextureParameteri(m_histories[i], GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTextureParameteri(m_histories[i], GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(m_histories[i], GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        glNamedFramebufferTexture(m_framebuffers[i], GL_COLOR_ATTACHMENT0, m_histories[i], 0);
+        if (glCheckNamedFramebufferStatus(m_framebuffers[i], GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            cinder::error("Temporal anti-aliasing history framebuffer is not complete!");
+        }
+    }
+
+    cinder::log(std::format("Temporal anti-aliasing history resized to {}x{}.", m_width, m_height));
+}
+
+float TemporalAA::halton(uint32_t index, uint32_t base) {
+    float result = 0.0f;
+    float fraction = 1.0f;
+    while (index > 0) {
+        fraction /= static_cast<float>(base);
+        result += fraction * static_cast<float>(index % base);
+        index /= base;
+    }
+    return result;
+}
+
+vector4f TemporalAA::beginFrame(int renderWidth, int renderHeight) {
+    if (!m_enabled) {
+        m_jitterPixels = vector4f::zero();
+        return vector4f::zero();
+    }
+
+    // A change of the rendered size moves every sample, the clamping handles it like motion
+    m_renderWidth  = std::max(renderWidth , 1);
+    m_renderHeight = std::max(renderHeight, 1);
+    m_current = 1 - m_current;
+
+    // Starts from 1, the first element of the sequence is 0 in both dimensions
+    m_sampleIndex = (m_sampleIndex % JITTER_SAMPLES) + 1;
+    m_jitterPixels = vector4f(halton(m_sampleIndex, 2) - 0.5f, halton(m_sampleIndex, 3) - 0.5f, 0.0f, 0.0f);
+
+    // Two units of normalized device coordinates span the rendered size
+    return vector4f(
+        m_jitterPixels.x * 2.0f / static_cast<float>(m_renderWidth),
+        m_jitterPixels.y * 2.0f / static_cast<float>(m_renderHeight),
+        0.0f, 0.0f
+    );
+}
+
+void TemporalAA::resolve(codex::Shader* shader, codex::Mesh* quad, uint32_t colorTexture, uint32_t velocityTexture, uint32_t depthTexture,
+                         hex::Camera* camera, int sourceWidth, int sourceHeight) {
+    if (shader == nullptr || !shader->isInitialized() || quad == nullptr || m_histories[0] == 0) {
+        return;
+    }
+
+    cinder::RenderDevice::bindFramebuffer(GL_FRAMEBUFFER, m_framebuffers[m_current]);
+    cinder::RenderDevice::setViewport(0, 0, m_width, m_height);
+    cinder::RenderDevice::setEnabled(GL_DEPTH_TEST, false);
+
+    cinder::RenderDevice::bindTexture(0, colorTexture);
+    cinder::RenderDevice::bindTexture(1, velocityTexture);
+    cinder::RenderDevice::bindTexture(2, depthTexture);
+    cinder::RenderDevice::bindTexture(3, m_histories[1 - m_current]);
+
+    const matrix4x4f viewProjection = camera->getViewMatrix() * camera->getUnjitteredProjectionMatrix();
+
+    shader->bind();
+    shader->setUniform("currentTexture", 0);
+    shader->setUniform("velocityTexture", 1);
+    shader->setUniform("depthTexture", 2);
+    shader->setUniform("historyTexture", 3);
+    shader->setUniform("renderSize", vector4f(static_cast<float>(m_renderWidth), static_cast<float>(m_renderHeight), 0.0f, 0.0f));
+    shader->setUniform("sourceSize", vector4f(static_cast<float>(sourceWidth), static_cast<float>(sourceHeight), 0.0f, 0.0f));
+    shader->setUniform("jitter", m_jitterPixels);
+    shader->setUniform("historyValid", m_historyValid ? 1 : 0);
+    shader->setUniform("blendFactor", BLEND_FACTOR);
+    shader->setUniform("inverseViewProjection", viewProjection.inverse());
+    shader->setUniform("previousViewProjection", camera->getPreviousViewProjectionMatrix());
+
+    quad->draw();
+    m_historyValid = true;
+}
+
+}; // namespace prism
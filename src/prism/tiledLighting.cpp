@@ -0,0 +1,103 @@
+#include "prism/tiledLighting.hpp"
+
+#include "cinder.hpp"
+#include "app.hpp"
+#include "renderDevice.hpp"
+
+#include <glad.h>
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+
+namespace prism {
+
+TiledLighting::~TiledLighting() {
+    release();
+}
+
+void TiledLighting::release() {
+    cinder::RenderDevice::deleteTexture(m_gridTexture);
+    cinder::RenderDevice::deleteBuffer(m_indexBuffer);
+    m_gridTexture = 0;
+    m_indexBuffer = 0;
+    m_indexCapacity = 0;
+}
+
+void TiledLighting::resize(int width, int height) {
+    const uint32_t tilesX = (std::max(width , 1) + TILE_SIZE - 1) / TILE_SIZE;
+    const uint32_t tilesY = (std::max(height, 1) + TILE_SIZE - 1) / TILE_SIZE;
+    if (tilesX == m_tilesX && tilesY == m_tilesY && m_gridTexture != 0) {
+        return;
+    }
+
+    release();
+    m_tilesX = tilesX;
+    m_tilesY = tilesY;
+
+    glCreateTextures(GL_TEXTURE_2D, 1, &m_gridTexture);
+    glTextureStorage2D(m_gridTexture, 1, GL_RG32UI, m_tilesX, m_tilesY);
+    glTextureParameteri(m_gridTexture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTextureParameteri(m_gridTexture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    // The first element is the allocation counter of the tiles
+    m_indexCapacity = static_cast<size_t>(m_tilesX) * m_tilesY * AVERAGE_LIGHTS_PER_TILE;
+    glCreateBuffers(1, &m_indexBuffer);
+    glNamedBufferStorage(m_indexBuffer, (m_indexCapacity + 1) * sizeof(uint32_t), nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+    cinder::log(std::format("Light grid resized to {}x{} tiles.", m_tilesX, m_tilesY));
+}
+
+void TiledLighting::cull(codex::Shader* shader, uint32_t depthTexture, const matrix4x4f& viewMatrix, const matrix4x4f& projectionMatrix, int width, int height) {
+    // Only the tiles of the rendered area are built, the lighting never reads the others
+    const uint32_t tilesX = std::min((std::max(width , 1) + TILE_SIZE - 1) / TILE_SIZE, m_tilesX);
+    const uint32_t tilesY = std::min((std::max(height, 1) + TILE_SIZE - 1) / TILE_SIZE, m_tilesY);
+    m_stats = { static_cast<uint32_t>(m_lights.size()), tilesX, tilesY };
+
+    if (shader == nullptr || !shader->isInitialized() || m_gridTexture == 0) {
+        return;
+    }
+
+    // Never empty, so the binding is always valid
+    const size_t lightBytes = std::max<size_t>(m_lights.size(), 1) * sizeof(LightData);
+    auto allocation = cinder::app->getStreamBuffer()->allocate(lightBytes, GL_SHADER_STORAGE_BUFFER);
+    if (!allocation.isValid()) {
+        return;
+    }
+    if (!m_lights.empty()) {
+        std::memcpy(allocation.pointer, m_lights.data(), m_lights.size() * sizeof(LightData));
+    }
+
+    m_lightBuffer = allocation.buffer;
+    m_lightOffset = static_cast<intptr_t>(allocation.offset);
+    m_lightSize   = static_cast<intptr_t>(allocation.size);
+
+    const uint32_t zero = 0;
+    glClearNamedBufferSubData(m_indexBuffer, GL_R32UI, 0, sizeof(uint32_t), GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+
+    bind();
+    cinder::RenderDevice::bindTexture(0, depthTexture);
+    glBindImageTexture(0, m_gridTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RG32UI);
+
+    shader->bind();
+    shader->setUniform("depthTexture", 0);
+    shader->setUniform("lightCount", static_cast<int>(m_lights.size()));
+    shader->setUniform("indexCapacity", static_cast<int>(m_indexCapacity));
+    shader->setUniform("renderWidth", width);
+    shader->setUniform("renderHeight", height);
+    shader->setUniform("viewMatrix", viewMatrix);
+    shader->setUniform("inverseProjection", projectionMatrix.inverse());
+    shader->dispatch(tilesX, tilesY);
+
+    // The lists are read as storage, the grid through texel fetches
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+void TiledLighting::bind() const {
+    if (m_lightBuffer != 0) {
+        cinder::RenderDevice::bindBufferRange(GL_SHADER_STORAGE_BUFFER, LIGHT_BINDING, m_lightBuffer, m_lightOffset, m_lightSize);
+    }
+    cinder::RenderDevice::bindBufferBase(GL_SHADER_STORAGE_BUFFER, INDEX_BINDING, m_indexBuffer);
+}
+
+}; // namespace prism
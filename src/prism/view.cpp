@@ -0,0 +1,63 @@
+#include "prism/view.hpp"
+#include "hex/camera.hpp"
+
+namespace prism {
+
+Frustum Frustum::fromMatrix(const matrix4x4f& viewProjection) {
+    // Gribb-Hartmann, the planes are the sums and differences of the last row and the others
+    const auto& rows = viewProjection.as_vector_rows;
+
+    Frustum frustum;
+    for (int i = 0; i < 3; i++) {
+        frustum.planes[i * 2    ] = rows[3] + rows[i];
+        frustum.planes[i * 2 + 1] = rows[3] - rows[i];
+    }
+
+    for (auto& plane : frustum.planes) {
+        const float length = plane.length3d();
+        if (length > 0.0f) {
+            plane = plane / length;
+        }
+    }
+    return frustum;
+}
+
+bool Frustum::intersects(const boundsf& bounds) const {
+    for (const auto& plane : planes) {
+        // The corner furthest along the plane normal
+        const float x = plane.x >= 0.0f ? bounds.max.x : bounds.min.x;
+        const float y = plane.y >= 0.0f ? bounds.max.y : bounds.min.y;
+        const float z = plane.z >= 0.0f ? bounds.max.z : bounds.min.z;
+
+        if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+View View::fromCamera(hex::Camera* camera, int lodBias, codex::Shader* overrideShader) {
+    View view;
+    view.position        = camera->getInterpolatedPosition();
+    view.projectionScale = camera->getProjectionMatrix().m11;
+    view.orthographic    = camera->isOrtographic();
+    view.lodBias         = lodBias;
+    view.overrideShader  = overrideShader;
+    view.lodCrossFade    = overrideShader == nullptr; // The shadow shader can't dither, a fading object would be drawn at both levels
+    view.frustum         = Frustum::fromMatrix(camera->getViewMatrix() * camera->getProjectionMatrix());
+    return view;
+}
+
+float View::screenSize(const vector4f& center, float radius) const {
+    if (orthographic) {
+        return radius * projectionScale;
+    }
+
+    const float distance = distanceTo(center);
+    if (distance <= radius) {
+        return 1.0f;
+    }
+    return radius * projectionScale / distance;
+}
+
+}; // namespace prism
@@ -0,0 +1,259 @@
+#include "renderDevice.hpp"
+
+#include <glad.h>
+
+namespace cinder {
+
+RenderDevice::State::State() {
+    textures.fill(UNKNOWN);
+    samplers.fill(UNKNOWN);
+    uniformBuffers.fill({});
+    storageBuffers.fill({});
+    capabilities.fill(-1);
+    viewport.fill(0);
+    clearColor.fill(0.0f);
+}
+
+void RenderDevice::beginFrame() {
+    s_lastFrameStats = s_stats;
+    s_stats = {};
+    invalidate();
+}
+
+void RenderDevice::invalidate() {
+    s_state = State();
+    // Texture edits rely on it (See the class description)
+    glActiveTexture(GL_TEXTURE0);
+}
+
+int RenderDevice::capabilityIndex(uint32_t capability) {
+    switch (capability) {
+        case GL_DEPTH_TEST:   return 0;
+        case GL_CULL_FACE:    return 1;
+        case GL_BLEND:        return 2;
+        case GL_SCISSOR_TEST: return 3;
+        case GL_STENCIL_TEST: return 4;
+        default:              return -1;
+    }
+}
+
+void RenderDevice::useProgram(uint32_t program) {
+    if (change(s_state.program, program))
+        glUseProgram(program);
+}
+
+void RenderDevice::bindVertexArray(uint32_t vertexArray) {
+    if (change(s_state.vertexArray, vertexArray))
+        glBindVertexArray(vertexArray);
+}
+
+void RenderDevice::bindTexture(uint32_t unit, uint32_t texture) {
+    if (unit >= TEXTURE_UNITS) {
+        s_stats.issued++;
+        glBindTextureUnit(unit, texture);
+        return;
+    }
+
+    if (change(s_state.textures[unit], texture))
+        glBindTextureUnit(unit, texture);
+}
+
+void RenderDevice::bindSampler(uint32_t unit, uint32_t sampler) {
+    if (unit >= TEXTURE_UNITS) {
+        s_stats.issued++;
+        glBindSampler(unit, sampler);
+        return;
+    }
+
+    if (change(s_state.samplers[unit], sampler))
+        glBindSampler(unit, sampler);
+}
+
+void RenderDevice::bindFramebuffer(uint32_t target, uint32_t framebuffer) {
+    switch (target) {
+        case GL_READ_FRAMEBUFFER:
+            if (change(s_state.readFramebuffer, framebuffer))
+                glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+            return;
+        case GL_DRAW_FRAMEBUFFER:
+            if (change(s_state.drawFramebuffer, framebuffer))
+                glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+            return;
+        default:
+            break;
+    }
+
+    if (s_state.readFramebuffer == framebuffer && s_state.drawFramebuffer == framebuffer) {
+        s_stats.skipped++;
+        return;
+    }
+
+    s_state.readFramebuffer = framebuffer;
+    s_state.drawFramebuffer = framebuffer;
+    s_stats.issued++;
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+}
+
+std::array<RenderDevice::BufferBinding, RenderDevice::BUFFER_BINDINGS>* RenderDevice::bufferBindings(uint32_t target) {
+    switch (target) {
+        case GL_UNIFORM_BUFFER:        return &s_state.uniformBuffers;
+        case GL_SHADER_STORAGE_BUFFER: return &s_state.storageBuffers;
+        default:                       return nullptr;
+    }
+}
+
+void RenderDevice::bindBuffer(uint32_t target, uint32_t buffer) {
+    if (target != GL_DRAW_INDIRECT_BUFFER) {
+        s_stats.issued++;
+        glBindBuffer(target, buffer);
+        return;
+    }
+
+    if (change(s_state.drawIndirectBuffer, buffer))
+        glBindBuffer(target, buffer);
+}
+
+void RenderDevice::bindBufferBase(uint32_t target, uint32_t index, uint32_t buffer) {
+    auto* bindings = bufferBindings(target);
+    if (bindings == nullptr || index >= BUFFER_BINDINGS) {
+        s_stats.issued++;
+        glBindBufferBase(target, index, buffer);
+        return;
+    }
+
+    if (change((*bindings)[index], BufferBinding{ buffer, 0, 0 }))
+        glBindBufferBase(target, index, buffer);
+}
+
+void RenderDevice::bindBufferRange(uint32_t target, uint32_t index, uint32_t buffer, intptr_t offset, intptr_t size) {
+    auto* bindings = bufferBindings(target);
+    if (bindings == nullptr || index >= BUFFER_BINDINGS) {
+        s_stats.issued++;
+        glBindBufferRange(target, index, buffer, offset, size);
+        return;
+    }
+
+    if (change((*bindings)[index], BufferBinding{ buffer, offset, size }))
+        glBindBufferRange(target, index, buffer, offset, size);
+}
+
+void RenderDevice::setEnabled(uint32_t capability, bool enabled) {
+    const int index = capabilityIndex(capability);
+    if (index < 0) {
+        s_stats.issued++;
+        enabled ? glEnable(capability) : glDisable(capability);
+        return;
+    }
+
+    if (change(s_state.capabilities[index], static_cast<int8_t>(enabled)))
+        enabled ? glEnable(capability) : glDisable(capability);
+}
+
+void RenderDevice::setViewport(int x, int y, int width, int height) {
+    const std::array<int, 4> viewport = { x, y, width, height };
+    if (s_state.viewportKnown && s_state.viewport == viewport) {
+        s_stats.skipped++;
+        return;
+    }
+
+    s_state.viewport = viewport;
+    s_state.viewportKnown = true;
+    s_stats.issued++;
+    glViewport(x, y, width, height);
+}
+
+void RenderDevice::setCullFace(uint32_t mode) {
+    if (change(s_state.cullFace, mode))
+        glCullFace(mode);
+}
+
+void RenderDevice::setFrontFace(uint32_t mode) {
+    if (change(s_state.frontFace, mode))
+        glFrontFace(mode);
+}
+
+void RenderDevice::setDepthFunc(uint32_t func) {
+    if (change(s_state.depthFunc, func))
+        glDepthFunc(func);
+}
+
+void RenderDevice::setDepthMask(bool write) {
+    if (change(s_state.depthMask, static_cast<int8_t>(write)))
+        glDepthMask(write ? GL_TRUE : GL_FALSE);
+}
+
+void RenderDevice::setColorMask(bool write) {
+    if (change(s_state.colorMask, static_cast<int8_t>(write))) {
+        const GLboolean mask = write ? GL_TRUE : GL_FALSE;
+        glColorMask(mask, mask, mask, mask);
+    }
+}
+
+void RenderDevice::setBlendFunc(uint32_t source, uint32_t destination) {
+    if (s_state.blendSource == source && s_state.blendDestination == destination) {
+        s_stats.skipped++;
+        return;
+    }
+
+    s_state.blendSource = source;
+    s_state.blendDestination = destination;
+    s_stats.issued++;
+    glBlendFunc(source, destination);
+}
+
+void RenderDevice::setClearColor(float r, float g, float b, float a) {
+    const std::array<float, 4> color = { r, g, b, a };
+    if (s_state.clearColorKnown && s_state.clearColor == color) {
+        s_stats.skipped++;
+        return;
+    }
+
+    s_state.clearColor = color;
+    s_state.clearColorKnown = true;
+    s_stats.issued++;
+    glClearColor(r, g, b, a);
+}
+
+void RenderDevice::deleteTexture(uint32_t texture) {
+    if (texture == 0)
+        return;
+
+    for (auto& bound : s_state.textures) {
+        if (bound == texture) bound = 0;
+    }
+    glDeleteTextures(1, &texture);
+}
+
+void RenderDevice::deleteVertexArray(uint32_t vertexArray) {
+    if (vertexArray == 0)
+        return;
+
+    if (s_state.vertexArray == vertexArray)
+        s_state.vertexArray = 0;
+    glDeleteVertexArrays(1, &vertexArray);
+}
+
+void RenderDevice::deleteFramebuffer(uint32_t framebuffer) {
+    if (framebuffer == 0)
+        return;
+
+    if (s_state.readFramebuffer == framebuffer) s_state.readFramebuffer = 0;
+    if (s_state.drawFramebuffer == framebuffer) s_state.drawFramebuffer = 0;
+    glDeleteFramebuffers(1, &framebuffer);
+}
+
+void RenderDevice::deleteBuffer(uint32_t buffer) {
+    if (buffer == 0)
+        return;
+
+    for (auto& bound : s_state.uniformBuffers) {
+        if (bound.buffer == buffer) bound = { 0, 0, 0 };
+    }
+    for (auto& bound : s_state.storageBuffers) {
+        if (bound.buffer == buffer) bound = { 0, 0, 0 };
+    }
+    if (s_state.drawIndirectBuffer == buffer) s_state.drawIndirectBuffer = 0;
+    glDeleteBuffers(1, &buffer);
+}
+
+}; // namespace cinder
@@ -0,0 +1,40 @@
+#include "timestep.hpp"
+#include "cinder.hpp"
+
+namespace cinder {
+
+FixedTimestep::FixedTimestep(double tickRate, int maxCatchUpTicks) {
+    setTickRate(tickRate);
+    setMaxCatchUpTicks(maxCatchUpTicks);
+}
+
+void FixedTimestep::setTickRate(double tickRate) {
+    if (tickRate <= 0.0) {
+        cinder::warn("Tick rate must be positive.");
+        return;
+    }
+    m_tickDelta = 1.0 / tickRate;
+}
+
+int FixedTimestep::advance(double frameTime) {
+    m_accumulator += frameTime > 0.0 ? frameTime : 0.0;
+
+    int ticks = 0;
+    while (m_accumulator >= m_tickDelta && ticks < m_maxCatchUpTicks) {
+        m_accumulator -= m_tickDelta;
+        ticks++;
+    }
+
+    // Too far behind (long hitch, breakpoint), the simulation slows down instead of spiraling
+    if (m_accumulator >= m_tickDelta) {
+        const double kept = m_accumulator - static_cast<int>(m_accumulator / m_tickDelta) * m_tickDelta;
+        m_droppedTime += m_accumulator - kept;
+        m_accumulator = kept;
+    }
+
+    m_tickCount += ticks;
+    m_lastFrameTicks = ticks;
+    return ticks;
+}
+
+}; // namespace cinder